@@ -1,36 +1,43 @@
 ﻿using System.Collections.ObjectModel;
-using System.Runtime.InteropServices;
 
 namespace Foster.Audio;
 
+/// <summary>
+/// The default <see cref="AudioEngine"/>, created by <see cref="Startup(AudioStartupOptions?)"/>
+/// </summary>
 public static class Audio
 {
+	/// <summary>
+	/// The default engine used by <see cref="Sound"/>s and <see cref="SoundGroup"/>s created without an explicit engine
+	/// </summary>
+	public static AudioEngine Engine { get; private set; } = null!;
+
 	/// <summary>
 	/// Master volume
 	/// </summary>
 	public static float Volume
 	{
-		get => Platform.FosterAudioGetVolume();
-		set => Platform.FosterAudioSetVolume(value);
+		get => Engine.Volume;
+		set => Engine.Volume = value;
 	}
 
 	/// <summary>
 	/// Audio engine channel count
 	/// </summary>
-	public static int Channels { get; private set; }
+	public static int Channels => Engine.Channels;
 
 	/// <summary>
 	/// Audio engine sample rate
 	/// </summary>
-	public static int SampleRate { get; private set; }
+	public static int SampleRate => Engine.SampleRate;
 
 	/// <summary>
 	/// Audio engine clock in PCM frames (see <seealso cref="SampleRate"/>)
 	/// </summary>
 	public static ulong TimePcmFrames
 	{
-		get => Platform.FosterAudioGetTimePcmFrames();
-		set => Platform.FosterAudioSetTimePcmFrames(value);
+		get => Engine.TimePcmFrames;
+		set => Engine.TimePcmFrames = value;
 	}
 
 	/// <summary>
@@ -38,121 +45,115 @@ public static class Audio
 	/// </summary>
 	public static TimeSpan Time
 	{
-		get => TimeSpan.FromSeconds(1.0 * TimePcmFrames / SampleRate);
-		set => TimePcmFrames = (ulong)Math.Floor(value.TotalSeconds * SampleRate);
+		get => Engine.Time;
+		set => Engine.Time = value;
 	}
 
 	/// <summary>
 	/// The maximum number of simultaneously active <see cref="SoundInstance"/>s allowed.
 	/// Instances created after this threshold are inactive and do not play any audio.
 	/// </summary>
-	public static int MaxActiveInstances { get; set; } = 100;
+	public static int MaxActiveInstances
+	{
+		get => Engine.MaxActiveInstances;
+		set => Engine.MaxActiveInstances = value;
+	}
 
 	/// <summary>
 	/// The number of currently active <see cref="SoundInstance"/>s
 	/// </summary>
-	public static int ActiveInstances { get; internal set; }
+	public static int ActiveInstances => Engine.ActiveInstances;
 
 	/// <summary>
 	/// The primary (index 0) <see cref="AudioListener"/>
 	/// </summary>
-	public static AudioListener Listener { get; private set; } = null!;
+	public static AudioListener Listener => Engine.Listener;
 
 	/// <summary>
 	/// All available <see cref="AudioListener"/>s
 	/// </summary>
-	public static ReadOnlyCollection<AudioListener> Listeners { get; private set; } = null!;
+	public static ReadOnlyCollection<AudioListener> Listeners => Engine.Listeners;
 
 	/// <summary>
 	/// All instances currently being tracked, some may be inactive
 	/// </summary>
-	public static ReadOnlySpan<SoundInstance> Instances => CollectionsMarshal.AsSpan(instances);
-
-	private static readonly List<SoundInstance> instances = new();
+	public static ReadOnlySpan<SoundInstance> Instances => Engine.Instances;
 
-	public static void PlayAll() => ApplyAll(m => m.Play());
+	public static void PlayAll() => Engine.PlayAll();
 
-	public static void PauseAll() => ApplyAll(m => m.Pause());
+	public static void PauseAll() => Engine.PauseAll();
 
-	public static void StopAll() => ApplyAll(m => m.Stop());
+	public static void StopAll() => Engine.StopAll();
 
-	public static void ReleaseAll() => ApplyAll(m => m.Release());
+	public static void ReleaseAll() => Engine.ReleaseAll();
 
 	/// <summary>
 	/// Applies an action to all active instances.
 	/// </summary>
 	/// <param name="action"></param>
-	public static void ApplyAll(Action<SoundInstance> action)
+	public static void ApplyAll(Action<SoundInstance> action) => Engine.ApplyAll(action);
+
+	/// <summary>
+	/// Applies an action to all active instances in <paramref name="instances"/>.
+	/// Iterates backwards so that releasing an instance (which swaps the last one into its slot) is safe.
+	/// </summary>
+	internal static void ApplyAll(List<SoundInstance> instances, Action<SoundInstance> action)
 	{
-		foreach (var instance in Instances)
+		for (int i = instances.Count - 1; i >= 0; i--)
 		{
-			if(instance.Active)
+			if (i >= instances.Count)
+			{
+				continue;
+			}
+
+			var instance = instances[i];
+			if (instance.Active)
 			{
 				action(instance);
 			}
 		}
 	}
 
+	/// <inheritdoc cref="AudioEngine.StartCapture(string, AudioCaptureFormat, SoundGroup?, ulong, ulong, int)"/>
+	public static AudioCapture StartCapture(string path, AudioCaptureFormat format = AudioCaptureFormat.Wav, SoundGroup? group = null, ulong startTime = 0, ulong stopTime = 0, int bufferFrames = 0)
+		=> Engine.StartCapture(path, format, group, startTime, stopTime, bufferFrames);
+
+	/// <inheritdoc cref="AudioEngine.StartCapture(AudioCaptureCallback, SoundGroup?, ulong, ulong, int)"/>
+	public static AudioCapture StartCapture(AudioCaptureCallback callback, SoundGroup? group = null, ulong startTime = 0, ulong stopTime = 0, int bufferFrames = 0)
+		=> Engine.StartCapture(callback, group, startTime, stopTime, bufferFrames);
+
+	/// <inheritdoc cref="AudioEngine.Snapshot(AudioSnapshot?)"/>
+	public static AudioSnapshot Snapshot(AudioSnapshot? reuse = null) => Engine.Snapshot(reuse);
+
+	/// <inheritdoc cref="AudioEngine.Restore(AudioSnapshot, ulong)"/>
+	public static IReadOnlyList<SoundInstance> Restore(AudioSnapshot snapshot, ulong cursorTolerance = 0) => Engine.Restore(snapshot, cursorTolerance);
+
+	/// <summary>
+	/// Native memory usage, see <see cref="AudioMemoryStats"/>
+	/// </summary>
+	public static AudioMemoryStats MemoryStats => Engine.MemoryStats;
+
+	/// <summary>
+	/// Nodes skipped for being silent, see <see cref="AudioIdleStats"/>
+	/// </summary>
+	public static AudioIdleStats IdleStats => Engine.IdleStats;
+
 	/// <summary>
 	/// Initializes Audio. Call once on startup.
 	/// </summary>
-	public static void Startup()
+	public static void Startup(AudioStartupOptions? options = null)
 	{
-		Platform.FosterAudioStartup(new());
-		Channels = Platform.FosterAudioGetChannels();
-		SampleRate = Platform.FosterAudioGetSampleRate();
-		Listeners = Enumerable.Range(0, Platform.FosterAudioGetListenerCount())
-			.Select(i => new AudioListener(i))
-			.ToList()
-			.AsReadOnly();
-		Listener = Listeners[0];
+		Platform.FosterAudioStartup((options ?? new()).ToPlatform());
+		Engine = new AudioEngine(Platform.FosterAudioGetEngine(), true);
 	}
 
 	/// <summary>
 	/// Runs sound instance management. Call once per frame/update.
 	/// </summary>
-	public static void Update()
-	{
-		// Go through all instances and destroy all that are non-protected, finished
-		for (int i = 0;i<instances.Count;i++)
-		{
-			var instance = instances[i];
-			if (instance.Protected)
-			{
-				continue;
-			}
-
-			if (instance.Finished)
-			{
-				instance.Release();
-			}
-		}
-
-		// Remove inactive instances
-		lock (instances)
-		{
-			instances.RemoveAll(i => !i.Active);
-		}
-	}
+	public static void Update() => Engine.Update();
 
 	/// <summary>
 	/// Deinitializes and cleans up Audio. Call once on shutdown.
 	/// </summary>
-	public static void Shutdown()
-	{
-		ReleaseAll();
-		lock (instances)
-		{
-			instances.Clear();
-		}
-		Platform.FosterAudioShutdown();
-	}
-
-	internal static void OnSoundInstanceCreate(SoundInstance instance)
-	{
-		lock(instances)
-		{
-			instances.Add(instance);
-		}
-	}
+	public static void Shutdown() => Engine.Dispose();
 }
@@ -0,0 +1,134 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Foster.Audio;
+
+/// <summary>
+/// Receives captured frames as interleaved 32-bit float samples in the engine's channel count. <br/>
+/// Invoked on the capture's writer thread, the span is only valid during the call.
+/// </summary>
+public delegate void AudioCaptureCallback(ReadOnlySpan<float> frames);
+
+/// <summary>
+/// Captures the mixed output of an <see cref="AudioEngine"/> or a <see cref="SoundGroup"/>, see <see cref="AudioEngine.StartCapture(string, AudioCaptureFormat, SoundGroup?, ulong, ulong, int)"/>. <br/>
+/// The audio thread copies every mixed block into a ring buffer without ever blocking, and a background thread writes it out.
+/// If the writer falls behind, whole blocks are dropped and counted in <see cref="DroppedBlocks"/>.
+/// </summary>
+public class AudioCapture : IDisposable
+{
+	/// <summary>
+	/// Engine being captured
+	/// </summary>
+	public AudioEngine Engine { get; }
+
+	/// <summary>
+	/// Sound group being captured, or null for the engine output
+	/// </summary>
+	public SoundGroup? Group { get; }
+
+	/// <summary>
+	/// Frames copied out of the mix
+	/// </summary>
+	public ulong CapturedFrames => GetStats().capturedFrames;
+
+	/// <summary>
+	/// Frames written to the file or passed to the callback
+	/// </summary>
+	public ulong WrittenFrames => GetStats().writtenFrames;
+
+	/// <summary>
+	/// Mixed blocks dropped because the ring buffer was full
+	/// </summary>
+	public ulong DroppedBlocks => GetStats().droppedBlocks;
+
+	/// <summary>
+	/// Frames in <see cref="DroppedBlocks"/>
+	/// </summary>
+	public ulong DroppedFrames => GetStats().droppedFrames;
+
+	/// <summary>
+	/// Whether writing or closing the file failed, for example on a full disk. Nothing captured after the failure is written. <br/>
+	/// Stays readable after <see cref="Dispose"/>, which is when closing the file fails.
+	/// </summary>
+	public bool Failed => failed || GetStats().failed;
+
+	internal IntPtr Ptr { get; private set; }
+
+	private readonly Platform.FosterWriteFn? onWrite;
+	private bool failed;
+
+	internal AudioCapture(AudioEngine engine, SoundGroup? group, AudioCaptureFormat format, string? path, AudioCaptureCallback? callback, ulong startTime, ulong stopTime, int bufferFrames)
+	{
+		if (group != null && group.Engine != engine)
+		{
+			throw new ArgumentException("SoundGroup belongs to a different AudioEngine", nameof(group));
+		}
+
+		Engine = engine;
+		Group = group;
+
+		// Kept alive by the capture, the writer thread calls it until the capture is disposed
+		if (callback != null)
+		{
+			onWrite = (context, data, size) =>
+			{
+				unsafe
+				{
+					callback(new ReadOnlySpan<float>(data.ToPointer(), size / sizeof(float)));
+				}
+			};
+		}
+
+		var desc = new Platform.FosterCaptureDesc
+		{
+			format = callback != null ? 0 : (int)format,
+			path = path,
+			callback = onWrite,
+			startTime = startTime,
+			stopTime = stopTime,
+			bufferFrames = bufferFrames,
+		};
+
+		Ptr = Platform.FosterAudioEngineStartCapture(engine.Ptr, group?.Ptr ?? IntPtr.Zero, desc);
+		if (Ptr == IntPtr.Zero)
+		{
+			throw new Exception("Failed to start AudioCapture");
+		}
+
+		engine.captures.Add(this);
+	}
+
+	/// <summary>
+	/// Stops capturing at <paramref name="timePcmFrames"/> (see <see cref="AudioEngine.TimePcmFrames"/>), or right away when it has already passed. <br/>
+	/// Frames captured before then are still written, call <see cref="Dispose"/> to finish the file.
+	/// </summary>
+	public void Stop(ulong timePcmFrames = 0)
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterCaptureStop(Ptr, timePcmFrames);
+		}
+	}
+
+	/// <summary>
+	/// Stops capturing, waits for everything captured to be written and closes the file
+	/// </summary>
+	public void Dispose()
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			failed = !Platform.FosterCaptureDestroy(Ptr);
+			Engine.captures.Remove(this);
+			Ptr = IntPtr.Zero;
+		}
+	}
+
+	private Platform.FosterCaptureStats GetStats()
+	{
+		Platform.FosterCaptureStats stats = default;
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterCaptureGetStats(Ptr, out stats);
+		}
+		return stats;
+	}
+}
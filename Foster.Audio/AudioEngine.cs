@@ -0,0 +1,417 @@
+﻿using System.Collections.ObjectModel;
+using System.Runtime.InteropServices;
+
+namespace Foster.Audio;
+
+/// <summary>
+/// An independent audio engine with its own device (or none), mixer, listeners, memory and instance limits. <br/>
+/// <see cref="Sound"/>s, <see cref="SoundGroup"/>s and their <see cref="SoundInstance"/>s belong to a single engine. <br/>
+/// The static <see cref="Audio"/> API operates on the default engine created by <see cref="Audio.Startup(AudioStartupOptions?)"/>.
+/// </summary>
+public class AudioEngine : IDisposable
+{
+	/// <summary>
+	/// Master volume
+	/// </summary>
+	public float Volume
+	{
+		get => Platform.FosterAudioEngineGetVolume(Ptr);
+		set => Platform.FosterAudioEngineSetVolume(Ptr, value);
+	}
+
+	/// <summary>
+	/// Audio engine channel count
+	/// </summary>
+	public int Channels { get; }
+
+	/// <summary>
+	/// Audio engine sample rate
+	/// </summary>
+	public int SampleRate { get; }
+
+	/// <summary>
+	/// Audio engine clock in PCM frames (see <seealso cref="SampleRate"/>)
+	/// </summary>
+	public ulong TimePcmFrames
+	{
+		get => Platform.FosterAudioEngineGetTimePcmFrames(Ptr);
+		set => Platform.FosterAudioEngineSetTimePcmFrames(Ptr, value);
+	}
+
+	/// <summary>
+	/// Audio engine clock
+	/// </summary>
+	public TimeSpan Time
+	{
+		get => TimeSpan.FromSeconds(1.0 * TimePcmFrames / SampleRate);
+		set => TimePcmFrames = (ulong)Math.Floor(value.TotalSeconds * SampleRate);
+	}
+
+	/// <summary>
+	/// The maximum number of simultaneously active <see cref="SoundInstance"/>s allowed.
+	/// Instances created after this threshold are inactive and do not play any audio.
+	/// </summary>
+	public int MaxActiveInstances { get; set; } = 100;
+
+	/// <summary>
+	/// The number of currently active <see cref="SoundInstance"/>s
+	/// </summary>
+	public int ActiveInstances { get; internal set; }
+
+	/// <summary>
+	/// The primary (index 0) <see cref="AudioListener"/>
+	/// </summary>
+	public AudioListener Listener { get; }
+
+	/// <summary>
+	/// All available <see cref="AudioListener"/>s
+	/// </summary>
+	public ReadOnlyCollection<AudioListener> Listeners { get; }
+
+	/// <summary>
+	/// All instances currently being tracked, some may be inactive
+	/// </summary>
+	public ReadOnlySpan<SoundInstance> Instances => CollectionsMarshal.AsSpan(instances);
+
+	/// <summary>
+	/// Native memory usage of this engine, see <see cref="AudioMemoryStats"/>
+	/// </summary>
+	public AudioMemoryStats MemoryStats
+	{
+		get
+		{
+			Platform.FosterAudioEngineGetMemoryStats(Ptr, out var stats);
+			return new AudioMemoryStats(stats);
+		}
+	}
+
+	/// <summary>
+	/// Nodes skipped for being silent, see <see cref="AudioStartupOptions.SkipSilentNodes"/>
+	/// </summary>
+	public AudioIdleStats IdleStats
+	{
+		get
+		{
+			Platform.FosterAudioEngineGetIdleStats(Ptr, out var stats);
+			return new AudioIdleStats(stats);
+		}
+	}
+
+	/// <summary>
+	/// Transcodes queued or running in the background, see <see cref="AudioStartupOptions.TranscodeCachePath"/>
+	/// </summary>
+	public int PendingTranscodes => Platform.FosterAudioEngineGetPendingTranscodes(Ptr);
+
+	internal IntPtr Ptr { get; private set; }
+
+	internal readonly List<SoundInstance> instances = new();
+	internal readonly List<AudioCapture> captures = new();
+	internal readonly List<SoundSequence> sequences = new();
+	internal readonly List<StreamingSound> streams = new();
+	internal readonly Dictionary<ulong, Sound> soundsByData = new();
+	internal readonly Dictionary<IntPtr, SoundGroup> groupsByPtr = new();
+
+	// Instance states are per engine so engines never contend on each other's lock, guarded by locking statePool
+	internal readonly Stack<SoundInstance.State> statePool = new();
+	internal readonly Dictionary<IntPtr, SoundInstance.State> statesByPtr = new();
+	internal long nextInstanceId = 1;
+
+	private readonly IntPtr[] finished = new IntPtr[256];
+	private readonly List<SoundInstance> restored = new();
+	private Platform.FosterRestoredSound[] recreated = Array.Empty<Platform.FosterRestoredSound>();
+	private IntPtr[] stale = Array.Empty<IntPtr>();
+	private readonly List<SoundInstance> unprotected = new();
+	private readonly bool isDefault;
+
+	/// <summary>
+	/// Creates a new engine. Use <see cref="AudioStartupOptions.NoDevice"/> for an engine that is only mixed through <see cref="Render"/>.
+	/// </summary>
+	public AudioEngine(AudioStartupOptions? options = null)
+		: this(Platform.FosterAudioEngineCreate((options ?? new()).ToPlatform()), false)
+	{
+	}
+
+	internal AudioEngine(IntPtr ptr, bool isDefault)
+	{
+		if (ptr == IntPtr.Zero)
+		{
+			throw new Exception("Failed to create AudioEngine");
+		}
+
+		Ptr = ptr;
+		this.isDefault = isDefault;
+		Channels = Platform.FosterAudioEngineGetChannels(Ptr);
+		SampleRate = Platform.FosterAudioEngineGetSampleRate(Ptr);
+		Listeners = Enumerable.Range(0, Platform.FosterAudioEngineGetListenerCount(Ptr))
+			.Select(i => new AudioListener(this, i))
+			.ToList()
+			.AsReadOnly();
+		Listener = Listeners[0];
+	}
+
+	public void PlayAll() => ApplyAll(m => m.Play());
+
+	public void PauseAll() => ApplyAll(m => m.Pause());
+
+	public void StopAll() => ApplyAll(m => m.Stop());
+
+	public void ReleaseAll() => ApplyAll(m => m.Release());
+
+	/// <summary>
+	/// Applies an action to all active instances.
+	/// </summary>
+	public void ApplyAll(Action<SoundInstance> action) => Audio.ApplyAll(instances, action);
+
+	/// <summary>
+	/// Starts writing the output of the engine, or of <paramref name="group"/>, to a file at <paramref name="path"/>. <br/>
+	/// Times are in PCM frames (see <see cref="TimePcmFrames"/>), only frames in [<paramref name="startTime"/>, <paramref name="stopTime"/>) are captured.
+	/// </summary>
+	/// <param name="path">output file</param>
+	/// <param name="format">output file format</param>
+	/// <param name="group">group to capture, or null for the engine output</param>
+	/// <param name="startTime">engine time of the first captured frame, 0 to start immediately</param>
+	/// <param name="stopTime">engine time to stop at, 0 to capture until <see cref="AudioCapture.Stop"/> or <see cref="AudioCapture.Dispose"/></param>
+	/// <param name="bufferFrames">ring buffer size in PCM frames, 0 for one second</param>
+	public AudioCapture StartCapture(string path, AudioCaptureFormat format = AudioCaptureFormat.Wav, SoundGroup? group = null, ulong startTime = 0, ulong stopTime = 0, int bufferFrames = 0)
+	{
+		return new AudioCapture(this, group, format, path, null, startTime, stopTime, bufferFrames);
+	}
+
+	/// <summary>
+	/// Starts passing the output of the engine, or of <paramref name="group"/>, to <paramref name="callback"/> on a background thread. <br/>
+	/// See <see cref="StartCapture(string, AudioCaptureFormat, SoundGroup?, ulong, ulong, int)"/> for the parameters.
+	/// </summary>
+	public AudioCapture StartCapture(AudioCaptureCallback callback, SoundGroup? group = null, ulong startTime = 0, ulong stopTime = 0, int bufferFrames = 0)
+	{
+		return new AudioCapture(this, group, default, null, callback, startTime, stopTime, bufferFrames);
+	}
+
+	/// <summary>
+	/// Records the engine clock, every <see cref="SoundGroup"/>'s volume and pitch and the state of every instance in one call, see <see cref="AudioSnapshot"/>. <br/>
+	/// Pass a previous snapshot as <paramref name="reuse"/> to take the new one into its memory instead of allocating.
+	/// </summary>
+	public AudioSnapshot Snapshot(AudioSnapshot? reuse = null)
+	{
+		if (reuse != null && reuse.Engine != this)
+		{
+			throw new ArgumentException("AudioSnapshot belongs to a different AudioEngine", nameof(reuse));
+		}
+
+		var snapshot = reuse ?? new AudioSnapshot(this);
+
+		// Instances may be created between the two calls, so grow until it fits
+		int length, voiceCount;
+		while ((length = Platform.FosterAudioEngineSnapshot(Ptr, snapshot.data, snapshot.data.Length, out voiceCount)) > snapshot.data.Length)
+		{
+			snapshot.data = new byte[length];
+		}
+
+		if (length <= 0)
+		{
+			throw new Exception("Failed to take AudioSnapshot");
+		}
+
+		snapshot.Length = length;
+		snapshot.VoiceCount = voiceCount;
+		return snapshot;
+	}
+
+	/// <summary>
+	/// Brings the engine back to <paramref name="snapshot"/>. Instances still alive only get the state that differs from it applied, so restoring is cheap when little changed. <br/>
+	/// Instances released since are recreated as new <see cref="SoundInstance"/>s, as long as their <see cref="Sound"/> is loaded into memory and not disposed. <br/>
+	/// Instances created since are released, or stopped if <see cref="SoundInstance.Protected"/>.
+	/// </summary>
+	/// <param name="snapshot">snapshot taken from this engine</param>
+	/// <param name="cursorTolerance">instances whose cursor is within this many PCM frames of the snapshot aren't seeked</param>
+	/// <returns>The recreated instances, valid until the next call</returns>
+	public IReadOnlyList<SoundInstance> Restore(AudioSnapshot snapshot, ulong cursorTolerance = 0)
+	{
+		if (snapshot.Engine != this)
+		{
+			throw new ArgumentException("AudioSnapshot belongs to a different AudioEngine", nameof(snapshot));
+		}
+
+		if (recreated.Length < snapshot.VoiceCount)
+		{
+			recreated = new Platform.FosterRestoredSound[snapshot.VoiceCount];
+		}
+		if (stale.Length < instances.Count)
+		{
+			stale = new IntPtr[instances.Count];
+		}
+
+		restored.Clear();
+
+		// Instances that didn't fit are left alone by the native side, restoring again with larger arrays picks them up
+		bool overflowed;
+		do
+		{
+			if (!Platform.FosterAudioEngineRestore(Ptr, snapshot.data, snapshot.Length, cursorTolerance, recreated, recreated.Length, out var recreatedCount, stale, stale.Length, out var staleCount))
+			{
+				throw new Exception("Failed to restore AudioSnapshot");
+			}
+
+			AdoptRestored(Math.Min(recreatedCount, recreated.Length), Math.Min(staleCount, stale.Length));
+
+			overflowed = recreatedCount > recreated.Length || staleCount > stale.Length;
+			if (recreatedCount > recreated.Length)
+			{
+				recreated = new Platform.FosterRestoredSound[recreatedCount];
+			}
+			if (staleCount > stale.Length)
+			{
+				stale = new IntPtr[staleCount];
+			}
+		}
+		while (overflowed);
+
+		return restored;
+	}
+
+	private void AdoptRestored(int recreatedCount, int staleCount)
+	{
+		for (int i = 0; i < staleCount; i++)
+		{
+			SoundInstance.OnRestoreStale(this, stale[i]);
+		}
+
+		for (int i = 0; i < recreatedCount; i++)
+		{
+			var entry = recreated[i];
+			Sound? sound;
+			SoundGroup? group = null;
+			lock (soundsByData)
+			{
+				soundsByData.TryGetValue(entry.dataSerial, out sound);
+			}
+			lock (groupsByPtr)
+			{
+				if (entry.group != IntPtr.Zero)
+				{
+					groupsByPtr.TryGetValue(entry.group, out group);
+				}
+			}
+
+			// Data registered outside of a Sound has nothing to hand the instance to
+			if (sound == null || (entry.group != IntPtr.Zero && group == null))
+			{
+				Platform.FosterSoundDestroy(entry.sound);
+				continue;
+			}
+
+			restored.Add(SoundInstance.Adopt(entry.sound, sound, group));
+		}
+	}
+
+	/// <summary>
+	/// Mixes the next frames of the engine into <paramref name="frames"/> as interleaved 32-bit float samples. <br/>
+	/// Intended for engines created with <see cref="AudioStartupOptions.NoDevice"/>, an engine with a device is already being mixed by it.
+	/// </summary>
+	/// <returns>The number of PCM frames written</returns>
+	public unsafe int Render(Span<float> frames)
+	{
+		fixed (float* pFrames = frames)
+		{
+			return (int)Platform.FosterAudioEngineRender(Ptr, new IntPtr(pFrames), (ulong)(frames.Length / Channels));
+		}
+	}
+
+	/// <summary>
+	/// Runs sound instance management. Call once per frame/update.
+	/// </summary>
+	public void Update()
+	{
+		// Release non-protected instances the audio thread reported as finished
+		int count;
+		do
+		{
+			count = Platform.FosterAudioEnginePollFinished(Ptr, finished, finished.Length, out var overflowed);
+			for (int i = 0; i < count; i++)
+			{
+				SoundInstance.OnFinished(this, finished[i]);
+			}
+
+			// Some notifications were dropped, so fall back to checking every instance
+			if (overflowed)
+			{
+				ApplyAll(m =>
+				{
+					if (!m.Protected && m.Finished)
+					{
+						m.Release();
+					}
+				});
+			}
+		}
+		while (count == finished.Length);
+
+		// Release instances that finished while protected and have since been unprotected
+		lock (unprotected)
+		{
+			foreach (var instance in unprotected)
+			{
+				if (!instance.Protected && instance.Finished)
+				{
+					instance.Release();
+				}
+			}
+			unprotected.Clear();
+		}
+
+		// Release segments that sequences have finished playing
+		foreach (var sequence in sequences)
+		{
+			sequence.Update();
+		}
+	}
+
+	/// <summary>
+	/// Releases every instance and destroys the engine. <br/>
+	/// <see cref="Sound"/>s and <see cref="SoundGroup"/>s created for this engine should be disposed first.
+	/// </summary>
+	public void Dispose()
+	{
+		if (Ptr == IntPtr.Zero)
+		{
+			return;
+		}
+
+		ReleaseAll();
+		for (int i = captures.Count - 1; i >= 0; i--)
+		{
+			captures[i].Dispose();
+		}
+		for (int i = sequences.Count - 1; i >= 0; i--)
+		{
+			sequences[i].Dispose();
+		}
+		for (int i = streams.Count - 1; i >= 0; i--)
+		{
+			streams[i].Dispose();
+		}
+
+		lock (unprotected)
+		{
+			unprotected.Clear();
+		}
+
+		if (isDefault)
+		{
+			Platform.FosterAudioShutdown();
+		}
+		else
+		{
+			Platform.FosterAudioEngineDestroy(Ptr);
+		}
+
+		Ptr = IntPtr.Zero;
+	}
+
+	internal void OnSoundInstanceUnprotected(SoundInstance instance)
+	{
+		lock (unprotected)
+		{
+			unprotected.Add(instance);
+		}
+	}
+}
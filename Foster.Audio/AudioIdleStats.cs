@@ -0,0 +1,42 @@
+﻿namespace Foster.Audio;
+
+/// <summary>
+/// Nodes skipped by the most recent audio callback because they were silent, see <see cref="AudioStartupOptions.SkipSilentNodes"/>. <br/>
+/// A sleeping <see cref="SoundGroup"/> is not pulled at all, <see cref="SkippedNodes"/> also counts the groups and playing sounds below it.
+/// </summary>
+public readonly struct AudioIdleStats
+{
+	/// <summary>
+	/// Groups asleep because their own volume is silent
+	/// </summary>
+	public readonly int SleepingGroups;
+
+	/// <summary>
+	/// Sounds asleep because their own output is silent
+	/// </summary>
+	public readonly int SleepingSounds;
+
+	/// <summary>
+	/// Groups and sounds that were not processed
+	/// </summary>
+	public readonly int SkippedNodes;
+
+	/// <summary>
+	/// Sum of <see cref="SkippedNodes"/> over all callbacks
+	/// </summary>
+	public readonly ulong TotalSkippedNodes;
+
+	/// <summary>
+	/// Number of callbacks the counters cover
+	/// </summary>
+	public readonly ulong Callbacks;
+
+	internal AudioIdleStats(Platform.FosterIdleStats stats)
+	{
+		SleepingGroups = stats.sleepingGroups;
+		SleepingSounds = stats.sleepingSounds;
+		SkippedNodes = stats.skippedNodes;
+		TotalSkippedNodes = stats.totalSkippedNodes;
+		Callbacks = stats.callbacks;
+	}
+}
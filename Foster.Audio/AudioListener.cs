@@ -4,46 +4,49 @@ namespace Foster.Audio;
 
 public class AudioListener
 {
+	public AudioEngine Engine { get; }
+
 	public int Index { get; }
 
 	public bool Enabled
 	{
-		get => Platform.FosterAudioListenerGetEnabled(Index);
-		set => Platform.FosterAudioListenerSetEnabled(Index, value);
+		get => Platform.FosterAudioEngineListenerGetEnabled(Engine.Ptr, Index);
+		set => Platform.FosterAudioEngineListenerSetEnabled(Engine.Ptr, Index, value);
 	}
 
 	public Vector3 Position
 	{
-		get => Platform.FosterAudioListenerGetPosition(Index);
-		set => Platform.FosterAudioListenerSetPosition(Index, value);
+		get => Platform.FosterAudioEngineListenerGetPosition(Engine.Ptr, Index);
+		set => Platform.FosterAudioEngineListenerSetPosition(Engine.Ptr, Index, value);
 	}
 
 	public Vector3 Velocity
 	{
-		get => Platform.FosterAudioListenerGetVelocity(Index);
-		set => Platform.FosterAudioListenerSetVelocity(Index, value);
+		get => Platform.FosterAudioEngineListenerGetVelocity(Engine.Ptr, Index);
+		set => Platform.FosterAudioEngineListenerSetVelocity(Engine.Ptr, Index, value);
 	}
 
 	public Vector3 Direction
 	{
-		get => Platform.FosterAudioListenerGetDirection(Index);
-		set => Platform.FosterAudioListenerSetDirection(Index, value);
+		get => Platform.FosterAudioEngineListenerGetDirection(Engine.Ptr, Index);
+		set => Platform.FosterAudioEngineListenerSetDirection(Engine.Ptr, Index, value);
 	}
 
 	public SoundCone Cone
 	{
-		get => Platform.FosterAudioListenerGetCone(Index);
-		set => Platform.FosterAudioListenerSetCone(Index, value);
+		get => Platform.FosterAudioEngineListenerGetCone(Engine.Ptr, Index);
+		set => Platform.FosterAudioEngineListenerSetCone(Engine.Ptr, Index, value);
 	}
 
 	public Vector3 WorldUp
 	{
-		get => Platform.FosterAudioListenerGetWorldUp(Index);
-		set => Platform.FosterAudioListenerSetWorldUp(Index, value);
+		get => Platform.FosterAudioEngineListenerGetWorldUp(Engine.Ptr, Index);
+		set => Platform.FosterAudioEngineListenerSetWorldUp(Engine.Ptr, Index, value);
 	}
 
-	internal AudioListener(int index)
+	internal AudioListener(AudioEngine engine, int index)
 	{
+		Engine = engine;
 		Index = index;
 	}
 }
@@ -0,0 +1,67 @@
+﻿namespace Foster.Audio;
+
+/// <summary>
+/// Snapshot of native memory usage in bytes, see <see cref="Audio.MemoryStats"/>. <br/>
+/// <see cref="DecodedBytes"/> and <see cref="EncodedBytes"/> include data owned by <see cref="Sound"/>s,
+/// which is not part of <see cref="AllocatedBytes"/>.
+/// </summary>
+public readonly struct AudioMemoryStats
+{
+	/// <summary>
+	/// Decoded PCM data, both registered and decoded by the engine
+	/// </summary>
+	public readonly ulong DecodedBytes;
+
+	/// <summary>
+	/// Encoded data and the decoders reading it
+	/// </summary>
+	public readonly ulong EncodedBytes;
+
+	/// <summary>
+	/// Pages and decoders of streamed sounds
+	/// </summary>
+	public readonly ulong StreamingBytes;
+
+	/// <summary>
+	/// <see cref="SoundInstance"/>s and <see cref="SoundGroup"/>s, including the voice pool
+	/// </summary>
+	public readonly ulong VoiceBytes;
+
+	/// <summary>
+	/// Mixing graph, resamplers and spatializers
+	/// </summary>
+	public readonly ulong DspBytes;
+
+	/// <summary>
+	/// Everything else (device, job queue, bookkeeping)
+	/// </summary>
+	public readonly ulong OtherBytes;
+
+	/// <summary>
+	/// Total bytes currently allocated natively
+	/// </summary>
+	public readonly ulong AllocatedBytes;
+
+	/// <summary>
+	/// Highest value <see cref="AllocatedBytes"/> has reached
+	/// </summary>
+	public readonly ulong PeakAllocatedBytes;
+
+	/// <summary>
+	/// Number of live native allocations
+	/// </summary>
+	public readonly ulong AllocationCount;
+
+	internal unsafe AudioMemoryStats(Platform.FosterMemoryStats stats)
+	{
+		OtherBytes = stats.categoryBytes[0];
+		DecodedBytes = stats.categoryBytes[1];
+		EncodedBytes = stats.categoryBytes[2];
+		StreamingBytes = stats.categoryBytes[3];
+		VoiceBytes = stats.categoryBytes[4];
+		DspBytes = stats.categoryBytes[5];
+		AllocatedBytes = stats.allocatedBytes;
+		PeakAllocatedBytes = stats.peakAllocatedBytes;
+		AllocationCount = stats.allocationCount;
+	}
+}
@@ -0,0 +1,31 @@
+﻿namespace Foster.Audio;
+
+/// <summary>
+/// The engine clock, the volume and pitch of every <see cref="SoundGroup"/> and the state of every <see cref="SoundInstance"/> at one point in time, see <see cref="AudioEngine.Snapshot(AudioSnapshot?)"/>. <br/>
+/// Instances are recorded with their cursor, play state, loop, volume, pitch, pan and spatial parameters. <see cref="StreamingSound"/>s and <see cref="SoundSequence"/>s are left out. <br/>
+/// A snapshot refers to native memory and is only meaningful to the engine that took it, within the same process.
+/// </summary>
+public class AudioSnapshot
+{
+	/// <summary>
+	/// The engine the snapshot was taken from
+	/// </summary>
+	public AudioEngine Engine { get; }
+
+	/// <summary>
+	/// Size of the snapshot in bytes
+	/// </summary>
+	public int Length { get; internal set; }
+
+	/// <summary>
+	/// Number of instances in the snapshot
+	/// </summary>
+	public int VoiceCount { get; internal set; }
+
+	internal byte[] data = Array.Empty<byte>();
+
+	internal AudioSnapshot(AudioEngine engine)
+	{
+		Engine = engine;
+	}
+}
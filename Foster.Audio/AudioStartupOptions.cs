@@ -0,0 +1,123 @@
+﻿namespace Foster.Audio;
+
+/// <summary>
+/// Options used by <see cref="Audio.Startup(AudioStartupOptions?)"/> and <see cref="AudioEngine(AudioStartupOptions?)"/>
+/// </summary>
+public class AudioStartupOptions
+{
+	/// <summary>
+	/// Number of <see cref="SoundInstance"/>s preallocated in a fixed-size pool. <br/>
+	/// Instances beyond this are allocated individually. 0 disables the pool.
+	/// </summary>
+	public int VoicePoolCapacity { get; set; } = 256;
+
+	/// <summary>
+	/// Number of QOA/Vorbis decoder states preallocated in a fixed-size pool. <br/>
+	/// Decoders beyond this are allocated individually. 0 disables the pool.
+	/// </summary>
+	public int DecoderPoolCapacity { get; set; } = 32;
+
+	/// <summary>
+	/// Native allocator used for every native allocation, as unmanaged function pointers. <br/>
+	/// Leave <see cref="NativeAllocator.Malloc"/> zero to use the C runtime allocator. <br/>
+	/// The callbacks are invoked from the audio and loading threads, so they should not be managed delegates.
+	/// </summary>
+	public NativeAllocator Allocator { get; set; }
+
+	/// <summary>
+	/// Output channel count, 0 for the device default (2 when <see cref="NoDevice"/> is set).
+	/// </summary>
+	public int Channels { get; set; }
+
+	/// <summary>
+	/// Output sample rate, 0 for the device default (48000 when <see cref="NoDevice"/> is set).
+	/// </summary>
+	public int SampleRate { get; set; }
+
+	/// <summary>
+	/// Don't open a playback device. The engine is only mixed when calling <see cref="AudioEngine.Render"/>, <br/>
+	/// which is useful for offline rendering, tests and servers.
+	/// </summary>
+	public bool NoDevice { get; set; }
+
+	/// <summary>
+	/// Worker threads used to mix top-level <see cref="SoundGroup"/>s in parallel with the audio thread. <br/>
+	/// Output is identical to mixing on the audio thread alone. Sounds without a group are always mixed on the audio thread. <br/>
+	/// 0 disables parallel mixing.
+	/// </summary>
+	public int MixerThreadCount { get; set; }
+
+	/// <summary>
+	/// Computes the distance attenuation, cones, panning and doppler of all 3D sounds together once per audio callback, <br/>
+	/// instead of separately inside every sound. Output matches the unbatched path, it only pays off with many 3D sounds playing.
+	/// </summary>
+	public bool BatchSpatialization { get; set; }
+
+	/// <summary>
+	/// Stops pulling <see cref="SoundGroup"/>s and <see cref="SoundInstance"/>s whose volume is at or below <see cref="SilenceThreshold"/>, <br/>
+	/// so muted categories cost nothing to mix. Silent sounds keep their place and resume in sync, see <see cref="SoundGroup.VirtualAdvance"/> for muted groups. <br/>
+	/// The distance attenuation of 3D sounds is only taken into account with <see cref="BatchSpatialization"/>.
+	/// </summary>
+	public bool SkipSilentNodes { get; set; }
+
+	/// <summary>
+	/// Linear volume at or below which <see cref="SkipSilentNodes"/> considers a node silent, 0 only skips muted ones
+	/// </summary>
+	public float SilenceThreshold { get; set; }
+
+	/// <summary>
+	/// Directory caching MP3, Vorbis and FLAC sources transcoded to <see cref="TranscodeFormat"/> at the engine sample rate, null to disable. <br/>
+	/// A source is transcoded in the background the first time it's loaded, later loads use the cached file, keyed by content hash, decoder version and format. <br/>
+	/// Sounds created from a path find their cached file by path, size and modification time, so only the first load of a file reads it to hash. <br/>
+	/// <see cref="SoundLoadingMethod.PreloadDecoded"/> decodes the cached file instead, file based methods like <see cref="SoundLoadingMethod.Stream"/> play it instead,
+	/// and <see cref="SoundLoadingMethod.Preload"/> keeps it in memory instead when the format is <see cref="AudioTranscodeFormat.Qoa"/>.
+	/// </summary>
+	public string? TranscodeCachePath { get; set; }
+
+	/// <summary>
+	/// Format sources are transcoded to, see <see cref="TranscodeCachePath"/>
+	/// </summary>
+	public AudioTranscodeFormat TranscodeFormat { get; set; } = AudioTranscodeFormat.Qoa;
+
+	internal Platform.FosterDesc ToPlatform()
+	{
+		if (TranscodeCachePath != null && TranscodeFormat != AudioTranscodeFormat.None)
+		{
+			Directory.CreateDirectory(TranscodeCachePath);
+		}
+
+		return new()
+		{
+			allocator = Allocator.ToPlatform(),
+			voicePoolCapacity = VoicePoolCapacity,
+			decoderPoolCapacity = DecoderPoolCapacity,
+			channels = Channels,
+			sampleRate = SampleRate,
+			noDevice = NoDevice,
+			mixerThreadCount = MixerThreadCount,
+			batchSpatialization = BatchSpatialization,
+			skipSilentNodes = SkipSilentNodes,
+			silenceThreshold = SilenceThreshold,
+			transcodeCachePath = TranscodeCachePath,
+			transcodeFormat = TranscodeFormat
+		};
+	}
+}
+
+/// <summary>
+/// Native allocation callbacks, see <see cref="AudioStartupOptions.Allocator"/>
+/// </summary>
+/// <param name="UserData">passed back to every callback</param>
+/// <param name="Malloc"><c>void* (*)(void* userData, size_t size)</c></param>
+/// <param name="Realloc"><c>void* (*)(void* userData, void* ptr, size_t size)</c>, optional</param>
+/// <param name="Free"><c>void (*)(void* userData, void* ptr)</c></param>
+public readonly record struct NativeAllocator(IntPtr UserData, IntPtr Malloc, IntPtr Realloc, IntPtr Free)
+{
+	internal Platform.FosterAllocator ToPlatform() => new()
+	{
+		userData = UserData,
+		onMalloc = Malloc,
+		onRealloc = Realloc,
+		onFree = Free
+	};
+}
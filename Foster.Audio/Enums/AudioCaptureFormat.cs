@@ -0,0 +1,13 @@
+﻿namespace Foster.Audio;
+
+public enum AudioCaptureFormat
+{
+	/// <summary>
+	/// 32-bit float WAV file
+	/// </summary>
+	Wav = 1,
+	/// <summary>
+	/// QOA file, 16-bit lossy at roughly a fifth of the size of WAV
+	/// </summary>
+	Qoa = 2
+}
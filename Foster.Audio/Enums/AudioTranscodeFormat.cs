@@ -0,0 +1,20 @@
+﻿namespace Foster.Audio;
+
+/// <summary>
+/// Format of the transcode cache, see <see cref="AudioStartupOptions.TranscodeCachePath"/>
+/// </summary>
+public enum AudioTranscodeFormat
+{
+	/// <summary>
+	/// No transcode cache
+	/// </summary>
+	None = 0,
+	/// <summary>
+	/// 32-bit float WAV file, the cheapest to decode at several times the size of <see cref="Qoa"/>
+	/// </summary>
+	Wav = 1,
+	/// <summary>
+	/// QOA file, 16-bit lossy and much cheaper to decode than MP3, Vorbis or FLAC
+	/// </summary>
+	Qoa = 2
+}
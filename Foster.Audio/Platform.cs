@@ -10,6 +10,18 @@ internal static class Platform
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
 	public delegate void FosterLogFn(IntPtr msg);
 
+	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+	public delegate void FosterWriteFn(IntPtr context, IntPtr data, int size);
+
+	[StructLayout(LayoutKind.Sequential)]
+	public struct FosterAllocator
+	{
+		public IntPtr userData;
+		public IntPtr onMalloc;
+		public IntPtr onRealloc;
+		public IntPtr onFree;
+	}
+
 	[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
 	public struct FosterDesc
 	{
@@ -17,6 +29,87 @@ internal static class Platform
 		public FosterLogFn onLogWarn;
 		public FosterLogFn onLogError;
 		public int logging;
+		public FosterAllocator allocator;
+		public int voicePoolCapacity;
+		public int decoderPoolCapacity;
+		public int channels;
+		public int sampleRate;
+		public FosterBool noDevice;
+		public int mixerThreadCount;
+		public FosterBool batchSpatialization;
+		public FosterBool skipSilentNodes;
+		public float silenceThreshold;
+		[MarshalAs(UnmanagedType.LPUTF8Str)]
+		public string? transcodeCachePath;
+		public AudioTranscodeFormat transcodeFormat;
+	}
+
+	[StructLayout(LayoutKind.Sequential)]
+	public unsafe struct FosterMemoryStats
+	{
+		public fixed ulong categoryBytes[6];
+		public ulong allocatedBytes;
+		public ulong peakAllocatedBytes;
+		public ulong allocationCount;
+	}
+
+	[StructLayout(LayoutKind.Sequential)]
+	public struct FosterIdleStats
+	{
+		public int sleepingGroups;
+		public int sleepingSounds;
+		public int skippedNodes;
+		public ulong totalSkippedNodes;
+		public ulong callbacks;
+	}
+
+	[StructLayout(LayoutKind.Sequential)]
+	public struct FosterCaptureDesc
+	{
+		public int format;
+		[MarshalAs(UnmanagedType.LPUTF8Str)]
+		public string? path;
+		public FosterWriteFn? callback;
+		public IntPtr context;
+		public ulong startTime;
+		public ulong stopTime;
+		public int bufferFrames;
+	}
+
+	[StructLayout(LayoutKind.Sequential)]
+	public struct FosterCaptureStats
+	{
+		public ulong capturedFrames;
+		public ulong writtenFrames;
+		public ulong droppedBlocks;
+		public ulong droppedFrames;
+		public FosterBool failed;
+	}
+
+	[StructLayout(LayoutKind.Sequential)]
+	public struct FosterStreamingBufferStats
+	{
+		public ulong queuedFrames;
+		public ulong capacityFrames;
+		public ulong underrunCount;
+		public ulong underrunFrames;
+	}
+
+	[StructLayout(LayoutKind.Sequential)]
+	public struct FosterRestoredSound
+	{
+		public IntPtr sound;
+		public ulong dataSerial;
+		public IntPtr group;
+	}
+
+	[StructLayout(LayoutKind.Sequential)]
+	public struct FosterSequenceSegment
+	{
+		public IntPtr path;
+		public FosterSoundFlags flags;
+		public int loopCount;
+		public ulong crossfadeFrames;
 	}
 
 	public struct FosterBool
@@ -40,11 +133,93 @@ internal static class Platform
 		NO_SPATIALIZATION = 0x00004000
 	}
 
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioEngineCreate(FosterDesc desc);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineDestroy(IntPtr engine);
+	[DllImport(DLL)]
+	public static extern ulong FosterAudioEngineRender(IntPtr engine, IntPtr frames, ulong frameCount);
+	[DllImport(DLL)]
+	public static extern float FosterAudioEngineGetVolume(IntPtr engine);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineSetVolume(IntPtr engine, float value);
+	[DllImport(DLL)]
+	public static extern int FosterAudioEngineGetChannels(IntPtr engine);
+	[DllImport(DLL)]
+	public static extern int FosterAudioEngineGetSampleRate(IntPtr engine);
+	[DllImport(DLL)]
+	public static extern ulong FosterAudioEngineGetTimePcmFrames(IntPtr engine);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineSetTimePcmFrames(IntPtr engine, ulong value);
+	[DllImport(DLL)]
+	public static extern int FosterAudioEngineGetListenerCount(IntPtr engine);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineGetMemoryStats(IntPtr engine, out FosterMemoryStats stats);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineGetIdleStats(IntPtr engine, out FosterIdleStats stats);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioEngineRegisterEncodedData(IntPtr engine, string name, IntPtr data, int length);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioEngineRegisterDecodedData(IntPtr engine, string name, IntPtr data, ulong frameCount, AudioFormat format, int channels, int sampleRate);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioEngineDecodeAndRegisterData(IntPtr engine, string name, IntPtr data, int length, ref AudioFormat format, ref int channels, ref int sampleRate, out ulong frameCount);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineSetDecoderPoolSize(IntPtr engine, string name, int warmCount);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineUnregisterData(IntPtr engine, string name);
+	[DllImport(DLL)]
+	public static extern int FosterAudioEngineGetTranscodedPath(IntPtr engine, string path, byte[] cachedPath, int capacity);
+	[DllImport(DLL)]
+	public static extern int FosterAudioEngineGetPendingTranscodes(IntPtr engine);
+	[DllImport(DLL)]
+	public static extern int FosterAudioEnginePollFinished(IntPtr engine, [Out] IntPtr[] sounds, int capacity, out FosterBool overflowed);
+	[DllImport(DLL)]
+	public static extern int FosterAudioEngineSnapshot(IntPtr engine, byte[]? buffer, int capacity, out int voiceCount);
+	[DllImport(DLL)]
+	public static extern FosterBool FosterAudioEngineRestore(IntPtr engine, byte[] snapshot, int length, ulong cursorTolerance, [Out] FosterRestoredSound[] created, int createdCapacity, out int createdCount, [Out] IntPtr[] stale, int staleCapacity, out int staleCount);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioEngineCreateSound(IntPtr engine, string path, FosterSoundFlags flags, IntPtr soundGroup);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioEngineCreateSoundGroup(IntPtr engine, IntPtr parent);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioEngineCreateStreamingBuffer(IntPtr engine, AudioFormat format, int channels, int sampleRate, ulong capacityFrames, IntPtr soundGroup);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioEngineCreateSequence(IntPtr engine, [In] FosterSequenceSegment[] segments, int segmentCount, IntPtr soundGroup);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioEngineStartCapture(IntPtr engine, IntPtr soundGroup, FosterCaptureDesc desc);
+
+	[DllImport(DLL)]
+	public static extern FosterBool FosterAudioEngineListenerGetEnabled(IntPtr engine, int index);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineListenerSetEnabled(IntPtr engine, int index, FosterBool value);
+	[DllImport(DLL)]
+	public static extern Vector3 FosterAudioEngineListenerGetPosition(IntPtr engine, int index);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineListenerSetPosition(IntPtr engine, int index, Vector3 value);
+	[DllImport(DLL)]
+	public static extern Vector3 FosterAudioEngineListenerGetVelocity(IntPtr engine, int index);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineListenerSetVelocity(IntPtr engine, int index, Vector3 value);
+	[DllImport(DLL)]
+	public static extern Vector3 FosterAudioEngineListenerGetDirection(IntPtr engine, int index);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineListenerSetDirection(IntPtr engine, int index, Vector3 value);
+	[DllImport(DLL)]
+	public static extern SoundCone FosterAudioEngineListenerGetCone(IntPtr engine, int index);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineListenerSetCone(IntPtr engine, int index, SoundCone value);
+	[DllImport(DLL)]
+	public static extern Vector3 FosterAudioEngineListenerGetWorldUp(IntPtr engine, int index);
+	[DllImport(DLL)]
+	public static extern void FosterAudioEngineListenerSetWorldUp(IntPtr engine, int index, Vector3 value);
+
 	[DllImport(DLL)]
 	public static extern void FosterAudioStartup(FosterDesc desc);
 	[DllImport(DLL)]
 	public static extern void FosterAudioShutdown();
 	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioGetEngine();
+	[DllImport(DLL)]
 	public static extern float FosterAudioGetVolume();
 	[DllImport(DLL)]
 	public static extern void FosterAudioSetVolume(float value);
@@ -59,15 +234,35 @@ internal static class Platform
 	[DllImport(DLL)]
 	public static extern int FosterAudioGetListenerCount();
 	[DllImport(DLL)]
+	public static extern void FosterAudioGetMemoryStats(out FosterMemoryStats stats);
+	[DllImport(DLL)]
 	public static extern IntPtr FosterAudioDecode(IntPtr data, int length, ref AudioFormat format, ref int channels, ref int sampleRate, out ulong decodedFrameCount);
 	[DllImport(DLL)]
+	public static extern FosterBool FosterAudioDecodeProbe(IntPtr data, int length, ref AudioFormat format, ref int channels, ref int sampleRate, out ulong frameCount);
+	[DllImport(DLL)]
+	public static extern ulong FosterAudioDecodeInto(IntPtr data, int length, AudioFormat format, int channels, int sampleRate, IntPtr frames, ulong frameCapacity);
+	[DllImport(DLL)]
 	public static extern void FosterAudioFree(IntPtr data);
 	[DllImport(DLL)]
-	public static extern void FosterAudioRegisterEncodedData(string name, IntPtr data, int length);
+	public static extern IntPtr FosterAudioRegisterEncodedData(string name, IntPtr data, int length);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterAudioRegisterDecodedData(string name, IntPtr data, ulong frameCount, AudioFormat format, int channels, int sampleRate);
 	[DllImport(DLL)]
-	public static extern void FosterAudioRegisterDecodedData(string name, IntPtr data, ulong frameCount, AudioFormat format, int channels, int sampleRate);
+	public static extern IntPtr FosterAudioDecodeAndRegisterData(string name, IntPtr data, int length, ref AudioFormat format, ref int channels, ref int sampleRate, out ulong frameCount);
+	[DllImport(DLL)]
+	public static extern void FosterAudioSetDecoderPoolSize(string name, int warmCount);
 	[DllImport(DLL)]
 	public static extern void FosterAudioUnregisterData(string name);
+	[DllImport(DLL)]
+	public static extern int FosterAudioGetTranscodedPath(string path, byte[] cachedPath, int capacity);
+	[DllImport(DLL)]
+	public static extern int FosterAudioGetPendingTranscodes();
+	[DllImport(DLL)]
+	public static extern int FosterAudioPollFinished([Out] IntPtr[] sounds, int capacity, out FosterBool overflowed);
+	[DllImport(DLL)]
+	public static extern int FosterAudioSnapshot(byte[]? buffer, int capacity, out int voiceCount);
+	[DllImport(DLL)]
+	public static extern FosterBool FosterAudioRestore(byte[] snapshot, int length, ulong cursorTolerance, [Out] FosterRestoredSound[] created, int createdCapacity, out int createdCount, [Out] IntPtr[] stale, int staleCapacity, out int staleCount);
 
 	[DllImport(DLL)]
 	public static extern FosterBool FosterAudioListenerGetEnabled(int index);
@@ -97,6 +292,26 @@ internal static class Platform
 	[DllImport(DLL)]
 	public static extern IntPtr FosterSoundCreate(string path, FosterSoundFlags flags, IntPtr soundGroup);
 	[DllImport(DLL)]
+	public static extern ulong FosterRegisteredDataGetSerial(IntPtr data);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterSoundCreateFromData(IntPtr data, FosterSoundFlags flags, IntPtr soundGroup);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterSoundCreateStreamingBuffer(AudioFormat format, int channels, int sampleRate, ulong capacityFrames, IntPtr soundGroup);
+	[DllImport(DLL)]
+	public static extern ulong FosterSoundPushPcm(IntPtr sound, IntPtr frames, ulong frameCount);
+	[DllImport(DLL)]
+	public static extern void FosterSoundGetStreamingBufferStats(IntPtr sound, out FosterStreamingBufferStats stats);
+	[DllImport(DLL)]
+	public static extern IntPtr FosterSoundCreateSequence([In] FosterSequenceSegment[] segments, int segmentCount, IntPtr soundGroup);
+	[DllImport(DLL)]
+	public static extern void FosterSoundSequenceAdvance(IntPtr sound);
+	[DllImport(DLL)]
+	public static extern int FosterSoundSequenceGetIndex(IntPtr sound);
+	[DllImport(DLL)]
+	public static extern ulong FosterSoundSequenceGetLateFrames(IntPtr sound);
+	[DllImport(DLL)]
+	public static extern void FosterSoundSequenceUpdate(IntPtr sound);
+	[DllImport(DLL)]
 	public static extern void FosterSoundPlay(IntPtr sound);
 	[DllImport(DLL)]
 	public static extern void FosterSoundStop(IntPtr sound);
@@ -210,4 +425,20 @@ internal static class Platform
 	public static extern float FosterSoundGroupGetPitch(IntPtr soundGroup);
 	[DllImport(DLL)]
 	public static extern void FosterSoundGroupSetPitch(IntPtr soundGroup, float value);
+	[DllImport(DLL)]
+	public static extern void FosterSoundGroupPlayAll(IntPtr soundGroup, FosterBool recursive);
+	[DllImport(DLL)]
+	public static extern void FosterSoundGroupStopAll(IntPtr soundGroup, FosterBool recursive);
+	[DllImport(DLL)]
+	public static extern FosterBool FosterSoundGroupGetVirtualAdvance(IntPtr soundGroup);
+	[DllImport(DLL)]
+	public static extern void FosterSoundGroupSetVirtualAdvance(IntPtr soundGroup, FosterBool value);
+	[DllImport(DLL)]
+	public static extern FosterBool FosterSoundGroupGetSleeping(IntPtr soundGroup);
+	[DllImport(DLL)]
+	public static extern void FosterCaptureStop(IntPtr capture, ulong time);
+	[DllImport(DLL)]
+	public static extern void FosterCaptureGetStats(IntPtr capture, out FosterCaptureStats stats);
+	[DllImport(DLL)]
+	public static extern FosterBool FosterCaptureDestroy(IntPtr capture);
 }
@@ -24,19 +24,72 @@ public class Sound : IDisposable
 	/// </summary>
 	public SoundLoadingMethod LoadingMethod { get; private set; }
 
+	/// <summary>
+	/// Engine this <see cref="Sound"/> is registered with and plays in
+	/// </summary>
+	public AudioEngine Engine { get; }
+
+	/// <summary>
+	/// Number of decoders kept initialized for new <see cref="SoundInstance"/>s, only used with <see cref="SoundLoadingMethod.Preload"/>. <br/>
+	/// Instances borrow one instead of parsing the encoded headers again and return it rewound when released,
+	/// more are created when all of them are in use. 0 disables pooling.
+	/// </summary>
+	public int DecoderPoolSize
+	{
+		get => decoderPoolSize;
+		set
+		{
+			decoderPoolSize = Math.Max(0, value);
+			if (registered && LoadingMethod == SoundLoadingMethod.Preload)
+			{
+				Platform.FosterAudioEngineSetDecoderPoolSize(Engine.Ptr, Path, decoderPoolSize);
+			}
+		}
+	}
+
 	/// <summary>
 	/// Path to uniquely identify the backing audio data
 	/// </summary>
 	internal string Path { get; private set; } = Guid.NewGuid().ToString();
 
+	/// <summary>
+	/// Native handle of the registered audio data, instances are created from it without looking up <see cref="Path"/>
+	/// </summary>
+	internal IntPtr Data
+	{
+		get => data;
+		private set
+		{
+			// Restoring a snapshot finds the sound of a recreated instance by the serial of its data
+			lock (Engine.soundsByData)
+			{
+				Engine.soundsByData.Remove(dataSerial);
+				data = value;
+				dataSerial = data != IntPtr.Zero ? Platform.FosterRegisteredDataGetSerial(data) : 0;
+				if (data != IntPtr.Zero)
+				{
+					Engine.soundsByData[dataSerial] = this;
+				}
+			}
+		}
+	}
+
+	internal readonly List<SoundInstance> instances = new();
+
 	private GCHandle handle;
 	private IntPtr ptr;
+	private IntPtr data;
+	private ulong dataSerial;
+	private bool registered;
+	private int decoderPoolSize;
 
 	/// <summary>
 	/// Loads encoded data from <paramref name="path"/> using <paramref name="loadingMethod"/>
 	/// </summary>
-	public Sound(string path, SoundLoadingMethod loadingMethod = SoundLoadingMethod.Preload)
+	public Sound(string path, SoundLoadingMethod loadingMethod = SoundLoadingMethod.Preload, AudioEngine? engine = null)
 	{
+		Engine = engine ?? Audio.Engine;
+
 		// Since we actually know the path, we use it instead
 		// This enables streaming/automatic resource dedupe
 		Path = System.IO.Path.GetFullPath(path);
@@ -46,13 +99,18 @@ public class Sound : IDisposable
 			var data = File.ReadAllBytes(Path);
 			LoadEncoded(data, loadingMethod == SoundLoadingMethod.PreloadDecoded);
 		}
+		else if (TryGetTranscodedPath(Path, out var transcoded))
+		{
+			Path = transcoded;
+		}
 	}
 
 	/// <summary>
 	/// Loads encoded data from <paramref name="stream"/> into memory, optionally decoding
 	/// </summary>
-	public Sound(Stream stream, bool decode = false)
+	public Sound(Stream stream, bool decode = false, AudioEngine? engine = null)
 	{
+		Engine = engine ?? Audio.Engine;
 		var data = new byte[stream.Length - stream.Position];
 		stream.Read(data);
 		LoadEncoded(data, decode);
@@ -61,16 +119,18 @@ public class Sound : IDisposable
 	/// <summary>
 	/// Loads encoded data from <paramref name="data"/> into memory, optionally decoding
 	/// </summary>
-	public Sound(byte[] data, bool decode = false)
+	public Sound(byte[] data, bool decode = false, AudioEngine? engine = null)
 	{
+		Engine = engine ?? Audio.Engine;
 		LoadEncoded(data, decode);
 	}
 
 	/// <summary>
 	/// Loads decoded data from <paramref name="data"/> into memory
 	/// </summary>
-	public Sound(byte[] data, AudioFormat format, int channels, int sampleRate, ulong frameCount)
+	public Sound(byte[] data, AudioFormat format, int channels, int sampleRate, ulong frameCount, AudioEngine? engine = null)
 	{
+		Engine = engine ?? Audio.Engine;
 		LoadDecoded(data, format, channels, sampleRate, frameCount);
 	}
 
@@ -80,31 +140,61 @@ public class Sound : IDisposable
 		{
 			var format = AudioFormat.S16; // TODO
 			var channels = 0; // Determine automatically
-			var sampleRate = Audio.SampleRate;
-			if (TryDecode(data, ref format, ref channels, ref sampleRate, out var frameCount, out data!))
-			{
-				LoadDecoded(data, format, channels, sampleRate, frameCount);
-			}
-			else
+			var sampleRate = Engine.SampleRate;
+
+			// Decoded natively straight into the registered buffer, so only one copy of the frames ever exists
+			unsafe
 			{
-				throw new Exception("Failed to decode Sound");
+				fixed (byte* pData = data)
+				{
+					Data = Platform.FosterAudioEngineDecodeAndRegisterData(Engine.Ptr, Path, new IntPtr(pData), data.Length, ref format, ref channels, ref sampleRate, out _);
+					if (Data == IntPtr.Zero)
+					{
+						throw new Exception("Failed to decode Sound");
+					}
+				}
 			}
+
+			LoadingMethod = SoundLoadingMethod.PreloadDecoded;
+			registered = true;
 		}
 		else
 		{
 			LoadingMethod = SoundLoadingMethod.Preload;
 			handle = GCHandle.Alloc(data, GCHandleType.Pinned);
 			ptr = handle.AddrOfPinnedObject();
-			Platform.FosterAudioRegisterEncodedData(Path, ptr, data.Length);
+			Data = Platform.FosterAudioEngineRegisterEncodedData(Engine.Ptr, Path, ptr, data.Length);
+			registered = true;
 		}
 	}
 
+	private bool TryGetTranscodedPath(string path, out string transcoded)
+	{
+		// Longer cache paths report the size they need, so grow until it fits
+		var buffer = new byte[256];
+		int length;
+		while ((length = Platform.FosterAudioEngineGetTranscodedPath(Engine.Ptr, path, buffer, buffer.Length)) > buffer.Length)
+		{
+			buffer = new byte[length];
+		}
+
+		if (length > 0)
+		{
+			transcoded = System.Text.Encoding.UTF8.GetString(buffer, 0, length - 1);
+			return true;
+		}
+
+		transcoded = path;
+		return false;
+	}
+
 	private void LoadDecoded(byte[] data, AudioFormat format, int channels, int sampleRate, ulong frameCount)
 	{
 		LoadingMethod = SoundLoadingMethod.PreloadDecoded;
 		handle = GCHandle.Alloc(data, GCHandleType.Pinned);
 		ptr = handle.AddrOfPinnedObject();
-		Platform.FosterAudioRegisterDecodedData(Path, ptr, frameCount, format, channels, sampleRate);
+		Data = Platform.FosterAudioEngineRegisterDecodedData(Engine.Ptr, Path, ptr, frameCount, format, channels, sampleRate);
+		registered = true;
 	}
 
 	/// <summary>
@@ -154,16 +244,7 @@ public class Sound : IDisposable
 
 	public void ReleaseAll() => ApplyAll(m => m.Release());
 
-	public void ApplyAll(Action<SoundInstance> action)
-	{
-		foreach (var instance in Audio.Instances)
-		{
-			if (instance.Active && instance.Sound == this)
-			{
-				action(instance);
-			}
-		}
-	}
+	public void ApplyAll(Action<SoundInstance> action) => Audio.ApplyAll(instances, action);
 
 	~Sound() => Dispose();
 
@@ -174,16 +255,64 @@ public class Sound : IDisposable
 	{
 		ReleaseAll();
 
+		if (registered)
+		{
+			Data = IntPtr.Zero;
+			if (Engine.Ptr != IntPtr.Zero)
+			{
+				Platform.FosterAudioEngineUnregisterData(Engine.Ptr, Path);
+			}
+			registered = false;
+		}
+
 		if (handle.IsAllocated)
 		{
 			handle.Free();
-			Platform.FosterAudioUnregisterData(Path);
 		}
 
 		handle = default;
 		ptr = default;
 	}
 
+	/// <summary>
+	/// Determines the output of decoding <paramref name="data"/> without decoding it, so a buffer can be sized up front
+	/// </summary>
+	/// <param name="data">encoded data</param>
+	/// <param name="format">sample format, use <see cref="AudioFormat.Unknown"/> to use and return data defined format</param>
+	/// <param name="channels">channels, use 0 to use and return data defined channels</param>
+	/// <param name="sampleRate">sample rate, use 0 to use and return data defined sample rate</param>
+	/// <param name="frameCount">frame count decoding will produce</param>
+	/// <returns>Whether the data can be decoded</returns>
+	public static unsafe bool TryGetDecodedInfo(ReadOnlySpan<byte> data, ref AudioFormat format, ref int channels, ref int sampleRate, out ulong frameCount)
+	{
+		fixed (byte* pData = data)
+		{
+			return Platform.FosterAudioDecodeProbe(new IntPtr(pData), data.Length, ref format, ref channels, ref sampleRate, out frameCount);
+		}
+	}
+
+	/// <summary>
+	/// Decodes <paramref name="data"/> directly into <paramref name="destination"/>. <br/>
+	/// Use <see cref="TryGetDecodedInfo"/> to resolve the parameters and the required size (frameCount * channels * sample size).
+	/// </summary>
+	/// <param name="data">encoded data</param>
+	/// <param name="destination">buffer receiving the decoded frames</param>
+	/// <param name="format">sample format as returned by <see cref="TryGetDecodedInfo"/></param>
+	/// <param name="channels">channels as returned by <see cref="TryGetDecodedInfo"/></param>
+	/// <param name="sampleRate">sample rate as returned by <see cref="TryGetDecodedInfo"/></param>
+	/// <param name="frameCount">decoded frame count, never more than fits in <paramref name="destination"/></param>
+	/// <returns>Whether any data was decoded</returns>
+	public static unsafe bool TryDecode(ReadOnlySpan<byte> data, Span<byte> destination, AudioFormat format, int channels, int sampleRate, out ulong frameCount)
+	{
+		var capacity = (ulong)(destination.Length / (format.GetSampleSize() * channels));
+		fixed (byte* pData = data)
+		fixed (byte* pDestination = destination)
+		{
+			frameCount = Platform.FosterAudioDecodeInto(new IntPtr(pData), data.Length, format, channels, sampleRate, new IntPtr(pDestination), capacity);
+		}
+		return frameCount > 0;
+	}
+
 	/// <summary>
 	/// Attempts to decode <paramref name="data"/> using specified parameters (or determines parameters from encoded data)
 	/// </summary>
@@ -196,27 +325,28 @@ public class Sound : IDisposable
 	/// <returns>Whether the data was successfully decoded</returns>
 	public static bool TryDecode(byte[] data, ref AudioFormat format, ref int channels, ref int sampleRate, out ulong frameCount, out byte[]? decodedData)
 	{
-		frameCount = 0;
 		decodedData = null;
 
-		unsafe
+		if (!TryGetDecodedInfo(data, ref format, ref channels, ref sampleRate, out frameCount))
 		{
-			fixed (byte* pData = data)
-			{
-				var pDecoded = Platform.FosterAudioDecode(new IntPtr(pData), data.Length, ref format, ref channels, ref sampleRate, out frameCount);
-				if(pDecoded == IntPtr.Zero)
-				{
-					return false;
-				}
-				else
-				{
-					var length = format.GetSampleSize() * channels * (int)frameCount;
-					decodedData = new byte[length];
-					new Span<byte>(pDecoded.ToPointer(), length).CopyTo(decodedData);
-					Platform.FosterAudioFree(pDecoded);
-					return true;
-				}
-			}
+			return false;
+		}
+
+		var frameSize = format.GetSampleSize() * channels;
+		var decoded = new byte[frameSize * (int)frameCount];
+		if (!TryDecode(data, decoded, format, channels, sampleRate, out var decodedFrameCount))
+		{
+			return false;
 		}
+
+		// Resampled lengths are estimated, so the decoder may come up a frame short
+		if (decodedFrameCount < frameCount)
+		{
+			Array.Resize(ref decoded, frameSize * (int)decodedFrameCount);
+			frameCount = decodedFrameCount;
+		}
+
+		decodedData = decoded;
+		return true;
 	}
 }
@@ -6,6 +6,8 @@ public class SoundGroup: IDisposable
 
 	public SoundGroup? Parent { get; }
 
+	public AudioEngine Engine { get; }
+
 	public float Volume
 	{
 		get => Platform.FosterSoundGroupGetVolume(Ptr);
@@ -18,23 +20,73 @@ public class SoundGroup: IDisposable
 		set => Platform.FosterSoundGroupSetPitch(Ptr, value);
 	}
 
+	/// <summary>
+	/// While the group is asleep for being silent, its sounds keep advancing so they resume in sync instead of where they were muted. <br/>
+	/// Only applies with <see cref="AudioStartupOptions.SkipSilentNodes"/>. Sequences and streaming sounds pause either way.
+	/// </summary>
+	public bool VirtualAdvance
+	{
+		get => Platform.FosterSoundGroupGetVirtualAdvance(Ptr);
+		set => Platform.FosterSoundGroupSetVirtualAdvance(Ptr, value);
+	}
+
+	/// <summary>
+	/// Whether the group is currently skipped for being silent
+	/// </summary>
+	public bool Sleeping => Platform.FosterSoundGroupGetSleeping(Ptr);
+
 	internal IntPtr Ptr { get; private set; }
 
-	public SoundGroup(string? name = null, SoundGroup? parent = null)
+	internal readonly List<SoundInstance> instances = new();
+
+	private readonly List<SoundGroup> children = new();
+
+	public SoundGroup(string? name = null, SoundGroup? parent = null, AudioEngine? engine = null)
 	{
+		if (parent != null && engine != null && parent.Engine != engine)
+		{
+			throw new ArgumentException("Parent SoundGroup belongs to a different AudioEngine", nameof(parent));
+		}
+
 		Name = name ?? string.Empty;
 		Parent = parent;
-		Ptr = Platform.FosterSoundGroupCreate(Parent?.Ptr ?? IntPtr.Zero);
+		Engine = parent?.Engine ?? engine ?? Audio.Engine;
+		Ptr = Platform.FosterAudioEngineCreateSoundGroup(Engine.Ptr, Parent?.Ptr ?? IntPtr.Zero);
 
 		if (Ptr == IntPtr.Zero)
 		{
 			throw new Exception("Failed to create SoundGroup");
 		}
+
+		Parent?.children.Add(this);
+
+		lock (Engine.groupsByPtr)
+		{
+			Engine.groupsByPtr.Add(Ptr, this);
+		}
 	}
 
-	public void PlayAll(bool recursive = true) => ApplyAll(m => m.Play(), recursive);
+	/// <summary>
+	/// Plays every instance of the group in one native call, <see cref="StreamingSound"/>s and <see cref="SoundSequence"/>s in it are left alone.
+	/// </summary>
+	public void PlayAll(bool recursive = true)
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundGroupPlayAll(Ptr, recursive);
+		}
+	}
 
-	public void PauseAll(bool recursive = true) => ApplyAll(m => m.Pause(), recursive);
+	/// <summary>
+	/// Pauses every instance of the group in one native call, <see cref="StreamingSound"/>s and <see cref="SoundSequence"/>s in it are left alone.
+	/// </summary>
+	public void PauseAll(bool recursive = true)
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundGroupStopAll(Ptr, recursive);
+		}
+	}
 
 	public void StopAll(bool recursive = true) => ApplyAll(m => m.Stop(), recursive);
 
@@ -42,11 +94,13 @@ public class SoundGroup: IDisposable
 
 	public void ApplyAll(Action<SoundInstance> action, bool recursive = true)
 	{
-		foreach (var instance in Audio.Instances)
+		Audio.ApplyAll(instances, action);
+
+		if (recursive)
 		{
-			if (instance.Active && (recursive ? IsChildOrSelf(instance.Group) : (instance.Group == this)))
+			foreach (var child in children)
 			{
-				action(instance);
+				child.ApplyAll(action, recursive);
 			}
 		}
 	}
@@ -74,8 +128,14 @@ public class SoundGroup: IDisposable
 
 		if (Ptr != IntPtr.Zero)
 		{
+			lock (Engine.groupsByPtr)
+			{
+				Engine.groupsByPtr.Remove(Ptr);
+			}
+
 			Platform.FosterSoundGroupDestroy(Ptr);
 			Ptr = IntPtr.Zero;
+			Parent?.children.Remove(this);
 		}
 	}
 }
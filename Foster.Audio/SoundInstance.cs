@@ -9,7 +9,7 @@ namespace Foster.Audio;
 /// Can be explicitly released via <see cref="Release"/>. <br/>
 /// Released instances are marked as inactive. <br/>
 /// <see cref="Active"/> will return false if this sound instance is inactive. <br/>
-/// Additionally, instances will be created as inactive if <see cref="Audio.MaxActiveInstances"/> or <see cref="Sound.MaxActiveInstances"/> has been reached. <br/>
+/// Additionally, instances will be created as inactive if <see cref="AudioEngine.MaxActiveInstances"/> or <see cref="Sound.MaxActiveInstances"/> has been reached. <br/>
 /// Attempting to access or modify an inactive instance will not throw any exceptions and instead silently fail.
 /// </summary>
 public readonly struct SoundInstance
@@ -350,6 +350,12 @@ public readonly struct SoundInstance
 		{
 			if(Active)
 			{
+				// An instance that finished while protected won't be reported again, so hand it back to Audio.Update
+				if (state!.Protected && !value && Finished)
+				{
+					state.Sound.Engine.OnSoundInstanceUnprotected(this);
+				}
+
 				state!.Protected = value;
 			}
 		}
@@ -377,9 +383,6 @@ public readonly struct SoundInstance
 	private readonly long Id;
 	private readonly State? state;
 
-	private static long nextInstanceId = 1;
-	private static readonly Stack<State> statePool = new();
-
 	internal SoundInstance(Sound sound, SoundGroup? group, bool spatialized)
 	{
 		if (sound is null)
@@ -387,11 +390,17 @@ public readonly struct SoundInstance
 			throw new ArgumentNullException(nameof(sound));
 		}
 
+		var engine = sound.Engine;
+		if (group != null && group.Engine != engine)
+		{
+			throw new ArgumentException("SoundGroup belongs to a different AudioEngine than the Sound", nameof(group));
+		}
+
 		Id = 0;
 		state = null;
 
 		// Ensure max sound threshold hasn't been reached
-		if (sound.ActiveInstances >= sound.MaxActiveInstances || Audio.ActiveInstances >= Audio.MaxActiveInstances)
+		if (sound.ActiveInstances >= sound.MaxActiveInstances || engine.ActiveInstances >= engine.MaxActiveInstances)
 		{
 			return;
 		}
@@ -413,38 +422,25 @@ public readonly struct SoundInstance
 			fosterFlags |= Platform.FosterSoundFlags.NO_SPATIALIZATION;
 		}
 
-		// Attempt to create the sound
-		var ptr = Platform.FosterSoundCreate(sound.Path, fosterFlags, group?.Ptr ?? IntPtr.Zero);
+		// Attempt to create the sound, registered data skips marshaling and looking up the path
+		var ptr = sound.Data != IntPtr.Zero
+			? Platform.FosterSoundCreateFromData(sound.Data, fosterFlags, group?.Ptr ?? IntPtr.Zero)
+			: Platform.FosterAudioEngineCreateSound(engine.Ptr, sound.Path, fosterFlags, group?.Ptr ?? IntPtr.Zero);
 
 		// Ensure sound was actually created
 		if (ptr == IntPtr.Zero)
 		{
 			return;
 		}
-		
-		lock(statePool)
-		{
-			// Get new id while we have a lock
-			Id = nextInstanceId++;
-
-			// Acquire and set state
-			if (!statePool.TryPop(out state))
-			{
-				state = new State();
-			}
 
-			state.Id = Id;
-			state.Ptr = ptr;
-			state.Sound = sound;
-			state.Group = group;
-			state.Protected = false;
-
-			// Increment counts while we have a lock
-			Audio.ActiveInstances++;
-			sound.ActiveInstances++;
-		}
+		state = Activate(ptr, sound, group);
+		Id = state.Id;
+	}
 
-		Audio.OnSoundInstanceCreate(this);
+	private SoundInstance(State state)
+	{
+		Id = state.Id;
+		this.state = state;
 	}
 
 	/// <summary>
@@ -455,16 +451,25 @@ public readonly struct SoundInstance
 		if (Active && state != null)
 		{
 			var ptr = state.Ptr;
+			var engine = state.Sound.Engine;
 			
-			lock (statePool)
+			lock (engine.statePool)
 			{
-				// Decrement counts while we have a lock
-				Audio.ActiveInstances--;
+				// Decrement counts and untrack while we have a lock
+				engine.ActiveInstances--;
 				state.Sound.ActiveInstances--;
 
+				engine.statesByPtr.Remove(ptr);
+				Untrack(engine.instances, state.AudioSlot, m => ref m.AudioSlot);
+				Untrack(state.Sound.instances, state.SoundSlot, m => ref m.SoundSlot);
+				if (state.Group != null)
+				{
+					Untrack(state.Group.instances, state.GroupSlot, m => ref m.GroupSlot);
+				}
+
 				// Clear and free state
 				state.Clear();
-				statePool.Push(state);
+				engine.statePool.Push(state);
 			}
 
 			// Attempt to destroy the sound
@@ -522,6 +527,105 @@ public readonly struct SoundInstance
 
 	//public void ScheduleFade(...) { }
 
+	/// <summary>
+	/// Wraps a sound the engine recreated while restoring an <see cref="AudioSnapshot"/>.
+	/// </summary>
+	internal static SoundInstance Adopt(IntPtr ptr, Sound sound, SoundGroup? group)
+	{
+		return new SoundInstance(Activate(ptr, sound, group));
+	}
+
+	/// <summary>
+	/// Releases the instance owning <paramref name="ptr"/> if it is unprotected, it was created after the restored <see cref="AudioSnapshot"/>.
+	/// Protected instances are left stopped.
+	/// </summary>
+	internal static void OnRestoreStale(AudioEngine engine, IntPtr ptr)
+	{
+		State? state;
+		lock (engine.statePool)
+		{
+			engine.statesByPtr.TryGetValue(ptr, out state);
+		}
+
+		if (state != null && !state.Protected)
+		{
+			new SoundInstance(state).Release();
+		}
+	}
+
+	/// <summary>
+	/// Releases the instance owning <paramref name="ptr"/> if it is still active, unprotected and finished.
+	/// </summary>
+	internal static void OnFinished(AudioEngine engine, IntPtr ptr)
+	{
+		State? state;
+		lock (engine.statePool)
+		{
+			engine.statesByPtr.TryGetValue(ptr, out state);
+		}
+
+		// The pointer may have been reused by a newer instance that hasn't finished
+		if (state != null && !state.Protected && Platform.FosterSoundGetFinished(ptr))
+		{
+			new SoundInstance(state).Release();
+		}
+	}
+
+	private static State Activate(IntPtr ptr, Sound sound, SoundGroup? group)
+	{
+		var engine = sound.Engine;
+		lock (engine.statePool)
+		{
+			// Acquire and set state, getting a new id while we have a lock
+			if (!engine.statePool.TryPop(out var state))
+			{
+				state = new State();
+			}
+
+			state.Id = engine.nextInstanceId++;
+			state.Ptr = ptr;
+			state.Sound = sound;
+			state.Group = group;
+			state.Protected = false;
+
+			// Increment counts and track while we have a lock
+			engine.ActiveInstances++;
+			sound.ActiveInstances++;
+
+			var instance = new SoundInstance(state);
+			engine.statesByPtr.Add(ptr, state);
+			state.AudioSlot = Track(engine.instances, instance);
+			state.SoundSlot = Track(sound.instances, instance);
+			if (group != null)
+			{
+				state.GroupSlot = Track(group.instances, instance);
+			}
+
+			return state;
+		}
+	}
+
+	private static int Track(List<SoundInstance> instances, SoundInstance instance)
+	{
+		instances.Add(instance);
+		return instances.Count - 1;
+	}
+
+	private delegate ref int SlotSelector(State state);
+
+	private static void Untrack(List<SoundInstance> instances, int slot, SlotSelector selector)
+	{
+		// Swap the last instance into the freed slot so removal is O(1)
+		var last = instances.Count - 1;
+		if (slot != last)
+		{
+			var moved = instances[last];
+			instances[slot] = moved;
+			selector(moved.state!) = slot;
+		}
+		instances.RemoveAt(last);
+	}
+
 	private T GetPlatform<T>(Func<IntPtr, T> getter)
 	{
 		if (Active)
@@ -550,7 +654,7 @@ public readonly struct SoundInstance
 		}
 	}
 
-	private class State
+	internal class State
 	{
 		public long Id { get; set; }
 		public IntPtr Ptr { get; set; }
@@ -560,6 +664,9 @@ public readonly struct SoundInstance
 		public AudioFormat Format { get; set; }
 		public int Channels { get; set; }
 		public int SampleRate { get; set; }
+		public int AudioSlot;
+		public int SoundSlot;
+		public int GroupSlot;
 
 		public void Clear()
 		{
@@ -571,6 +678,9 @@ public readonly struct SoundInstance
 			Format = default;
 			Channels = default;
 			SampleRate = default;
+			AudioSlot = default;
+			SoundSlot = default;
+			GroupSlot = default;
 		}
 	}
 }
@@ -0,0 +1,184 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Foster.Audio;
+
+/// <summary>
+/// One entry of a <see cref="SoundSequence"/>
+/// </summary>
+/// <param name="Sound">sound to play, loaded the way its <see cref="Sound.LoadingMethod"/> describes</param>
+/// <param name="LoopCount">extra plays of the segment, -1 repeats it until <see cref="SoundSequence.Advance"/></param>
+/// <param name="CrossfadeFrames">frames overlapping with the next segment, in the engine's sample rate</param>
+public readonly record struct SoundSequenceSegment(Sound Sound, int LoopCount = 0, ulong CrossfadeFrames = 0);
+
+/// <summary>
+/// A single voice playing a list of <see cref="Sound"/>s back to back without gaps, for music made of intro, loop and outro parts. <br/>
+/// Each segment is loaded on the job thread while the previous one plays, segments with different formats are converted to the engine's. <br/>
+/// Played segments are released during <see cref="AudioEngine.Update"/>.
+/// </summary>
+public class SoundSequence : IDisposable
+{
+	/// <summary>
+	/// Segments in playback order
+	/// </summary>
+	public IReadOnlyList<SoundSequenceSegment> Segments { get; }
+
+	/// <summary>
+	/// Engine this sequence plays in
+	/// </summary>
+	public AudioEngine Engine { get; }
+
+	/// <summary>
+	/// Sound group this sequence plays in, if any
+	/// </summary>
+	public SoundGroup? Group { get; }
+
+	/// <summary>
+	/// Index of the segment playing, equal to the segment count once the sequence has finished
+	/// </summary>
+	public int CurrentSegment => Ptr != IntPtr.Zero ? Platform.FosterSoundSequenceGetIndex(Ptr) : Segments.Count;
+
+	/// <summary>
+	/// Frames played as silence because a segment wasn't loaded in time
+	/// </summary>
+	public ulong LateFrames => Ptr != IntPtr.Zero ? Platform.FosterSoundSequenceGetLateFrames(Ptr) : 0;
+
+	public float Volume
+	{
+		get => Ptr != IntPtr.Zero ? Platform.FosterSoundGetVolume(Ptr) : 0f;
+		set { if (Ptr != IntPtr.Zero) Platform.FosterSoundSetVolume(Ptr, value); }
+	}
+
+	public float Pitch
+	{
+		get => Ptr != IntPtr.Zero ? Platform.FosterSoundGetPitch(Ptr) : 0f;
+		set { if (Ptr != IntPtr.Zero) Platform.FosterSoundSetPitch(Ptr, value); }
+	}
+
+	public float Pan
+	{
+		get => Ptr != IntPtr.Zero ? Platform.FosterSoundGetPan(Ptr) : 0f;
+		set { if (Ptr != IntPtr.Zero) Platform.FosterSoundSetPan(Ptr, value); }
+	}
+
+	public bool Playing => Ptr != IntPtr.Zero && Platform.FosterSoundGetPlaying(Ptr);
+
+	public bool Finished => Ptr == IntPtr.Zero || Platform.FosterSoundGetFinished(Ptr);
+
+	internal IntPtr Ptr { get; private set; }
+
+	/// <summary>
+	/// Creates a sequence of <paramref name="segments"/>, which must all belong to the same engine
+	/// </summary>
+	public SoundSequence(IEnumerable<SoundSequenceSegment> segments, SoundGroup? group = null)
+	{
+		Segments = segments.ToArray();
+		if (Segments.Count == 0)
+		{
+			throw new ArgumentException("A SoundSequence needs at least one segment", nameof(segments));
+		}
+
+		Group = group;
+		Engine = group?.Engine ?? Segments[0].Sound.Engine;
+		foreach (var segment in Segments)
+		{
+			if (segment.Sound.Engine != Engine)
+			{
+				throw new ArgumentException("Segment belongs to a different AudioEngine", nameof(segments));
+			}
+		}
+
+		var native = new Platform.FosterSequenceSegment[Segments.Count];
+		try
+		{
+			for (int i = 0; i < native.Length; i++)
+			{
+				var segment = Segments[i];
+				Platform.FosterSoundFlags flags = 0;
+
+				if (segment.Sound.LoadingMethod == SoundLoadingMethod.Stream)
+				{
+					flags |= Platform.FosterSoundFlags.STREAM;
+				}
+				else if (segment.Sound.LoadingMethod is SoundLoadingMethod.PreloadDecoded or SoundLoadingMethod.LoadOnDemandDecoded)
+				{
+					flags |= Platform.FosterSoundFlags.DECODE;
+				}
+
+				native[i] = new()
+				{
+					path = Marshal.StringToCoTaskMemUTF8(segment.Sound.Path),
+					flags = flags,
+					loopCount = segment.LoopCount,
+					crossfadeFrames = segment.CrossfadeFrames,
+				};
+			}
+
+			// paths are copied natively
+			Ptr = Platform.FosterAudioEngineCreateSequence(Engine.Ptr, native, native.Length, group?.Ptr ?? IntPtr.Zero);
+		}
+		finally
+		{
+			foreach (var segment in native)
+			{
+				Marshal.FreeCoTaskMem(segment.path);
+			}
+		}
+
+		if (Ptr == IntPtr.Zero)
+		{
+			throw new Exception("Failed to create SoundSequence");
+		}
+
+		Engine.sequences.Add(this);
+	}
+
+	public SoundSequence(params SoundSequenceSegment[] segments)
+		: this((IEnumerable<SoundSequenceSegment>)segments)
+	{
+	}
+
+	public void Play()
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundPlay(Ptr);
+		}
+	}
+
+	public void Pause()
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundStop(Ptr);
+		}
+	}
+
+	/// <summary>
+	/// Ends the looping of the current segment, the next one starts once the current iteration has played
+	/// </summary>
+	public void Advance()
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundSequenceAdvance(Ptr);
+		}
+	}
+
+	public void Dispose()
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundDestroy(Ptr);
+			Engine.sequences.Remove(this);
+			Ptr = IntPtr.Zero;
+		}
+	}
+
+	internal void Update()
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundSequenceUpdate(Ptr);
+		}
+	}
+}
@@ -0,0 +1,182 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Foster.Audio;
+
+/// <summary>
+/// A single voice playing PCM pushed from code, for procedural audio, voice chat or video playback. <br/>
+/// Frames are copied into a fixed-size lock-free ring buffer that the audio thread drains. <br/>
+/// The sound never finishes on its own, running out of data plays silence and is counted as an underrun. <br/>
+/// <see cref="Push(ReadOnlySpan{byte})"/> must only be called from one thread at a time. <br/>
+/// The engine keeps the sound alive until it is disposed, disposing the engine disposes it too.
+/// </summary>
+public class StreamingSound : IDisposable
+{
+	/// <summary>
+	/// Sample format of pushed frames
+	/// </summary>
+	public AudioFormat Format { get; }
+
+	/// <summary>
+	/// Channel count of pushed frames
+	/// </summary>
+	public int Channels { get; }
+
+	/// <summary>
+	/// Sample rate of pushed frames, resampled to the engine's rate during playback
+	/// </summary>
+	public int SampleRate { get; }
+
+	/// <summary>
+	/// Size of the ring buffer in PCM frames
+	/// </summary>
+	public int CapacityFrames { get; }
+
+	/// <summary>
+	/// Engine this sound plays in
+	/// </summary>
+	public AudioEngine Engine { get; }
+
+	/// <summary>
+	/// Sound group this sound plays in, if any
+	/// </summary>
+	public SoundGroup? Group { get; }
+
+	/// <summary>
+	/// Frames pushed but not yet played
+	/// </summary>
+	public int QueuedFrames => (int)GetStats().queuedFrames;
+
+	/// <summary>
+	/// Frames that can currently be pushed without being dropped
+	/// </summary>
+	public int FreeFrames => CapacityFrames - QueuedFrames;
+
+	/// <summary>
+	/// How full the buffer is, from 0 to 1
+	/// </summary>
+	public float FillLevel => 1f * QueuedFrames / CapacityFrames;
+
+	/// <summary>
+	/// Number of times playback ran out of pushed data
+	/// </summary>
+	public ulong UnderrunCount => GetStats().underrunCount;
+
+	/// <summary>
+	/// Total frames replaced with silence because playback ran out of pushed data
+	/// </summary>
+	public ulong UnderrunFrames => GetStats().underrunFrames;
+
+	public float Volume
+	{
+		get => Ptr != IntPtr.Zero ? Platform.FosterSoundGetVolume(Ptr) : 0f;
+		set { if (Ptr != IntPtr.Zero) Platform.FosterSoundSetVolume(Ptr, value); }
+	}
+
+	public float Pitch
+	{
+		get => Ptr != IntPtr.Zero ? Platform.FosterSoundGetPitch(Ptr) : 0f;
+		set { if (Ptr != IntPtr.Zero) Platform.FosterSoundSetPitch(Ptr, value); }
+	}
+
+	public float Pan
+	{
+		get => Ptr != IntPtr.Zero ? Platform.FosterSoundGetPan(Ptr) : 0f;
+		set { if (Ptr != IntPtr.Zero) Platform.FosterSoundSetPan(Ptr, value); }
+	}
+
+	public bool Playing => Ptr != IntPtr.Zero && Platform.FosterSoundGetPlaying(Ptr);
+
+	internal IntPtr Ptr { get; private set; }
+
+	private readonly int bytesPerFrame;
+
+	/// <summary>
+	/// Creates a streaming sound holding up to <paramref name="capacityFrames"/> frames of pushed PCM
+	/// </summary>
+	public StreamingSound(AudioFormat format, int channels, int sampleRate, int capacityFrames, SoundGroup? group = null, AudioEngine? engine = null)
+	{
+		if (group != null && engine != null && group.Engine != engine)
+		{
+			throw new ArgumentException("SoundGroup belongs to a different AudioEngine", nameof(group));
+		}
+
+		Format = format;
+		Channels = channels;
+		SampleRate = sampleRate;
+		CapacityFrames = capacityFrames;
+		Group = group;
+		Engine = group?.Engine ?? engine ?? Audio.Engine;
+		bytesPerFrame = format.GetSampleSize() * channels;
+		Ptr = Platform.FosterAudioEngineCreateStreamingBuffer(Engine.Ptr, format, channels, sampleRate, (ulong)capacityFrames, group?.Ptr ?? IntPtr.Zero);
+
+		if (Ptr == IntPtr.Zero)
+		{
+			throw new Exception("Failed to create StreamingSound");
+		}
+
+		Engine.streams.Add(this);
+	}
+
+	/// <summary>
+	/// Queues interleaved frames in <see cref="Format"/>. Frames that don't fit are dropped.
+	/// </summary>
+	/// <returns>The number of frames queued</returns>
+	public unsafe int Push(ReadOnlySpan<byte> frames)
+	{
+		if (Ptr == IntPtr.Zero)
+		{
+			return 0;
+		}
+
+		fixed (byte* pFrames = frames)
+		{
+			return (int)Platform.FosterSoundPushPcm(Ptr, new IntPtr(pFrames), (ulong)(frames.Length / bytesPerFrame));
+		}
+	}
+
+	/// <summary>
+	/// Queues interleaved samples, <typeparamref name="T"/> must match <see cref="Format"/> (for example <see cref="float"/> for <see cref="AudioFormat.F32"/>).
+	/// Frames that don't fit are dropped.
+	/// </summary>
+	/// <returns>The number of frames queued</returns>
+	public int Push<T>(ReadOnlySpan<T> samples) where T : unmanaged
+	{
+		return Push(MemoryMarshal.AsBytes(samples));
+	}
+
+	public void Play()
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundPlay(Ptr);
+		}
+	}
+
+	public void Pause()
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundStop(Ptr);
+		}
+	}
+
+	public void Dispose()
+	{
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundDestroy(Ptr);
+			Engine.streams.Remove(this);
+			Ptr = IntPtr.Zero;
+		}
+	}
+
+	private Platform.FosterStreamingBufferStats GetStats()
+	{
+		Platform.FosterStreamingBufferStats stats = default;
+		if (Ptr != IntPtr.Zero)
+		{
+			Platform.FosterSoundGetStreamingBufferStats(Ptr, out stats);
+		}
+		return stats;
+	}
+}
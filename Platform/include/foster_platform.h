@@ -2,6 +2,7 @@
 #define FOSTER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Export API
@@ -56,11 +57,52 @@ typedef enum FosterSoundAttenuationModel
 	FOSTER_SOUND_ATTENUATION_MODEL_EXPONENTIAL
 } FosterSoundAttenuationModel;
 
+typedef enum FosterCaptureFormat
+{
+	FOSTER_CAPTURE_FORMAT_CALLBACK,
+	FOSTER_CAPTURE_FORMAT_WAV,
+	FOSTER_CAPTURE_FORMAT_QOA
+} FosterCaptureFormat;
+
+typedef enum FosterTranscodeFormat
+{
+	FOSTER_TRANSCODE_FORMAT_NONE,
+	FOSTER_TRANSCODE_FORMAT_WAV,
+	FOSTER_TRANSCODE_FORMAT_QOA
+} FosterTranscodeFormat;
+
+typedef enum FosterMemoryCategory
+{
+	FOSTER_MEMORY_CATEGORY_OTHER,
+	FOSTER_MEMORY_CATEGORY_DECODED,
+	FOSTER_MEMORY_CATEGORY_ENCODED,
+	FOSTER_MEMORY_CATEGORY_STREAMING,
+	FOSTER_MEMORY_CATEGORY_VOICES,
+	FOSTER_MEMORY_CATEGORY_DSP,
+	FOSTER_MEMORY_CATEGORY_COUNT
+} FosterMemoryCategory;
+
 typedef void (FOSTER_CALL * FosterLogFn)(const char *msg);
 typedef void (FOSTER_CALL * FosterWriteFn)(void *context, void *data, int size);
+typedef void* (FOSTER_CALL * FosterMallocFn)(void *userData, size_t size);
+typedef void* (FOSTER_CALL * FosterReallocFn)(void *userData, void *ptr, size_t size);
+typedef void (FOSTER_CALL * FosterFreeFn)(void *userData, void *ptr);
 
+typedef struct FosterAudioEngine FosterAudioEngine;
 typedef struct FosterSound FosterSound;
 typedef struct FosterSoundGroup FosterSoundGroup;
+typedef struct FosterCapture FosterCapture;
+typedef struct FosterRegisteredData FosterRegisteredData;
+
+// Allocator used for every native allocation. Leave onMalloc and onFree NULL to use the C runtime allocator,
+// setting only one of them is rejected. onRealloc is optional, it is emulated with onMalloc/onFree when NULL.
+typedef struct FosterAllocator
+{
+	void* userData;
+	FosterMallocFn onMalloc;
+	FosterReallocFn onRealloc;
+	FosterFreeFn onFree;
+} FosterAllocator;
 
 typedef struct FosterDesc
 {
@@ -68,8 +110,93 @@ typedef struct FosterDesc
 	FosterLogFn onLogWarn;
 	FosterLogFn onLogError;
 	FosterLogging logging;
+	FosterAllocator allocator;
+	int voicePoolCapacity;    // sounds preallocated in a fixed-size pool, 0 to disable
+	int decoderPoolCapacity;  // QOA/Vorbis decoder states preallocated in a fixed-size pool, 0 to disable
+	int channels;             // output channel count, 0 for the device default
+	int sampleRate;           // output sample rate, 0 for the device default
+	FosterBool noDevice;      // don't open a playback device, mix on demand with FosterAudioEngineRender
+	int mixerThreadCount;     // worker threads mixing top-level sound groups in parallel, 0 mixes everything on the audio thread
+	FosterBool batchSpatialization; // spatialize all 3D sounds together once per callback instead of one at a time
+	FosterBool skipSilentNodes; // stop pulling groups and sounds whose volume is at or below silenceThreshold
+	float silenceThreshold;     // linear volume, 0 only skips muted groups and sounds
+	const char* transcodeCachePath; // existing directory caching compressed sources transcoded at the engine rate, NULL to disable
+	FosterTranscodeFormat transcodeFormat; // QOA, or 32-bit float WAV trading disk and memory for the cheapest decode
 } FosterDesc;
 
+// Bytes currently in use per category. Decoded and encoded include caller-owned registered data,
+// which is not part of the allocated total.
+typedef struct FosterMemoryStats
+{
+	uint64_t categoryBytes[FOSTER_MEMORY_CATEGORY_COUNT];
+	uint64_t allocatedBytes;
+	uint64_t peakAllocatedBytes;
+	uint64_t allocationCount;
+} FosterMemoryStats;
+
+// Groups and sounds skipped by the most recent callback because they were silent. A sleeping group
+// isn't pulled at all, skippedNodes also counts the groups and playing sounds below it.
+typedef struct FosterIdleStats
+{
+	int sleepingGroups;
+	int sleepingSounds;
+	int skippedNodes;
+	uint64_t totalSkippedNodes;
+	uint64_t callbacks;
+} FosterIdleStats;
+
+// Fill level and starvation of a streaming buffer sound. An underrun is counted once per stretch
+// of reads that found the buffer short, underrunFrames counts the frames that were replaced with silence.
+typedef struct FosterStreamingBufferStats
+{
+	uint64_t queuedFrames;
+	uint64_t capacityFrames;
+	uint64_t underrunCount;
+	uint64_t underrunFrames;
+} FosterStreamingBufferStats;
+
+// A voice recreated by FosterAudioEngineRestore, with the serial of the registered data and the group it was created from.
+typedef struct FosterRestoredSound
+{
+	FosterSound* sound;
+	uint64_t dataSerial;
+	FosterSoundGroup* group;
+} FosterRestoredSound;
+
+// One entry of a sequence. Segments play back to back without gaps, each one is loaded on the
+// job thread while the previous one plays.
+typedef struct FosterSequenceSegment
+{
+	const char* path;           // registered name or file path
+	FosterSoundFlags flags;     // FOSTER_SOUND_FLAG_STREAM or FOSTER_SOUND_FLAG_DECODE
+	int loopCount;              // extra plays of the segment, -1 repeats it until FosterSoundSequenceAdvance
+	uint64_t crossfadeFrames;   // frames overlapping with the next segment, in the engine's sample rate
+} FosterSequenceSegment;
+
+// What to capture and where to write it. Times are engine times in PCM frames, frames outside of
+// [startTime, stopTime) are not captured. The callback receives interleaved 32-bit float frames on the writer thread.
+typedef struct FosterCaptureDesc
+{
+	FosterCaptureFormat format;
+	const char* path;          // output file for WAV and QOA
+	FosterWriteFn callback;    // receives the frames for FOSTER_CAPTURE_FORMAT_CALLBACK
+	void* context;
+	uint64_t startTime;        // 0 to start immediately
+	uint64_t stopTime;         // 0 to capture until FosterCaptureStop
+	int bufferFrames;          // ring buffer between the audio and writer threads, 0 for one second
+} FosterCaptureDesc;
+
+// A dropped block is a mixed block that didn't fit in the ring buffer because the writer fell behind.
+// failed is set once writing the file failed, it's logged and nothing captured after it is written.
+typedef struct FosterCaptureStats
+{
+	uint64_t capturedFrames;
+	uint64_t writtenFrames;
+	uint64_t droppedBlocks;
+	uint64_t droppedFrames;
+	FosterBool failed;
+} FosterCaptureStats;
+
 typedef struct Vector3
 {
 	float x, y, z;
@@ -84,10 +211,122 @@ typedef struct FosterSoundCone
 extern "C" {
 #endif
 
+// Engines are fully independent: each owns its device, resource manager, job thread, pools and
+// memory stats. Sounds and groups can't be shared across engines.
+FOSTER_API FosterAudioEngine* FosterAudioEngineCreate(FosterDesc desc);
+
+FOSTER_API void FosterAudioEngineDestroy(FosterAudioEngine* engine);
+
+// Mixes the next frameCount frames of a device-less engine as interleaved f32 and returns the frames written.
+FOSTER_API uint64_t FosterAudioEngineRender(FosterAudioEngine* engine, float* frames, uint64_t frameCount);
+
+FOSTER_API float FosterAudioEngineGetVolume(FosterAudioEngine* engine);
+
+FOSTER_API void FosterAudioEngineSetVolume(FosterAudioEngine* engine, float value);
+
+FOSTER_API int FosterAudioEngineGetChannels(FosterAudioEngine* engine);
+
+FOSTER_API int FosterAudioEngineGetSampleRate(FosterAudioEngine* engine);
+
+FOSTER_API uint64_t FosterAudioEngineGetTimePcmFrames(FosterAudioEngine* engine);
+
+FOSTER_API void FosterAudioEngineSetTimePcmFrames(FosterAudioEngine* engine, uint64_t value);
+
+FOSTER_API int FosterAudioEngineGetListenerCount(FosterAudioEngine* engine);
+
+FOSTER_API void FosterAudioEngineGetMemoryStats(FosterAudioEngine* engine, FosterMemoryStats* stats);
+
+FOSTER_API void FosterAudioEngineGetIdleStats(FosterAudioEngine* engine, FosterIdleStats* stats);
+
+// Registration returns a handle for FosterSoundCreateFromData, or NULL on failure. It stays valid until
+// FosterAudioEngineUnregisterData is called with the same name.
+// With a QOA transcode cache, compressed data that was transcoded before registers the cached QOA instead,
+// otherwise its transcode is queued for the next load.
+FOSTER_API FosterRegisteredData* FosterAudioEngineRegisterEncodedData(FosterAudioEngine* engine, const char* name, void* data, int length);
+
+FOSTER_API FosterRegisteredData* FosterAudioEngineRegisterDecodedData(FosterAudioEngine* engine, const char* name, const void* data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate);
+
+// Decodes encoded data once into a natively owned buffer and registers it, so no intermediate copy is made.
+// format, channels and sampleRate are the requested output (0 keeps the source) and receive the actual values.
+// The buffer is released by FosterAudioEngineUnregisterData. With a transcode cache, a cached transcode is decoded
+// instead of compressed data, otherwise its transcode is queued for the next load.
+FOSTER_API FosterRegisteredData* FosterAudioEngineDecodeAndRegisterData(FosterAudioEngine* engine, const char* name, void* data, int length, FosterAudioFormat* format, int* channels, int* sampleRate, uint64_t* frameCount);
+
+// Keeps warmCount decoders over registered encoded data initialized between sounds. Sounds created from name
+// without FOSTER_SOUND_FLAG_STREAM or FOSTER_SOUND_FLAG_DECODE borrow one and give it back rewound when destroyed,
+// so they skip header parsing and codebook setup. More are initialized when they run out, 0 releases the pool.
+FOSTER_API void FosterAudioEngineSetDecoderPoolSize(FosterAudioEngine* engine, const char* name, int warmCount);
+
+FOSTER_API void FosterAudioEngineUnregisterData(FosterAudioEngine* engine, const char* name);
+
+// Writes the path of the cached transcode of the file at path to cachedPath, to stream or load instead of the file.
+// Returns the size of the path with its terminator, or the size needed without writing anything when it doesn't fit
+// in capacity. Returns 0 when there is none yet and queues the transcode, or when the file doesn't need one.
+FOSTER_API int FosterAudioEngineGetTranscodedPath(FosterAudioEngine* engine, const char* path, char* cachedPath, int capacity);
+
+// Transcodes queued or running in the background.
+FOSTER_API int FosterAudioEngineGetPendingTranscodes(FosterAudioEngine* engine);
+
+FOSTER_API int FosterAudioEnginePollFinished(FosterAudioEngine* engine, FosterSound** sounds, int capacity, FosterBool* overflowed);
+
+// Writes the engine clock, the volume and pitch of every group and the state of every voice to buffer in one go:
+// its registered data, cursor, play state, loop, volume, pitch, pan and spatial parameters. Streaming buffers and
+// sequences are left out. Returns the size of the snapshot, or the size needed without writing anything when it
+// doesn't fit in capacity, or 0 when out of memory. voiceCount receives the voices written. Snapshots hold serials
+// and only mean something to the engine that took them.
+FOSTER_API int FosterAudioEngineSnapshot(FosterAudioEngine* engine, void* buffer, int capacity, int* voiceCount);
+
+// Brings the engine back to a snapshot. Voices and groups still alive only get the state that differs from it,
+// cursors within cursorTolerance frames of the snapshot aren't seeked. Voices destroyed since are recreated from
+// their registered data, while it's still registered, and written to created. Voices created since are stopped
+// and written to stale. createdCount and staleCount receive how many there are, which can exceed the capacities:
+// voices past createdCapacity aren't recreated and voices past staleCapacity aren't written, restoring again with
+// larger arrays picks them up. Returns false when snapshot isn't a snapshot.
+FOSTER_API FosterBool FosterAudioEngineRestore(FosterAudioEngine* engine, const void* snapshot, int length, uint64_t cursorTolerance, FosterRestoredSound* created, int createdCapacity, int* createdCount, FosterSound** stale, int staleCapacity, int* staleCount);
+
+FOSTER_API FosterBool FosterAudioEngineListenerGetEnabled(FosterAudioEngine* engine, int index);
+
+FOSTER_API void FosterAudioEngineListenerSetEnabled(FosterAudioEngine* engine, int index, FosterBool value);
+
+FOSTER_API Vector3 FosterAudioEngineListenerGetPosition(FosterAudioEngine* engine, int index);
+
+FOSTER_API void FosterAudioEngineListenerSetPosition(FosterAudioEngine* engine, int index, Vector3 value);
+
+FOSTER_API Vector3 FosterAudioEngineListenerGetVelocity(FosterAudioEngine* engine, int index);
+
+FOSTER_API void FosterAudioEngineListenerSetVelocity(FosterAudioEngine* engine, int index, Vector3 value);
+
+FOSTER_API Vector3 FosterAudioEngineListenerGetDirection(FosterAudioEngine* engine, int index);
+
+FOSTER_API void FosterAudioEngineListenerSetDirection(FosterAudioEngine* engine, int index, Vector3 value);
+
+FOSTER_API FosterSoundCone FosterAudioEngineListenerGetCone(FosterAudioEngine* engine, int index);
+
+FOSTER_API void FosterAudioEngineListenerSetCone(FosterAudioEngine* engine, int index, FosterSoundCone value);
+
+FOSTER_API Vector3 FosterAudioEngineListenerGetWorldUp(FosterAudioEngine* engine, int index);
+
+FOSTER_API void FosterAudioEngineListenerSetWorldUp(FosterAudioEngine* engine, int index, Vector3 value);
+
+FOSTER_API FosterSound* FosterAudioEngineCreateSound(FosterAudioEngine* engine, const char* path, FosterSoundFlags flags, FosterSoundGroup* soundGroup);
+
+FOSTER_API FosterSoundGroup* FosterAudioEngineCreateSoundGroup(FosterAudioEngine* engine, FosterSoundGroup* parent);
+
+FOSTER_API FosterSound* FosterAudioEngineCreateStreamingBuffer(FosterAudioEngine* engine, FosterAudioFormat format, int channels, int sampleRate, uint64_t capacityFrames, FosterSoundGroup* soundGroup);
+
+FOSTER_API FosterSound* FosterAudioEngineCreateSequence(FosterAudioEngine* engine, const FosterSequenceSegment* segments, int segmentCount, FosterSoundGroup* soundGroup);
+
+// Captures the output of soundGroup, or of the whole engine when NULL. Copying never blocks the audio thread,
+// a background thread writes the frames out. A group can only have one capture at a time.
+FOSTER_API FosterCapture* FosterAudioEngineStartCapture(FosterAudioEngine* engine, FosterSoundGroup* soundGroup, FosterCaptureDesc desc);
+
+// The FosterAudio* functions below operate on the default engine created by FosterAudioStartup.
 FOSTER_API void FosterAudioStartup(FosterDesc desc);
 
 FOSTER_API void FosterAudioShutdown();
 
+FOSTER_API FosterAudioEngine* FosterAudioGetEngine();
+
 FOSTER_API float FosterAudioGetVolume();
 
 FOSTER_API void FosterAudioSetVolume(int index, float value);
@@ -102,16 +341,45 @@ FOSTER_API void FosterAudioSetTimePcmFrames(int index, uint64_t value);
 
 FOSTER_API int FosterAudioGetListenerCount();
 
+FOSTER_API void FosterAudioGetMemoryStats(FosterMemoryStats* stats);
+
+FOSTER_API void FosterAudioGetIdleStats(FosterIdleStats* stats);
+
 FOSTER_API void* FosterAudioDecode(void* data, int length, FosterAudioFormat* format, int* channels, int* sampleRate, uint64_t* decodedFrameCount);
 
+// Reports the output format and frame count FosterAudioDecodeInto will produce, without decoding into memory.
+// format, channels and sampleRate are the requested output (0 keeps the source) and receive the actual values.
+FOSTER_API FosterBool FosterAudioDecodeProbe(void* data, int length, FosterAudioFormat* format, int* channels, int* sampleRate, uint64_t* frameCount);
+
+// Decodes directly into a caller-provided buffer of frameCapacity frames, returning the frames written.
+FOSTER_API uint64_t FosterAudioDecodeInto(void* data, int length, FosterAudioFormat format, int channels, int sampleRate, void* frames, uint64_t frameCapacity);
+
 FOSTER_API void FosterAudioFree(void* data);
 
-FOSTER_API void FosterAudioRegisterEncodedData(const char* name, void* data, int length);
+FOSTER_API FosterRegisteredData* FosterAudioRegisterEncodedData(const char* name, void* data, int length);
 
-FOSTER_API void FosterAudioRegisterDecodedData(const char* name, const void* data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate);
+FOSTER_API FosterRegisteredData* FosterAudioRegisterDecodedData(const char* name, const void* data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate);
+
+FOSTER_API FosterRegisteredData* FosterAudioDecodeAndRegisterData(const char* name, void* data, int length, FosterAudioFormat* format, int* channels, int* sampleRate, uint64_t* frameCount);
+
+FOSTER_API void FosterAudioSetDecoderPoolSize(const char* name, int warmCount);
 
 FOSTER_API void FosterAudioUnregisterData(const char* name);
 
+FOSTER_API int FosterAudioGetTranscodedPath(const char* path, char* cachedPath, int capacity);
+
+FOSTER_API int FosterAudioGetPendingTranscodes();
+
+// Drains sounds that reached their end since the last call. If the internal queue overflowed,
+// overflowed is set and the caller should fall back to checking FosterSoundGetFinished itself.
+FOSTER_API int FosterAudioPollFinished(FosterSound** sounds, int capacity, FosterBool* overflowed);
+
+FOSTER_API int FosterAudioSnapshot(void* buffer, int capacity, int* voiceCount);
+
+FOSTER_API FosterBool FosterAudioRestore(const void* snapshot, int length, uint64_t cursorTolerance, FosterRestoredSound* created, int createdCapacity, int* createdCount, FosterSound** stale, int staleCapacity, int* staleCount);
+
+FOSTER_API FosterCapture* FosterAudioStartCapture(FosterSoundGroup* soundGroup, FosterCaptureDesc desc);
+
 FOSTER_API FosterBool FosterAudioListenerGetEnabled(int index);
 
 FOSTER_API void FosterAudioListenerSetEnabled(int index, FosterBool value);
@@ -138,6 +406,36 @@ FOSTER_API void FosterAudioListenerSetWorldUp(int index, Vector3 value);
 
 FOSTER_API FosterSound* FosterSoundCreate(const char* path, FosterSoundFlags flags, FosterSoundGroup* soundGroup);
 
+// Identifies a registration in snapshots and FosterRestoredSound, unique for the lifetime of its engine.
+FOSTER_API uint64_t FosterRegisteredDataGetSerial(FosterRegisteredData* data);
+
+// Creates a sound from registered data without looking its name up, in the engine it was registered with.
+// FOSTER_SOUND_FLAG_STREAM is ignored, registered data is always in memory.
+FOSTER_API FosterSound* FosterSoundCreateFromData(FosterRegisteredData* data, FosterSoundFlags flags, FosterSoundGroup* soundGroup);
+
+// Creates a sound playing PCM pushed with FosterSoundPushPcm. It never finishes, running dry plays
+// silence and is reported as an underrun. Pushing must happen from a single thread at a time.
+FOSTER_API FosterSound* FosterSoundCreateStreamingBuffer(FosterAudioFormat format, int channels, int sampleRate, uint64_t capacityFrames, FosterSoundGroup* soundGroup);
+
+// Queues interleaved frames in the sound's format, returns how many fit in the buffer.
+FOSTER_API uint64_t FosterSoundPushPcm(FosterSound* sound, const void* frames, uint64_t frameCount);
+
+FOSTER_API void FosterSoundGetStreamingBufferStats(FosterSound* sound, FosterStreamingBufferStats* stats);
+
+FOSTER_API FosterSound* FosterSoundCreateSequence(const FosterSequenceSegment* segments, int segmentCount, FosterSoundGroup* soundGroup);
+
+// Ends the looping of the current segment once its current iteration has played.
+FOSTER_API void FosterSoundSequenceAdvance(FosterSound* sound);
+
+// Index of the segment playing, equal to the segment count once the sequence has finished.
+FOSTER_API int FosterSoundSequenceGetIndex(FosterSound* sound);
+
+// Frames played as silence because a segment wasn't loaded in time.
+FOSTER_API uint64_t FosterSoundSequenceGetLateFrames(FosterSound* sound);
+
+// Releases segments that finished playing. Call regularly from the game thread, never from a callback.
+FOSTER_API void FosterSoundSequenceUpdate(FosterSound* sound);
+
 FOSTER_API void FosterSoundPlay(FosterSound* sound);
 
 FOSTER_API void FosterSoundStop(FosterSound* sound);
@@ -252,6 +550,28 @@ FOSTER_API float FosterSoundGroupGetPitch(FosterSoundGroup* soundGroup);
 
 FOSTER_API void FosterSoundGroupSetPitch(FosterSoundGroup* soundGroup, float value);
 
+// Plays or pauses the sounds of the group, streaming buffers and sequences are left alone.
+FOSTER_API void FosterSoundGroupPlayAll(FosterSoundGroup* soundGroup, FosterBool recursive);
+
+FOSTER_API void FosterSoundGroupStopAll(FosterSoundGroup* soundGroup, FosterBool recursive);
+
+// When the group sleeps for being silent, its sounds keep advancing their cursors so they resume in sync
+// instead of where they were muted. Sequences and streaming buffers always pause.
+FOSTER_API FosterBool FosterSoundGroupGetVirtualAdvance(FosterSoundGroup* soundGroup);
+
+FOSTER_API void FosterSoundGroupSetVirtualAdvance(FosterSoundGroup* soundGroup, FosterBool value);
+
+FOSTER_API FosterBool FosterSoundGroupGetSleeping(FosterSoundGroup* soundGroup);
+
+// Stops capturing at the given engine time, or right away when it has already passed.
+FOSTER_API void FosterCaptureStop(FosterCapture* capture, uint64_t time);
+
+FOSTER_API void FosterCaptureGetStats(FosterCapture* capture, FosterCaptureStats* stats);
+
+// Stops the capture, waits for the writer to flush everything captured so far and closes the output.
+// Returns false when writing or closing the file failed.
+FOSTER_API FosterBool FosterCaptureDestroy(FosterCapture* capture);
+
 #if __cplusplus
 }
 #endif
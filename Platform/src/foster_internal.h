@@ -4,16 +4,480 @@
 #include "foster_platform.h"
 #include "third_party/miniaudio.h"
 
+#define FOSTER_FINISHED_QUEUE_CAPACITY 1024
+#define FOSTER_JOB_THREAD_COUNT 1
+#define FOSTER_MIXER_MAX_THREADS 16
+
+#if defined(_MSC_VER)
+	#define FOSTER_THREAD_LOCAL __declspec(thread)
+#else
+	#define FOSTER_THREAD_LOCAL __thread
+#endif
+
+typedef struct FosterMemory FosterMemory;
+typedef struct FosterPcmStream FosterPcmStream;
+typedef struct FosterSequence FosterSequence;
+
+// routes miniaudio allocation callbacks into a FosterMemory under a category
+typedef struct
+{
+	FosterMemory* memory;
+	FosterMemoryCategory category;
+} FosterAllocationContext;
+
+// fixed-size block allocator, falls back to the general allocator once exhausted
+typedef struct
+{
+	FosterMemory* owner;
+	unsigned char* memory;
+	size_t blockSize;
+	ma_uint32 capacity;
+	void* freeList;
+	ma_spinlock lock;
+	FosterMemoryCategory category;
+} FosterPool;
+
+// linear allocator for engine lifetime state, released all at once on shutdown
+typedef struct
+{
+	unsigned char* memory;
+	size_t capacity;
+	size_t used;
+} FosterArena;
+
+// data registered with the resource manager, tracked for memory accounting and handed out for FosterSoundCreateFromData
+// owned is set when the data was allocated natively and is released along with the registration
+// node is a reference of its own on the resource manager's data buffer node, NULL for untracked registrations
+struct FosterRegisteredData
+{
+	FosterRegisteredData* next;
+	FosterMemoryCategory category;
+	const void* data;
+	size_t size;
+	void* owned;
+	FosterAudioEngine* engine;
+	ma_resource_manager_data_buffer_node* node;
+	ma_uint64 serial;
+	char name[];
+};
+
+struct FosterMemory
+{
+	FosterAllocator allocator;
+	FosterAllocationContext contexts[FOSTER_MEMORY_CATEGORY_COUNT + 1];
+	ma_uint64 categoryBytes[FOSTER_MEMORY_CATEGORY_COUNT];
+	ma_uint64 allocatedBytes;
+	ma_uint64 peakAllocatedBytes;
+	ma_uint64 allocationCount;
+	FosterArena arena;
+	FosterPool voicePool;
+	FosterPool decoderPool;
+	ma_spinlock registryLock;
+	FosterRegisteredData* registry;
+};
+
+typedef struct FosterDecoderPool FosterDecoderPool;
+
+// a playing voice, ma_sound must stay the first member so the two can be cast freely
+struct FosterSound
+{
+	ma_sound sound;
+	FosterAudioEngine* engine;
+	FosterPcmStream* stream;
+	FosterSequence* sequence;
+	ma_decoder* decoder;
+	FosterDecoderPool* decoderPool;
+	ma_uint64 dataSerial;
+	ma_uint32 flags;
+	ma_uint64 serial;
+	ma_uint32 spatialIndex;
+	ma_uint32 spatialListener;
+	float spatialCone[4];
+	float spatialGain;
+	ma_uint32 idleIndex;
+	ma_uint32 idleState;
+	ma_uint32 idleWork;
+	double idleFrames;
+	ma_uint64 idleRemaining;
+	FosterSoundGroup* group;
+	FosterSound* prev;
+	FosterSound* next;
+};
+
+typedef struct FosterMixBranch FosterMixBranch;
+typedef struct FosterCapture FosterCapture;
+typedef struct FosterQoaWriter FosterQoaWriter;
+
+// push-fed PCM source, written by one game thread and read by the audio thread
+// ma_data_source_base must stay the first member
+struct FosterPcmStream
+{
+	ma_data_source_base ds;
+	ma_pcm_rb buffer;
+	ma_format format;
+	ma_uint32 channels;
+	ma_uint32 sampleRate;
+	ma_uint64 cursor;
+	ma_uint64 underrunCount;
+	ma_uint64 underrunFrames;
+	ma_uint32 starved;
+};
+
+// lifetime of a sequence segment, loading happens on the job thread and releasing on the game thread
+typedef enum
+{
+	FOSTER_SEQUENCE_SLOT_IDLE,
+	FOSTER_SEQUENCE_SLOT_LOADING,
+	FOSTER_SEQUENCE_SLOT_READY,
+	FOSTER_SEQUENCE_SLOT_FAILED,
+	FOSTER_SEQUENCE_SLOT_RETIRED,
+	FOSTER_SEQUENCE_SLOT_RELEASED
+} FosterSequenceSlotState;
+
+// signalled by the resource manager once a segment's source is playable, ma_async_notification_callbacks must stay the first member
+typedef struct
+{
+	ma_async_notification_callbacks cb;
+	FosterSequence* sequence;
+	ma_uint32 index;
+} FosterSequenceNotification;
+
+typedef struct
+{
+	ma_resource_manager_data_source source;
+	ma_data_converter converter;
+	FosterSequenceNotification loaded;
+	ma_uint32 arrivals;
+	char* path;
+	ma_uint32 flags;
+	ma_int32 loopCount;
+	ma_uint64 crossfadeFrames;
+	ma_uint64 length;
+	ma_uint32 state;
+	ma_bool32 sourceInitialized;
+	ma_bool32 converterInitialized;
+} FosterSequenceSlot;
+
+// plays segments back to back in the engine's format, the segment after the current one is
+// loaded ahead of time so switching never waits, ma_data_source_base must stay the first member
+struct FosterSequence
+{
+	ma_data_source_base ds;
+	FosterAudioEngine* engine;
+	FosterSequenceSlot* slots;
+	ma_uint32 slotCount;
+	ma_uint32 channels;
+	ma_uint32 sampleRate;
+	ma_uint32 current;
+	ma_int32 loopsRemaining;
+	ma_uint32 advance;
+	ma_uint32 loadJobs;
+	ma_semaphore loadsDone;
+	ma_uint32 cancelled;
+	ma_uint64 cursor;
+	ma_uint64 lateFrames;
+};
+
+// a mixing group, tracks its member sounds and child groups so group operations are O(members)
+struct FosterSoundGroup
+{
+	ma_sound_group group;
+	FosterAudioEngine* engine;
+	FosterMixBranch* branch;
+	FosterSoundGroup* parent;
+	FosterSoundGroup* firstChild;
+	FosterSoundGroup* nextSibling;
+	FosterSound* firstSound;
+	FosterCapture* capture;
+	ma_uint64 serial;
+	ma_uint32 idleIndex;
+	ma_bool32 idleAsleep;
+	ma_bool32 virtualAdvance;
+};
+
+// decoders over the encoded data of one registration, kept initialized between the sounds playing it
+// referenced by the engine's list and by every borrowed decoder, so it outlives whichever lets go last
+struct FosterDecoderPool
+{
+	FosterDecoderPool* next;
+	FosterAudioEngine* engine;
+	const void* data;
+	size_t size;
+	ma_uint32 references;
+	ma_uint32 warmCount;
+	ma_decoder** idle;
+	ma_uint32 idleCount;
+	ma_uint32 idleCapacity;
+	char name[];
+};
+
+// bounded multi-producer/single-consumer queue of sounds that reached their end
+typedef struct
+{
+	ma_uint32 sequence;
+	FosterSound* sound;
+} FosterFinishedSlot;
+
+typedef struct
+{
+	FosterFinishedSlot slots[FOSTER_FINISHED_QUEUE_CAPACITY];
+	ma_uint32 writeIndex;
+	ma_uint32 readIndex;
+	ma_uint32 overflowed;
+} FosterFinishedQueue;
+
+// a top-level group mixed on the mixer threads, the node stands in for the group on the endpoint
+// and plays back what was rendered for the current block, ma_node_base must stay the first member
+struct FosterMixBranch
+{
+	ma_node_base node;
+	FosterSoundGroup* group;
+	ma_node* source;
+	float* frames;
+	ma_uint32 frameCount;
+	ma_uint32 cursor;
+};
+
+// branches mixed in parallel, never changed once published so the audio thread reads it without locking
+// a replaced list is retired until the epoch it was replaced in is over
+typedef struct FosterMixBranchList FosterMixBranchList;
+struct FosterMixBranchList
+{
+	FosterMixBranchList* next;
+	ma_uint32 retiredEpoch;
+	ma_uint32 count;
+	FosterMixBranch* branches[];
+};
+
+// fork/join mixer for top-level groups, the audio thread renders branches alongside the workers
+// lock only keeps changes from other threads apart, epoch counts the callbacks the audio thread finished
+typedef struct
+{
+	ma_uint32 threadCount;
+	ma_thread threads[FOSTER_MIXER_MAX_THREADS];
+	ma_semaphore wake;
+	ma_semaphore done;
+	ma_uint32 quit;
+	ma_uint32 channels;
+	ma_uint32 blockFrames;
+	ma_spinlock lock;
+	FosterMixBranchList* branches;
+	FosterMixBranchList* retired;
+	ma_uint32 rendering;
+	ma_uint32 epoch;
+	FosterMixBranchList* round;
+	ma_uint32 roundFrames;
+	ma_uint64 roundTime;
+	ma_uint32 nextBranch;
+	ma_uint32 remaining;
+} FosterMixer;
+
+// listener state shared by every voice it spatializes, computed once per callback
+typedef struct
+{
+	float transform[4][3];
+	ma_vec3f position;
+	ma_vec3f velocity;
+	float speedOfSound;
+	float forward;
+	float coneInner;
+	float coneOuter;
+	float coneGain;
+	float channelX[MA_MAX_CHANNELS];
+	float channelY[MA_MAX_CHANNELS];
+	float channelZ[MA_MAX_CHANNELS];
+	float channelSpatial[MA_MAX_CHANNELS];
+} FosterSpatialListener;
+
+// the 3D voices of an engine as structure-of-arrays, gathered once per callback so gains, panning
+// and doppler are computed across voices, each ma_spatializer then only applies its gains
+typedef struct
+{
+	ma_spinlock lock;
+	ma_bool32 enabled;
+	FosterSound** voices;
+	ma_uint32 voiceCount;
+	ma_uint32 capacity;
+	ma_uint32 stride;
+	ma_uint32 channels;
+	void* block;
+	FosterSound** active;
+	ma_uint32 listenerBegin[MA_ENGINE_MAX_LISTENERS + 1];
+	FosterSpatialListener listeners[MA_ENGINE_MAX_LISTENERS];
+	float* posX;
+	float* posY;
+	float* posZ;
+	float* dirX;
+	float* dirY;
+	float* dirZ;
+	float* velX;
+	float* velY;
+	float* velZ;
+	float* relative;
+	float* model;
+	float* minDistance;
+	float* maxDistance;
+	float* rolloff;
+	float* coneInner;
+	float* coneOuter;
+	float* coneGain;
+	float* minGain;
+	float* maxGain;
+	float* directional;
+	float* minChannelGain;
+	float* dopplerFactor;
+	float* pitch;
+	float* channelGains;
+} FosterSpatialBatch;
+
+// a voice is put to sleep while its output is below the silence threshold, it keeps counting as playing
+// and its cursor is moved past the skipped frames when it wakes, ENDING voices were advanced past their end
+typedef enum
+{
+	FOSTER_IDLE_AWAKE,
+	FOSTER_IDLE_ASLEEP,
+	FOSTER_IDLE_ENDING
+} FosterIdleState;
+
+// seeking and measuring a voice can reach into its decoder, so the callback queues them and runs them outside of groupLock
+typedef enum
+{
+	FOSTER_IDLE_WORK_MEASURE,
+	FOSTER_IDLE_WORK_ADVANCE,
+	FOSTER_IDLE_WORK_WAKE
+} FosterIdleWork;
+
+// work shares the allocation of items and has the same capacity, only the callback uses it
+typedef struct
+{
+	void** items;
+	void** work;
+	ma_uint32 count;
+	ma_uint32 capacity;
+} FosterIdleList;
+
+// every group and voice of an engine, checked once per callback so silent ones stop being pulled when enabled
+// and walked by snapshots either way, the lists and idle states are guarded by the engine's groupLock
+// working is set while the callback seeks voices it queued, anything touching a voice's cursor waits for it under the lock
+// deferredFrames are the frames of callbacks that found the lock taken and skipped their pass, only the callback uses them
+typedef struct
+{
+	ma_bool32 enabled;
+	float threshold;
+	FosterIdleList groups;
+	FosterIdleList voices;
+	ma_uint32 working;
+	ma_uint64 deferredFrames;
+	ma_uint32 sleepingGroups;
+	ma_uint32 sleepingSounds;
+	ma_uint32 skippedNodes;
+	ma_uint64 totalSkippedNodes;
+	ma_uint64 callbacks;
+} FosterIdle;
+
+// taps the engine output or a group and hands the frames to a writer thread through a lock-free ring
+// group captures are a passthrough node between the group and its destination, ma_node_base must stay the first member
+struct FosterCapture
+{
+	ma_node_base node;
+	FosterAudioEngine* engine;
+	FosterSoundGroup* group;
+	FosterCapture* next;
+	ma_bool32 master;
+	FosterCaptureFormat format;
+	char* path;
+	FosterWriteFn callback;
+	void* context;
+	ma_uint32 channels;
+	ma_uint32 sampleRate;
+	ma_pcm_rb buffer;
+	ma_thread thread;
+	ma_semaphore wake;
+	ma_uint32 quit;
+	ma_uint64 startTime;
+	ma_uint64 stopTime;
+	ma_uint64 cursor;
+	ma_uint64 capturedFrames;
+	ma_uint64 writtenFrames;
+	ma_uint64 droppedBlocks;
+	ma_uint64 droppedFrames;
+	ma_uint32 failed;
+	FILE* file;
+	ma_encoder encoder;
+	FosterQoaWriter* qoa;
+};
+
+typedef struct
+{
+	ma_uint64 serial;
+	void* item;
+} FosterSnapshotEntry;
+
+// voices and groups are told apart across snapshots by serial, pointers get reused by the voice pool
+// live is the restore's sorted copy of the idle lists, kept between restores so they don't allocate
+typedef struct
+{
+	ma_uint64 nextSerial;
+	FosterSnapshotEntry* live;
+	ma_uint32 liveCapacity;
+} FosterSnapshots;
+
+typedef struct FosterTranscodeJob FosterTranscodeJob;
+
+// on-disk cache of compressed sources transcoded to QOA or WAV at the engine sample rate
+// transcodes run on their own thread so they never hold up streaming pages on the job thread
+typedef struct
+{
+	char* path;
+	FosterTranscodeFormat format;
+	ma_job_queue queue;
+	ma_thread thread;
+	ma_uint32 cancelled;
+	ma_uint32 pending;
+	ma_spinlock lock;
+	FosterTranscodeJob* jobs;
+} FosterTranscodeCache;
+
+// an independent engine, nothing here is shared with other engines
+// ma_engine must stay the first member, the device callback only knows about the ma_engine
+struct FosterAudioEngine
+{
+	ma_engine engine;
+	FosterDesc desc;
+	ma_resource_manager resourceManager;
+	ma_thread jobThreads[FOSTER_JOB_THREAD_COUNT];
+	FosterMemory memory;
+	ma_spinlock groupLock;
+	FosterFinishedQueue finished;
+	FosterMixer mixer;
+	FosterSpatialBatch spatial;
+	FosterIdle idle;
+	ma_spinlock decoderPoolLock;
+	ma_uint32 decoderPoolCount;
+	FosterDecoderPool* decoderPools;
+	ma_spinlock captureLock;
+	FosterCapture* captures;
+	FosterTranscodeCache transcode;
+	FosterSnapshots snapshots;
+};
+
 // foster global state
 typedef struct
 {
 	FosterBool running;
 	FosterDesc desc;
-	ma_engine* audioEngine;
+	FosterAudioEngine* audioEngine;
+	FosterMemory memory;
 } FosterState;
 
 FosterState* FosterGetState();
 
+void* FosterMalloc(FosterMemory* memory, size_t size, FosterMemoryCategory category);
+
+void* FosterRealloc(FosterMemory* memory, void* ptr, size_t size, FosterMemoryCategory category);
+
+void FosterFree(void* ptr);
+
 void FosterLogInfo(const char* fmt, ...);
 
 void FosterLogWarn(const char* fmt, ...);
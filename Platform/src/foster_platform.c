@@ -16,6 +16,15 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <float.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
 
 #define FOSTER_MAX_MESSAGE_SIZE 1024
 
@@ -41,23 +50,465 @@ static Vector3 vec3f_to_Vector3(ma_vec3f v)
 	return value;
 }
 
+// begin Memory
+
+#define FOSTER_MEMORY_ALIGNMENT 16
+
+// pseudo category for callbacks that don't know what they're allocating, resolved per thread
+#define FOSTER_MEMORY_CATEGORY_THREAD FOSTER_MEMORY_CATEGORY_COUNT
+
+typedef union
+{
+	struct
+	{
+		FosterMemory* memory;
+		size_t size;
+		FosterMemoryCategory category;
+	} info;
+	unsigned char padding[2 * FOSTER_MEMORY_ALIGNMENT];
+} FosterAllocationHeader;
+
+// what the resource manager is currently doing on this thread, set around calls into it and per job
+static FOSTER_THREAD_LOCAL FosterMemoryCategory fosterThreadCategory = FOSTER_MEMORY_CATEGORY_OTHER;
+
+static size_t FosterAlign(size_t size)
+{
+	return (size + (FOSTER_MEMORY_ALIGNMENT - 1)) & ~(size_t)(FOSTER_MEMORY_ALIGNMENT - 1);
+}
+
+// frees have to reach whoever allocated, so onMalloc and onFree come together or not at all
+static ma_bool32 FosterAllocatorValid(const FosterAllocator* allocator)
+{
+	return (allocator->onMalloc == NULL) == (allocator->onFree == NULL);
+}
+
+static void FosterMemoryInit(FosterMemory* memory, FosterAllocator allocator)
+{
+	MA_ZERO_OBJECT(memory);
+	if (!FosterAllocatorValid(&allocator))
+	{
+		FosterLogError("Allocator needs both onMalloc and onFree, using the C runtime allocator");
+		MA_ZERO_OBJECT(&allocator);
+	}
+	memory->allocator = allocator;
+	for (int i = 0; i <= FOSTER_MEMORY_CATEGORY_COUNT; i++)
+	{
+		memory->contexts[i].memory = memory;
+		memory->contexts[i].category = (FosterMemoryCategory)i;
+	}
+
+	// pools start empty and fall back to the general allocator until FosterMemoryInitPools
+	memory->voicePool.owner = memory;
+	memory->voicePool.category = FOSTER_MEMORY_CATEGORY_VOICES;
+	memory->decoderPool.owner = memory;
+	memory->decoderPool.category = FOSTER_MEMORY_CATEGORY_ENCODED;
+}
+
+static void FosterMemoryTrack(FosterMemory* memory, FosterMemoryCategory category, ma_int64 bytes)
+{
+	ma_atomic_fetch_add_64(&memory->categoryBytes[category], (ma_uint64)bytes);
+}
+
+static void FosterMemoryTrackAllocation(FosterMemory* memory, FosterMemoryCategory category, ma_int64 bytes)
+{
+	FosterMemoryTrack(memory, category, bytes);
+
+	ma_uint64 allocated = ma_atomic_fetch_add_64(&memory->allocatedBytes, (ma_uint64)bytes) + (ma_uint64)bytes;
+	ma_atomic_fetch_add_64(&memory->allocationCount, bytes >= 0 ? 1 : (ma_uint64)-1);
+
+	ma_uint64 peak = ma_atomic_load_64(&memory->peakAllocatedBytes);
+	while (allocated > peak && !ma_atomic_compare_exchange_weak_64(&memory->peakAllocatedBytes, &peak, allocated));
+}
+
+static void* FosterRawMalloc(const FosterAllocator* allocator, size_t size)
+{
+	if (allocator->onMalloc != NULL)
+		return allocator->onMalloc(allocator->userData, size);
+	return ma_malloc(size, NULL);
+}
+
+static void FosterRawFree(const FosterAllocator* allocator, void* ptr)
+{
+	if (allocator->onFree != NULL)
+		allocator->onFree(allocator->userData, ptr);
+	else
+		ma_free(ptr, NULL);
+}
+
+static void* FosterRawRealloc(const FosterAllocator* allocator, void* ptr, size_t oldSize, size_t size)
+{
+	if (allocator->onMalloc == NULL)
+		return ma_realloc(ptr, size, NULL);
+	if (allocator->onRealloc != NULL)
+		return allocator->onRealloc(allocator->userData, ptr, size);
+
+	void* result = allocator->onMalloc(allocator->userData, size);
+	if (result != NULL)
+	{
+		MA_COPY_MEMORY(result, ptr, oldSize < size ? oldSize : size);
+		FosterRawFree(allocator, ptr);
+	}
+	return result;
+}
+
+void* FosterMalloc(FosterMemory* memory, size_t size, FosterMemoryCategory category)
+{
+	FosterAllocationHeader* header = FosterRawMalloc(&memory->allocator, sizeof(FosterAllocationHeader) + size);
+	if (header == NULL)
+		return NULL;
+
+	header->info.memory = memory;
+	header->info.size = size;
+	header->info.category = category;
+	FosterMemoryTrackAllocation(memory, category, (ma_int64)size);
+	return header + 1;
+}
+
+void* FosterRealloc(FosterMemory* memory, void* ptr, size_t size, FosterMemoryCategory category)
+{
+	if (ptr == NULL)
+		return FosterMalloc(memory, size, category);
+
+	if (size == 0)
+	{
+		FosterFree(ptr);
+		return NULL;
+	}
+
+	// reallocations stay with the owner and category of the original allocation
+	FosterAllocationHeader* header = (FosterAllocationHeader*)ptr - 1;
+	FosterMemory* owner = header->info.memory;
+	size_t oldSize = header->info.size;
+	FosterMemoryCategory oldCategory = header->info.category;
+
+	header = FosterRawRealloc(&owner->allocator, header, sizeof(FosterAllocationHeader) + oldSize, sizeof(FosterAllocationHeader) + size);
+	if (header == NULL)
+		return NULL;
+
+	header->info.size = size;
+	FosterMemoryTrackAllocation(owner, oldCategory, -(ma_int64)oldSize);
+	FosterMemoryTrackAllocation(owner, oldCategory, (ma_int64)size);
+	return header + 1;
+}
+
+void FosterFree(void* ptr)
+{
+	if (ptr == NULL)
+		return;
+
+	FosterAllocationHeader* header = (FosterAllocationHeader*)ptr - 1;
+	FosterMemory* owner = header->info.memory;
+	FosterMemoryTrackAllocation(owner, header->info.category, -(ma_int64)header->info.size);
+	FosterRawFree(&owner->allocator, header);
+}
+
+static FosterMemoryCategory FosterMemoryCategoryFromContext(const FosterAllocationContext* context)
+{
+	return context->category == FOSTER_MEMORY_CATEGORY_THREAD ? fosterThreadCategory : context->category;
+}
+
+static void* FosterMaMalloc(size_t size, void* userData)
+{
+	FosterAllocationContext* context = (FosterAllocationContext*)userData;
+	return FosterMalloc(context->memory, size, FosterMemoryCategoryFromContext(context));
+}
+
+static void* FosterMaRealloc(void* ptr, size_t size, void* userData)
+{
+	FosterAllocationContext* context = (FosterAllocationContext*)userData;
+	return FosterRealloc(context->memory, ptr, size, FosterMemoryCategoryFromContext(context));
+}
+
+static void FosterMaFree(void* ptr, void* userData)
+{
+	(void)userData;
+	FosterFree(ptr);
+}
+
+static ma_allocation_callbacks FosterAllocationCallbacks(FosterMemory* memory, FosterMemoryCategory category)
+{
+	ma_allocation_callbacks callbacks;
+	callbacks.pUserData = &memory->contexts[category];
+	callbacks.onMalloc = FosterMaMalloc;
+	callbacks.onRealloc = FosterMaRealloc;
+	callbacks.onFree = FosterMaFree;
+	return callbacks;
+}
+
+static FosterBool FosterArenaInit(FosterMemory* memory, size_t capacity)
+{
+	FosterArena* arena = &memory->arena;
+	arena->memory = capacity > 0 ? FosterMalloc(memory, capacity, FOSTER_MEMORY_CATEGORY_OTHER) : NULL;
+	arena->capacity = arena->memory != NULL ? capacity : 0;
+	arena->used = 0;
+	return capacity == 0 || arena->memory != NULL;
+}
+
+// the arena is accounted as OTHER, pushes move their share to the requested category
+static void* FosterArenaPush(FosterMemory* memory, size_t size, FosterMemoryCategory category)
+{
+	FosterArena* arena = &memory->arena;
+	size = FosterAlign(size);
+	if (size == 0 || arena->used + size > arena->capacity)
+		return NULL;
+
+	void* result = arena->memory + arena->used;
+	arena->used += size;
+	FosterMemoryTrack(memory, FOSTER_MEMORY_CATEGORY_OTHER, -(ma_int64)size);
+	FosterMemoryTrack(memory, category, (ma_int64)size);
+	return result;
+}
+
+static void FosterPoolInit(FosterPool* pool, FosterMemory* owner, void* memory, size_t blockSize, ma_uint32 capacity, FosterMemoryCategory category)
+{
+	pool->owner = owner;
+	pool->memory = memory;
+	pool->blockSize = FosterAlign(blockSize);
+	pool->capacity = memory != NULL ? capacity : 0;
+	pool->freeList = NULL;
+	pool->lock = 0;
+	pool->category = category;
+
+	for (ma_uint32 i = pool->capacity; i > 0; i--)
+	{
+		void** block = (void**)(pool->memory + (i - 1) * pool->blockSize);
+		*block = pool->freeList;
+		pool->freeList = block;
+	}
+}
+
+static void* FosterPoolAlloc(FosterPool* pool, size_t size)
+{
+	void* block = NULL;
+
+	if (size <= pool->blockSize)
+	{
+		ma_spinlock_lock(&pool->lock);
+		block = pool->freeList;
+		if (block != NULL)
+			pool->freeList = *(void**)block;
+		ma_spinlock_unlock(&pool->lock);
+	}
+
+	return block != NULL ? block : FosterMalloc(pool->owner, size, pool->category);
+}
+
+static void FosterPoolFree(FosterPool* pool, void* ptr)
+{
+	unsigned char* block = ptr;
+
+	if (block >= pool->memory && block < pool->memory + pool->blockSize * pool->capacity)
+	{
+		ma_spinlock_lock(&pool->lock);
+		*(void**)block = pool->freeList;
+		pool->freeList = block;
+		ma_spinlock_unlock(&pool->lock);
+		return;
+	}
+
+	FosterFree(ptr);
+}
+
+// carves the voice and decoder pools out of a single arena allocation
+static FosterBool FosterMemoryInitPools(FosterMemory* memory, int voiceCapacity, int decoderCapacity)
+{
+	size_t voiceBlockSize = FosterAlign(sizeof(FosterSound));
+	size_t decoderBlockSize = FosterAlign(sizeof(ma_libvorbis) > sizeof(ma_qoa) ? sizeof(ma_libvorbis) : sizeof(ma_qoa));
+	ma_uint32 voices = voiceCapacity > 0 ? (ma_uint32)voiceCapacity : 0;
+	ma_uint32 decoders = decoderCapacity > 0 ? (ma_uint32)decoderCapacity : 0;
+
+	if (!FosterArenaInit(memory, voiceBlockSize * voices + decoderBlockSize * decoders))
+		return false;
+
+	FosterPoolInit(&memory->voicePool, memory,
+		FosterArenaPush(memory, voiceBlockSize * voices, FOSTER_MEMORY_CATEGORY_VOICES),
+		voiceBlockSize, voices, FOSTER_MEMORY_CATEGORY_VOICES);
+	FosterPoolInit(&memory->decoderPool, memory,
+		FosterArenaPush(memory, decoderBlockSize * decoders, FOSTER_MEMORY_CATEGORY_ENCODED),
+		decoderBlockSize, decoders, FOSTER_MEMORY_CATEGORY_ENCODED);
+	return true;
+}
+
+static void FosterMemoryFreePools(FosterMemory* memory)
+{
+	// hand the pools' shares back to OTHER so the arena's single free balances out
+	size_t voiceBytes = memory->voicePool.blockSize * memory->voicePool.capacity;
+	size_t decoderBytes = memory->decoderPool.blockSize * memory->decoderPool.capacity;
+	FosterMemoryTrack(memory, FOSTER_MEMORY_CATEGORY_VOICES, -(ma_int64)voiceBytes);
+	FosterMemoryTrack(memory, FOSTER_MEMORY_CATEGORY_ENCODED, -(ma_int64)decoderBytes);
+	FosterMemoryTrack(memory, FOSTER_MEMORY_CATEGORY_OTHER, (ma_int64)(voiceBytes + decoderBytes));
+
+	FosterFree(memory->arena.memory);
+	memory->arena.memory = NULL;
+	memory->arena.capacity = 0;
+	memory->arena.used = 0;
+	FosterPoolInit(&memory->voicePool, memory, NULL, 0, 0, FOSTER_MEMORY_CATEGORY_VOICES);
+	FosterPoolInit(&memory->decoderPool, memory, NULL, 0, 0, FOSTER_MEMORY_CATEGORY_ENCODED);
+}
+
+// caller-owned data is added to its category, owned data is already accounted by its allocation
+static FosterRegisteredData* FosterRegistryAdd(FosterMemory* memory, const char* name, const void* registered, size_t size, FosterMemoryCategory category, void* owned)
+{
+	size_t nameLength = strlen(name);
+	FosterRegisteredData* data = FosterMalloc(memory, sizeof(FosterRegisteredData) + nameLength + 1, FOSTER_MEMORY_CATEGORY_OTHER);
+	if (data == NULL)
+		return NULL;
+
+	data->category = category;
+	data->data = registered;
+	data->size = size;
+	data->owned = owned;
+	data->engine = NULL;
+	data->node = NULL;
+	data->serial = 0;
+	MA_COPY_MEMORY(data->name, name, nameLength + 1);
+	if (owned == NULL)
+		FosterMemoryTrack(memory, category, (ma_int64)size);
+
+	ma_spinlock_lock(&memory->registryLock);
+	data->next = memory->registry;
+	memory->registry = data;
+	ma_spinlock_unlock(&memory->registryLock);
+	return data;
+}
+
+static void FosterRegistryRelease(FosterMemory* memory, FosterRegisteredData* data)
+{
+	if (data->owned != NULL)
+		FosterFree(data->owned);
+	else
+		FosterMemoryTrack(memory, data->category, -(ma_int64)data->size);
+	FosterFree(data);
+}
+
+// detaches the most recent registration of name, the caller releases it
+static FosterRegisteredData* FosterRegistryTake(FosterMemory* memory, const char* name)
+{
+	FosterRegisteredData* data = NULL;
+
+	ma_spinlock_lock(&memory->registryLock);
+	for (FosterRegisteredData** link = &memory->registry; *link != NULL; link = &(*link)->next)
+	{
+		if (strcmp((*link)->name, name) == 0)
+		{
+			data = *link;
+			*link = data->next;
+			break;
+		}
+	}
+	ma_spinlock_unlock(&memory->registryLock);
+	return data;
+}
+
+// finds a registration by its serial, NULL once it was unregistered
+static FosterRegisteredData* FosterRegistryFind(FosterMemory* memory, ma_uint64 serial)
+{
+	ma_spinlock_lock(&memory->registryLock);
+	FosterRegisteredData* data = memory->registry;
+	while (data != NULL && data->serial != serial)
+		data = data->next;
+	ma_spinlock_unlock(&memory->registryLock);
+	return data;
+}
+
+static void FosterRegistryClear(FosterMemory* memory)
+{
+	ma_spinlock_lock(&memory->registryLock);
+	FosterRegisteredData* data = memory->registry;
+	memory->registry = NULL;
+	ma_spinlock_unlock(&memory->registryLock);
+
+	while (data != NULL)
+	{
+		FosterRegisteredData* next = data->next;
+		FosterRegistryRelease(memory, data);
+		data = next;
+	}
+}
+
+// end Memory
+
+// begin FinishedQueue
+
+static void FosterFinishedQueueInit(FosterFinishedQueue* queue)
+{
+	for (ma_uint32 i = 0; i < FOSTER_FINISHED_QUEUE_CAPACITY; i++)
+	{
+		queue->slots[i].sequence = i;
+		queue->slots[i].sound = NULL;
+	}
+	queue->writeIndex = 0;
+	queue->readIndex = 0;
+	queue->overflowed = 0;
+}
+
+// called from the audio thread(s), never blocks
+static void FosterFinishedQueuePush(FosterFinishedQueue* queue, FosterSound* sound)
+{
+	ma_uint32 position = ma_atomic_load_32(&queue->writeIndex);
+
+	for (;;)
+	{
+		FosterFinishedSlot* slot = &queue->slots[position % FOSTER_FINISHED_QUEUE_CAPACITY];
+		ma_uint32 sequence = ma_atomic_load_32(&slot->sequence);
+		ma_int32 difference = (ma_int32)(sequence - position);
+
+		if (difference == 0)
+		{
+			if (ma_atomic_compare_exchange_weak_32(&queue->writeIndex, &position, position + 1))
+			{
+				slot->sound = sound;
+				ma_atomic_store_32(&slot->sequence, position + 1);
+				return;
+			}
+		}
+		else if (difference < 0)
+		{
+			// full, the consumer will have to fall back to polling every sound
+			ma_atomic_store_32(&queue->overflowed, 1);
+			return;
+		}
+		else
+		{
+			position = ma_atomic_load_32(&queue->writeIndex);
+		}
+	}
+}
+
+// called from the game thread only
+static FosterBool FosterFinishedQueuePop(FosterFinishedQueue* queue, FosterSound** sound)
+{
+	ma_uint32 position = queue->readIndex;
+	FosterFinishedSlot* slot = &queue->slots[position % FOSTER_FINISHED_QUEUE_CAPACITY];
+	ma_uint32 sequence = ma_atomic_load_32(&slot->sequence);
+
+	if ((ma_int32)(sequence - (position + 1)) < 0)
+		return false;
+
+	*sound = slot->sound;
+	ma_atomic_store_32(&slot->sequence, position + FOSTER_FINISHED_QUEUE_CAPACITY);
+	queue->readIndex = position + 1;
+	return true;
+}
+
+// end FinishedQueue
+
 // begin Vorbis
 
 static ma_result ma_decoding_backend_init__libvorbis(void* pUserData, ma_read_proc onRead, ma_seek_proc onSeek, ma_tell_proc onTell, void* pReadSeekTellUserData, const ma_decoding_backend_config* pConfig, const ma_allocation_callbacks* pAllocationCallbacks, ma_data_source** ppBackend)
 {
     ma_result result;
     ma_libvorbis* pVorbis;
+    FosterPool* pPool = &((FosterMemory*)pUserData)->decoderPool;
 
-    (void)pUserData;
-
-    pVorbis = (ma_libvorbis*)ma_malloc(sizeof(*pVorbis), pAllocationCallbacks);
+    pVorbis = (ma_libvorbis*)FosterPoolAlloc(pPool, sizeof(*pVorbis));
     if (pVorbis == NULL) {
         return MA_OUT_OF_MEMORY;
     }
 
     result = ma_libvorbis_init(onRead, onSeek, onTell, pReadSeekTellUserData, pConfig, pAllocationCallbacks, pVorbis);
     if (result != MA_SUCCESS) {
-        ma_free(pVorbis, pAllocationCallbacks);
+        FosterPoolFree(pPool, pVorbis);
         return result;
     }
 
@@ -70,17 +521,16 @@ static ma_result ma_decoding_backend_init_file__libvorbis(void* pUserData, const
 {
     ma_result result;
     ma_libvorbis* pVorbis;
+    FosterPool* pPool = &((FosterMemory*)pUserData)->decoderPool;
 
-    (void)pUserData;
-
-    pVorbis = (ma_libvorbis*)ma_malloc(sizeof(*pVorbis), pAllocationCallbacks);
+    pVorbis = (ma_libvorbis*)FosterPoolAlloc(pPool, sizeof(*pVorbis));
     if (pVorbis == NULL) {
         return MA_OUT_OF_MEMORY;
     }
 
     result = ma_libvorbis_init_file(pFilePath, pConfig, pAllocationCallbacks, pVorbis);
     if (result != MA_SUCCESS) {
-        ma_free(pVorbis, pAllocationCallbacks);
+        FosterPoolFree(pPool, pVorbis);
         return result;
     }
 
@@ -92,11 +542,10 @@ static ma_result ma_decoding_backend_init_file__libvorbis(void* pUserData, const
 static void ma_decoding_backend_uninit__libvorbis(void* pUserData, ma_data_source* pBackend, const ma_allocation_callbacks* pAllocationCallbacks)
 {
     ma_libvorbis* pVorbis = (ma_libvorbis*)pBackend;
-
-    (void)pUserData;
+    FosterPool* pPool = &((FosterMemory*)pUserData)->decoderPool;
 
     ma_libvorbis_uninit(pVorbis, pAllocationCallbacks);
-    ma_free(pVorbis, pAllocationCallbacks);
+    FosterPoolFree(pPool, pVorbis);
 }
 
 static ma_result ma_decoding_backend_get_channel_map__libvorbis(void* pUserData, ma_data_source* pBackend, ma_channel* pChannelMap, size_t channelMapCap)
@@ -125,17 +574,16 @@ static ma_result ma_decoding_backend_init__qoa(void* pUserData, ma_read_proc onR
 {
 	ma_result result;
 	ma_qoa* pQoa;
+	FosterPool* pPool = &((FosterMemory*)pUserData)->decoderPool;
 
-	(void)pUserData;
-
-	pQoa = (ma_qoa*)ma_malloc(sizeof(*pQoa), pAllocationCallbacks);
+	pQoa = (ma_qoa*)FosterPoolAlloc(pPool, sizeof(*pQoa));
 	if (pQoa == NULL) {
 		return MA_OUT_OF_MEMORY;
 	}
 
 	result = ma_qoa_init(onRead, onSeek, onTell, pReadSeekTellUserData, pConfig, pAllocationCallbacks, pQoa);
 	if (result != MA_SUCCESS) {
-		ma_free(pQoa, pAllocationCallbacks);
+		FosterPoolFree(pPool, pQoa);
 		return result;
 	}
 
@@ -147,11 +595,10 @@ static ma_result ma_decoding_backend_init__qoa(void* pUserData, ma_read_proc onR
 static void ma_decoding_backend_uninit__qoa(void* pUserData, ma_data_source* pBackend, const ma_allocation_callbacks* pAllocationCallbacks)
 {
 	ma_qoa* pQoa = (ma_qoa*)pBackend;
-
-	(void)pUserData;
+	FosterPool* pPool = &((FosterMemory*)pUserData)->decoderPool;
 
 	ma_qoa_uninit(pQoa, pAllocationCallbacks);
-	ma_free(pQoa, pAllocationCallbacks);
+	FosterPoolFree(pPool, pQoa);
 }
 
 static ma_result ma_decoding_backend_get_channel_map__qoa(void* pUserData, ma_data_source* pBackend, ma_channel* pChannelMap, size_t channelMapCap)
@@ -174,250 +621,4359 @@ static ma_decoding_backend_vtable g_ma_decoding_backend_vtable_qoa =
 
 // end QOA
 
-// begin Audio
-
-/*
-Add your custom backend vtables here. The order in the array defines the order of priority. The
-vtables will be passed in to the resource manager config.
-*/
-static ma_decoding_backend_vtable* pCustomBackendVTables[] =
-{
-	&g_ma_decoding_backend_vtable_qoa,
-	&g_ma_decoding_backend_vtable_libvorbis,
-};
+// begin Mixer
 
-void FosterAudioStartup(FosterDesc desc)
+// reads the group in the same chunk sizes the endpoint would, so the output matches mixing it on the audio thread
+static void FosterMixBranchRender(FosterMixer* mixer, FosterMixBranch* branch)
 {
-	fstate.desc = desc;
-	fstate.running = false;
+	ma_uint32 channels = mixer->channels;
+	ma_uint32 chunkFrames = (MA_DATA_CONVERTER_STACK_BUFFER_SIZE / sizeof(float)) / channels;
+	ma_uint32 framesProcessed = 0;
 
-	fstate.audioEngine = ma_malloc(sizeof(ma_engine), NULL);
+	// captures swap the source between blocks, never within one
+	ma_node* source = ma_atomic_load_ptr(&branch->source);
 
-	ma_resource_manager_config resourceManagerConfig;
-	ma_resource_manager* resourceManager = ma_malloc(sizeof(ma_resource_manager), NULL);
-	ma_engine_config engineConfig;
+	while (framesProcessed < mixer->roundFrames)
+	{
+		ma_uint32 framesToRead = mixer->roundFrames - framesProcessed;
+		ma_uint32 framesRead = 0;
+		if (framesToRead > chunkFrames)
+			framesToRead = chunkFrames;
 
-	/* Using custom decoding backends requires a resource manager. */
-	resourceManagerConfig = ma_resource_manager_config_init();
-	resourceManagerConfig.ppCustomDecodingBackendVTables = pCustomBackendVTables;
-	resourceManagerConfig.customDecodingBackendCount = sizeof(pCustomBackendVTables) / sizeof(pCustomBackendVTables[0]);
-	resourceManagerConfig.pCustomDecodingBackendUserData = NULL;  /* <-- This will be passed in to the pUserData parameter of each function in the decoding backend vtables. */
+		ma_result result = ma_node_read_pcm_frames(source, 0, branch->frames + framesProcessed * channels, framesToRead, &framesRead, mixer->roundTime + framesProcessed);
+		framesProcessed += framesRead;
 
-	if (MA_SUCCESS != ma_resource_manager_init(&resourceManagerConfig, resourceManager)) {
-		FosterLogError("Unable to create Audio Engine (Resource Manager)");
-		ma_free(fstate.audioEngine, NULL);
-		ma_free(resourceManager, NULL);
-		return;
+		if (result != MA_SUCCESS || framesRead == 0)
+			break;
 	}
 
-	/* Once we have a resource manager we can create the engine. */
-	engineConfig = ma_engine_config_init();
-	engineConfig.pResourceManager = resourceManager;
+	if (framesProcessed < mixer->roundFrames)
+		ma_silence_pcm_frames(branch->frames + framesProcessed * channels, mixer->roundFrames - framesProcessed, ma_format_f32, channels);
 
-	if (MA_SUCCESS != ma_engine_init(&engineConfig, fstate.audioEngine))
-	{
-		FosterLogError("Unable to create Audio Engine");
-		ma_free(fstate.audioEngine, NULL);
-		ma_free(resourceManager, NULL);
-		return;
-	}
+	branch->frameCount = mixer->roundFrames;
+	branch->cursor = 0;
+}
 
-	fstate.running = true;
+// counts down a rendered branch or a worker checking in, the last one wakes the audio thread
+static void FosterMixerFinish(FosterMixer* mixer)
+{
+	if (ma_atomic_fetch_sub_32(&mixer->remaining, 1) == 1)
+		ma_semaphore_release(&mixer->done);
 }
 
-void FosterAudioShutdown()
+static void FosterMixerWork(FosterMixer* mixer)
 {
-	if (!fstate.running)
-		return;
+	FosterMixBranchList* round = mixer->round;
 
-	ma_engine_uninit(fstate.audioEngine);
-	ma_free(fstate.audioEngine, NULL);
+	for (;;)
+	{
+		ma_uint32 index = ma_atomic_fetch_add_32(&mixer->nextBranch, 1);
+		if (index >= round->count)
+			break;
 
-	fstate.running = false;
+		FosterMixBranchRender(mixer, round->branches[index]);
+		FosterMixerFinish(mixer);
+	}
 }
 
-float FosterAudioGetVolume()
+static ma_thread_result MA_THREADCALL FosterMixerThread(void* userData)
 {
-	return ma_engine_get_volume(fstate.audioEngine);
+	FosterMixer* mixer = (FosterMixer*)userData;
+
+	for (;;)
+	{
+		ma_semaphore_wait(&mixer->wake);
+		if (ma_atomic_load_32(&mixer->quit))
+			break;
+
+		FosterMixerWork(mixer);
+		FosterMixerFinish(mixer);
+	}
+
+	return (ma_thread_result)0;
 }
 
-void FosterAudioSetVolume(int index, float value)
+// plays back the frames rendered for the group during the current block
+static void FosterMixBranchProcess(ma_node* node, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut)
 {
-	ma_engine_set_volume(fstate.audioEngine, value);
+	(void)ppFramesIn;
+	(void)pFrameCountIn;
+	FosterMixBranch* branch = (FosterMixBranch*)node;
+	ma_uint32 channels = ma_node_get_output_channels(node, 0);
+	ma_uint32 frameCount = *pFrameCountOut;
+	ma_uint32 available = branch->frameCount - branch->cursor;
+	ma_uint32 count = frameCount < available ? frameCount : available;
+
+	MA_COPY_MEMORY(ppFramesOut[0], branch->frames + branch->cursor * channels, count * channels * sizeof(float));
+	if (count < frameCount)
+		ma_silence_pcm_frames(ppFramesOut[0] + count * channels, frameCount - count, ma_format_f32, channels);
+
+	branch->cursor += count;
 }
 
-int FosterAudioGetChannels()
+static ma_node_vtable FosterMixBranchVTable =
 {
-	return ma_engine_get_channels(fstate.audioEngine);
-}
+	FosterMixBranchProcess,
+	NULL, /* onGetRequiredInputFrameCount() */
+	0,    /* input buses */
+	1,    /* output buses */
+	0
+};
 
-int FosterAudioGetSampleRate()
+static FosterBool FosterMixerInit(FosterAudioEngine* engine, int threadCount)
 {
-	return ma_engine_get_sample_rate(fstate.audioEngine);
+	FosterMixer* mixer = &engine->mixer;
+	ma_allocation_callbacks callbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_DSP);
+
+	mixer->threadCount = 0;
+	if (threadCount <= 0)
+		return true;
+	if (threadCount > FOSTER_MIXER_MAX_THREADS)
+		threadCount = FOSTER_MIXER_MAX_THREADS;
+
+	// blocks are a multiple of the endpoint's read chunk so chunk boundaries line up with serial mixing
+	mixer->channels = ma_engine_get_channels(&engine->engine);
+	mixer->blockFrames = 4 * ((MA_DATA_CONVERTER_STACK_BUFFER_SIZE / sizeof(float)) / mixer->channels);
+
+	if (MA_SUCCESS != ma_semaphore_init(0, &mixer->wake))
+	{
+		FosterLogError("Unable to create Audio Mixer");
+		return false;
+	}
+
+	if (MA_SUCCESS != ma_semaphore_init(0, &mixer->done))
+	{
+		FosterLogError("Unable to create Audio Mixer");
+		ma_semaphore_uninit(&mixer->wake);
+		return false;
+	}
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		if (MA_SUCCESS != ma_thread_create(&mixer->threads[i], ma_thread_priority_highest, 0, FosterMixerThread, mixer, &callbacks))
+		{
+			FosterLogWarn("Unable to create Audio Mixer thread, using %i", i);
+			break;
+		}
+		mixer->threadCount++;
+	}
+
+	if (mixer->threadCount == 0)
+	{
+		ma_semaphore_uninit(&mixer->wake);
+		ma_semaphore_uninit(&mixer->done);
+	}
+
+	return true;
 }
 
-uint64_t FosterAudioGetTimePcmFrames()
+// waits for the round the audio thread may be in to end, whatever it was reading is unused afterwards
+// returns as soon as no round is running, so a mixer that stopped rendering never blocks
+static void FosterMixerSync(FosterMixer* mixer)
 {
-	return ma_engine_get_time_in_pcm_frames(fstate.audioEngine);
+	ma_uint32 epoch = ma_atomic_load_32(&mixer->epoch);
+	while (ma_atomic_load_32(&mixer->rendering) && ma_atomic_load_32(&mixer->epoch) == epoch)
+		ma_yield();
 }
 
-void FosterAudioSetTimePcmFrames(int index, uint64_t value)
+// expects lock to be held, frees retired lists the audio thread has moved past
+static void FosterMixerReclaim(FosterMixer* mixer)
 {
-	ma_engine_set_time_in_pcm_frames(fstate.audioEngine, value);
+	ma_uint32 epoch = ma_atomic_load_32(&mixer->epoch);
+	FosterMixBranchList** link = &mixer->retired;
+	while (*link != NULL)
+	{
+		FosterMixBranchList* list = *link;
+		if (list->retiredEpoch != epoch)
+		{
+			*link = list->next;
+			FosterFree(list);
+		}
+		else
+			link = &list->next;
+	}
 }
 
-int FosterAudioGetListenerCount()
+// expects lock to be held, publishes a new branch list and retires the old one until the current round is over
+static void FosterMixerPublish(FosterMixer* mixer, FosterMixBranchList* list)
 {
-	return ma_engine_get_listener_count(fstate.audioEngine);
+	FosterMixBranchList* old = ma_atomic_exchange_ptr(&mixer->branches, list);
+	if (old == NULL)
+		return;
+
+	// read after publishing, a round that starts later already sees the new list
+	if (!ma_atomic_load_32(&mixer->rendering))
+	{
+		FosterFree(old);
+		return;
+	}
+
+	old->retiredEpoch = ma_atomic_load_32(&mixer->epoch);
+	old->next = mixer->retired;
+	mixer->retired = old;
 }
 
-void *FosterAudioDecode(void *data, int length, FosterAudioFormat *format, int *channels, int *sampleRate, uint64_t *decodedFrameCount)
+static void FosterMixerShutdown(FosterAudioEngine* engine)
 {
-	void *frames = NULL;
-	ma_decoder_config config = ma_decoder_config_init(*format, *channels, *sampleRate);
-	config.pCustomBackendUserData = NULL;  /* In this example our backend objects are contained within a ma_decoder_ex object to avoid a malloc. Our vtables need to know about this. */
-	config.ppCustomBackendVTables = pCustomBackendVTables;
-	config.customBackendCount = sizeof(pCustomBackendVTables) / sizeof(pCustomBackendVTables[0]);
+	FosterMixer* mixer = &engine->mixer;
+	if (mixer->threadCount == 0)
+		return;
 
-	ma_decode_memory(data, length, &config, decodedFrameCount, &frames);
-	*format = config.format;
-	*channels = config.channels;
-	*sampleRate = config.sampleRate;
-	return frames;
+	ma_atomic_exchange_32(&mixer->quit, 1);
+	for (ma_uint32 i = 0; i < mixer->threadCount; i++)
+		ma_semaphore_release(&mixer->wake);
+	for (ma_uint32 i = 0; i < mixer->threadCount; i++)
+		ma_thread_wait(&mixer->threads[i]);
+	ma_semaphore_uninit(&mixer->wake);
+	ma_semaphore_uninit(&mixer->done);
+
+	while (mixer->retired != NULL)
+	{
+		FosterMixBranchList* next = mixer->retired->next;
+		FosterFree(mixer->retired);
+		mixer->retired = next;
+	}
+
+	FosterFree(mixer->branches);
+	mixer->branches = NULL;
+	mixer->threadCount = 0;
 }
 
-void *FosterAudioEncodeWAV(void* data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate)
+// copies the branch list without skip and with room for one more, NULL when out of memory
+static FosterMixBranchList* FosterMixerCopyBranches(FosterAudioEngine* engine, FosterMixBranch* skip)
 {
-	return NULL; // TODO
-}
+	FosterMixBranchList* old = engine->mixer.branches;
+	ma_uint32 count = old != NULL ? old->count : 0;
+
+	FosterMixBranchList* list = FosterMalloc(&engine->memory, sizeof(FosterMixBranchList) + (count + 1) * sizeof(FosterMixBranch*), FOSTER_MEMORY_CATEGORY_DSP);
+	if (list == NULL)
+		return NULL;
+
+	list->next = NULL;
+	list->retiredEpoch = 0;
+	list->count = 0;
+	for (ma_uint32 i = 0; i < count; i++)
+	{
+		if (old->branches[i] != skip)
+			list->branches[list->count++] = old->branches[i];
+	}
+	return list;
+}
+
+// takes over mixing of a top-level group, which must not be attached to anything
+static FosterBool FosterMixerAddGroup(FosterAudioEngine* engine, FosterSoundGroup* soundGroup)
+{
+	FosterMixer* mixer = &engine->mixer;
+	ma_allocation_callbacks callbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_DSP);
+
+	FosterMixBranch* branch = FosterMalloc(&engine->memory, sizeof(FosterMixBranch), FOSTER_MEMORY_CATEGORY_DSP);
+	float* frames = FosterMalloc(&engine->memory, mixer->blockFrames * mixer->channels * sizeof(float), FOSTER_MEMORY_CATEGORY_DSP);
+	if (branch == NULL || frames == NULL)
+	{
+		FosterFree(branch);
+		FosterFree(frames);
+		return false;
+	}
+
+	ma_node_config config = ma_node_config_init();
+	config.vtable = &FosterMixBranchVTable;
+	config.pOutputChannels = &mixer->channels;
+
+	if (MA_SUCCESS != ma_node_init(ma_engine_get_node_graph(&engine->engine), &config, &callbacks, &branch->node))
+	{
+		FosterFree(branch);
+		FosterFree(frames);
+		return false;
+	}
+
+	branch->group = soundGroup;
+	branch->source = &soundGroup->group;
+	branch->frames = frames;
+	branch->frameCount = 0;
+	branch->cursor = 0;
+
+	// the audio thread never takes the lock, it only keeps changes from other threads apart
+	ma_spinlock_lock(&mixer->lock);
+	FosterMixerReclaim(mixer);
+	FosterMixBranchList* list = FosterMixerCopyBranches(engine, NULL);
+	if (list == NULL)
+	{
+		ma_spinlock_unlock(&mixer->lock);
+		ma_node_uninit(&branch->node, &callbacks);
+		FosterFree(branch);
+		FosterFree(frames);
+		return false;
+	}
+	list->branches[list->count++] = branch;
+	FosterMixerPublish(mixer, list);
+	ma_spinlock_unlock(&mixer->lock);
+
+	// the branch takes the group's place on the endpoint, so it's summed in the same order
+	ma_node_attach_output_bus(&branch->node, 0, ma_engine_get_endpoint(&engine->engine), 0);
+	soundGroup->branch = branch;
+	return true;
+}
+
+static void FosterMixerRemoveGroup(FosterAudioEngine* engine, FosterSoundGroup* soundGroup)
+{
+	FosterMixer* mixer = &engine->mixer;
+	FosterMixBranch* branch = soundGroup->branch;
+	if (branch == NULL)
+		return;
+
+	ma_allocation_callbacks callbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_DSP);
+	ma_node_uninit(&branch->node, &callbacks);
+
+	// keeps the order of the remaining branches, which doesn't affect the output but keeps work distribution stable
+	ma_spinlock_lock(&mixer->lock);
+	FosterMixerReclaim(mixer);
+	FosterMixBranchList* list = FosterMixerCopyBranches(engine, branch);
+	if (list != NULL)
+		FosterMixerPublish(mixer, list);
+	else
+	{
+		// out of memory, take the list away from the audio thread for a round to edit it in place
+		FosterMixBranchList* current = ma_atomic_exchange_ptr(&mixer->branches, NULL);
+		FosterMixerSync(mixer);
+		for (ma_uint32 i = 0; i < current->count; i++)
+		{
+			if (current->branches[i] == branch)
+			{
+				MA_MOVE_MEMORY(&current->branches[i], &current->branches[i + 1], (current->count - i - 1) * sizeof(FosterMixBranch*));
+				current->count--;
+				break;
+			}
+		}
+		ma_atomic_exchange_ptr(&mixer->branches, current);
+	}
+	ma_spinlock_unlock(&mixer->lock);
+
+	// the group goes away right after, so wait for a round boundary instead of freeing under the audio thread
+	FosterMixerSync(mixer);
+
+	FosterFree(branch->frames);
+	FosterFree(branch);
+	soundGroup->branch = NULL;
+}
+
+// renders the engine, forking top-level groups onto the mixer threads one block at a time
+// the branch list is read once per callback without locking, changes wait for the epoch to move on
+static void FosterMixerRead(FosterAudioEngine* engine, float* frames, ma_uint64 frameCount, ma_uint64* framesRead)
+{
+	FosterMixer* mixer = &engine->mixer;
+
+	if (mixer->threadCount == 0)
+	{
+		ma_engine_read_pcm_frames(&engine->engine, frames, frameCount, framesRead);
+		return;
+	}
+
+	ma_atomic_exchange_32(&mixer->rendering, 1);
+	FosterMixBranchList* branches = ma_atomic_load_ptr(&mixer->branches);
+
+	ma_uint64 totalFramesRead = 0;
+	while (totalFramesRead < frameCount)
+	{
+		ma_uint64 blockFrames = frameCount - totalFramesRead;
+		ma_uint64 blockFramesRead = 0;
+		if (blockFrames > mixer->blockFrames)
+			blockFrames = mixer->blockFrames;
+
+		if (branches != NULL && branches->count > 0)
+		{
+			ma_uint32 wakeCount = branches->count - 1;
+			if (wakeCount > mixer->threadCount)
+				wakeCount = mixer->threadCount;
+
+			// fork
+			mixer->round = branches;
+			mixer->roundFrames = (ma_uint32)blockFrames;
+			mixer->roundTime = ma_node_get_time(ma_engine_get_endpoint(&engine->engine));
+			ma_atomic_exchange_32(&mixer->remaining, branches->count + wakeCount);
+			ma_atomic_exchange_32(&mixer->nextBranch, 0);
+			for (ma_uint32 i = 0; i < wakeCount; i++)
+				ma_semaphore_release(&mixer->wake);
+
+			FosterMixerWork(mixer);
+
+			// join, woken workers have to check in too so none of them can claim work from the next block
+			ma_semaphore_wait(&mixer->done);
+		}
+
+		ma_engine_read_pcm_frames(&engine->engine, frames + totalFramesRead * mixer->channels, blockFrames, &blockFramesRead);
+
+		totalFramesRead += blockFramesRead;
+		if (blockFramesRead == 0)
+			break;
+	}
+
+	ma_atomic_fetch_add_32(&mixer->epoch, 1);
+	ma_atomic_exchange_32(&mixer->rendering, 0);
+
+	if (framesRead != NULL)
+		*framesRead = totalFramesRead;
+}
+
+// end Mixer
+
+// begin Spatial
+
+#define FOSTER_SPATIAL_NONE 0xFFFFFFFF
+#define FOSTER_SPATIAL_LANE_COUNT 23
+
+// lanes are a cache line further apart than their size, at power of two capacities they would
+// otherwise all start on the same cache sets and evict each other while being filled
+static ma_uint32 FosterSpatialBatchStride(ma_uint32 capacity)
+{
+	return capacity + 16;
+}
+
+static size_t FosterSpatialBatchSize(ma_uint32 capacity, ma_uint32 channels)
+{
+	return (size_t)capacity * 2 * sizeof(FosterSound*) + (size_t)FosterSpatialBatchStride(capacity) * (FOSTER_SPATIAL_LANE_COUNT + channels) * sizeof(float);
+}
+
+// points every array of the batch into one block
+static void FosterSpatialBatchAssign(FosterSpatialBatch* batch, void* block, ma_uint32 capacity)
+{
+	float** lanes[FOSTER_SPATIAL_LANE_COUNT] = {
+		&batch->posX, &batch->posY, &batch->posZ,
+		&batch->dirX, &batch->dirY, &batch->dirZ,
+		&batch->velX, &batch->velY, &batch->velZ,
+		&batch->relative, &batch->model, &batch->minDistance, &batch->maxDistance, &batch->rolloff,
+		&batch->coneInner, &batch->coneOuter, &batch->coneGain, &batch->minGain, &batch->maxGain,
+		&batch->directional, &batch->minChannelGain, &batch->dopplerFactor, &batch->pitch,
+	};
+
+	batch->block = block;
+	batch->capacity = capacity;
+	batch->stride = FosterSpatialBatchStride(capacity);
+	batch->voices = (FosterSound**)block;
+	batch->active = batch->voices + capacity;
+
+	float* next = (float*)(batch->active + capacity);
+	for (int i = 0; i < FOSTER_SPATIAL_LANE_COUNT; i++, next += batch->stride)
+		*lanes[i] = next;
+	batch->channelGains = next;
+}
+
+static void FosterSpatialBatchAdd(FosterAudioEngine* engine, FosterSound* sound)
+{
+	FosterSpatialBatch* batch = &engine->spatial;
+	sound->spatialIndex = FOSTER_SPATIAL_NONE;
+	sound->spatialListener = FOSTER_SPATIAL_NONE;
+	sound->spatialCone[0] = sound->spatialCone[1] = -1;
+
+	if (!batch->enabled)
+		return;
+
+	// grow outside of the lock so the audio thread only ever waits for the copy
+	for (;;)
+	{
+		ma_spinlock_lock(&batch->lock);
+		if (batch->voiceCount < batch->capacity)
+			break;
+		ma_uint32 capacity = batch->capacity;
+		ma_spinlock_unlock(&batch->lock);
+
+		ma_uint32 newCapacity = capacity > 0 ? capacity * 2 : 64;
+		void* block = FosterMalloc(&engine->memory, FosterSpatialBatchSize(newCapacity, batch->channels), FOSTER_MEMORY_CATEGORY_VOICES);
+		if (block == NULL)
+		{
+			FosterLogWarn("Unable to batch the spatialization of a Sound (Out of Memory)");
+			return;
+		}
+
+		ma_spinlock_lock(&batch->lock);
+		if (batch->capacity == capacity)
+		{
+			void* old = batch->block;
+			if (batch->voiceCount > 0)
+				MA_COPY_MEMORY(block, batch->voices, batch->voiceCount * sizeof(FosterSound*));
+			FosterSpatialBatchAssign(batch, block, newCapacity);
+			block = old;
+		}
+		ma_spinlock_unlock(&batch->lock);
+		FosterFree(block);
+	}
+
+	sound->spatialIndex = batch->voiceCount;
+	batch->voices[batch->voiceCount++] = sound;
+	ma_spinlock_unlock(&batch->lock);
+}
+
+static void FosterSpatialBatchRemove(FosterAudioEngine* engine, FosterSound* sound)
+{
+	FosterSpatialBatch* batch = &engine->spatial;
+	if (sound->spatialIndex == FOSTER_SPATIAL_NONE)
+		return;
+
+	ma_spinlock_lock(&batch->lock);
+	FosterSound* last = batch->voices[--batch->voiceCount];
+	batch->voices[sound->spatialIndex] = last;
+	last->spatialIndex = sound->spatialIndex;
+	sound->sound.engineNode.spatializer.hasPrecomputedGains = MA_FALSE;
+	ma_spinlock_unlock(&batch->lock);
+
+	sound->spatialIndex = FOSTER_SPATIAL_NONE;
+}
+
+// the lookat transform ma_spatializer_get_relative_position_and_direction builds for every sound, built once
+static void FosterSpatialListenerUpdate(FosterSpatialListener* listener, const ma_spatializer_listener* source, ma_uint32 channels)
+{
+	ma_vec3f position = ma_spatializer_listener_get_position(source);
+	ma_vec3f axisZ = ma_vec3f_normalize(ma_spatializer_listener_get_direction(source));
+	ma_vec3f axisX = ma_vec3f_normalize(ma_vec3f_cross(axisZ, source->config.worldUp));
+	if (ma_vec3f_len2(axisX) == 0)
+		axisX = ma_vec3f_init_3f(1, 0, 0);
+	ma_vec3f axisY = ma_vec3f_cross(axisX, axisZ);
+	if (source->config.handedness == ma_handedness_left)
+		axisX = ma_vec3f_neg(axisX);
+
+	listener->transform[0][0] = axisX.x; listener->transform[0][1] = axisY.x; listener->transform[0][2] = -axisZ.x;
+	listener->transform[1][0] = axisX.y; listener->transform[1][1] = axisY.y; listener->transform[1][2] = -axisZ.y;
+	listener->transform[2][0] = axisX.z; listener->transform[2][1] = axisY.z; listener->transform[2][2] = -axisZ.z;
+	listener->transform[3][0] = -ma_vec3f_dot(axisX, position);
+	listener->transform[3][1] = -ma_vec3f_dot(axisY, position);
+	listener->transform[3][2] = -ma_vec3f_dot(ma_vec3f_neg(axisZ), position);
+
+	listener->position = position;
+	listener->velocity = ma_spatializer_listener_get_velocity(source);
+	listener->speedOfSound = source->config.speedOfSound;
+	listener->forward = source->config.handedness == ma_handedness_right ? -1.0f : 1.0f;
+
+	// a disabled cone compares every direction as inside the inner angle
+	if (source->config.coneInnerAngleInRadians < 6.283185f)
+	{
+		listener->coneInner = (float)ma_cosd(source->config.coneInnerAngleInRadians * 0.5f);
+		listener->coneOuter = (float)ma_cosd(source->config.coneOuterAngleInRadians * 0.5f);
+	}
+	else
+	{
+		listener->coneInner = -FLT_MAX;
+		listener->coneOuter = -FLT_MAX;
+	}
+	listener->coneGain = source->config.coneOuterGain;
+
+	for (ma_uint32 i = 0; i < channels; i++)
+	{
+		ma_channel channel = ma_channel_map_get_channel(source->config.pChannelMapOut, channels, i);
+		ma_vec3f direction = ma_get_channel_direction(channel);
+		listener->channelX[i] = direction.x;
+		listener->channelY[i] = direction.y;
+		listener->channelZ[i] = direction.z;
+		listener->channelSpatial[i] = ma_is_spatial_channel_position(channel) ? 1.0f : 0.0f;
+	}
+}
+
+// whether a voice is spatialized this callback and by which listener, anything left out spatializes itself as usual
+static ma_uint32 FosterSpatialBatchListener(FosterAudioEngine* engine, FosterSound* sound, ma_uint32 listenerCount)
+{
+	ma_engine_node* node = &sound->sound.engineNode;
+	node->spatializer.hasPrecomputedGains = MA_FALSE;
+
+	// voices asleep for being silent are included, their gains decide when they wake
+	if ((!ma_sound_is_playing(&sound->sound) && sound->idleState != FOSTER_IDLE_ASLEEP) ||
+		!ma_engine_node_is_spatialization_enabled(node) ||
+		node->spatializer.channelsOut != engine->spatial.channels ||
+		ma_spatializer_get_attenuation_model(&node->spatializer) == ma_attenuation_model_none)
+		return FOSTER_SPATIAL_NONE;
+
+	// same listener choice as the engine node
+	if (listenerCount == 1)
+		return 0;
+	if (node->pinnedListenerIndex != MA_LISTENER_INDEX_CLOSEST && node->pinnedListenerIndex < listenerCount)
+		return node->pinnedListenerIndex;
+
+	ma_vec3f position = ma_spatializer_get_position(&node->spatializer);
+	return ma_engine_find_closest_listener(&engine->engine, position.x, position.y, position.z);
+}
+
+static void FosterSpatialBatchLoad(FosterSpatialBatch* batch, FosterSound* sound, ma_uint32 k)
+{
+	ma_spatializer* spatializer = &sound->sound.engineNode.spatializer;
+	ma_vec3f position = ma_spatializer_get_position(spatializer);
+	ma_vec3f direction = ma_spatializer_get_direction(spatializer);
+	ma_vec3f velocity = ma_spatializer_get_velocity(spatializer);
+
+	batch->active[k] = sound;
+	batch->posX[k] = position.x;
+	batch->posY[k] = position.y;
+	batch->posZ[k] = position.z;
+	batch->dirX[k] = direction.x;
+	batch->dirY[k] = direction.y;
+	batch->dirZ[k] = direction.z;
+	batch->velX[k] = velocity.x;
+	batch->velY[k] = velocity.y;
+	batch->velZ[k] = velocity.z;
+	batch->relative[k] = ma_spatializer_get_positioning(spatializer) == ma_positioning_relative ? 1.0f : 0.0f;
+	batch->model[k] = (float)ma_spatializer_get_attenuation_model(spatializer);
+	batch->minDistance[k] = ma_spatializer_get_min_distance(spatializer);
+	batch->maxDistance[k] = ma_spatializer_get_max_distance(spatializer);
+	batch->rolloff[k] = ma_spatializer_get_rolloff(spatializer);
+	batch->minGain[k] = ma_spatializer_get_min_gain(spatializer);
+	batch->maxGain[k] = ma_spatializer_get_max_gain(spatializer);
+	batch->directional[k] = ma_spatializer_get_directional_attenuation_factor(spatializer);
+	batch->minChannelGain[k] = spatializer->minSpatializationChannelGain;
+	batch->dopplerFactor[k] = ma_spatializer_get_doppler_factor(spatializer);
+
+	// cone cosines only change when the cone does
+	float inner, outer;
+	ma_spatializer_get_cone(spatializer, &inner, &outer, &batch->coneGain[k]);
+	if (inner != sound->spatialCone[0] || outer != sound->spatialCone[1])
+	{
+		sound->spatialCone[0] = inner;
+		sound->spatialCone[1] = outer;
+		sound->spatialCone[2] = inner < 6.283185f ? (float)ma_cosd(inner * 0.5f) : -FLT_MAX;
+		sound->spatialCone[3] = inner < 6.283185f ? (float)ma_cosd(outer * 0.5f) : -FLT_MAX;
+	}
+	batch->coneInner[k] = sound->spatialCone[2];
+	batch->coneOuter[k] = sound->spatialCone[3];
+}
+
+// lays out the parameters of this callback's voices grouped by listener
+static void FosterSpatialBatchGather(FosterAudioEngine* engine)
+{
+	FosterSpatialBatch* batch = &engine->spatial;
+	ma_uint32 listenerCount = ma_engine_get_listener_count(&engine->engine);
+	ma_uint32 offsets[MA_ENGINE_MAX_LISTENERS] = { 0 };
+
+	// a single listener needs no grouping, so one pass over the voices
+	if (listenerCount == 1)
+	{
+		ma_uint32 count = 0;
+		for (ma_uint32 i = 0; i < batch->voiceCount; i++)
+		{
+			if (FosterSpatialBatchListener(engine, batch->voices[i], 1) == 0)
+				FosterSpatialBatchLoad(batch, batch->voices[i], count++);
+		}
+
+		batch->listenerBegin[0] = 0;
+		for (ma_uint32 i = 1; i <= MA_ENGINE_MAX_LISTENERS; i++)
+			batch->listenerBegin[i] = count;
+		if (count > 0)
+			FosterSpatialListenerUpdate(&batch->listeners[0], &engine->engine.listeners[0], batch->channels);
+		return;
+	}
+
+	for (ma_uint32 i = 0; i < batch->voiceCount; i++)
+	{
+		FosterSound* sound = batch->voices[i];
+		sound->spatialListener = FosterSpatialBatchListener(engine, sound, listenerCount);
+		if (sound->spatialListener != FOSTER_SPATIAL_NONE)
+			offsets[sound->spatialListener]++;
+	}
+
+	batch->listenerBegin[0] = 0;
+	for (ma_uint32 i = 0; i < MA_ENGINE_MAX_LISTENERS; i++)
+	{
+		ma_uint32 count = offsets[i];
+		offsets[i] = batch->listenerBegin[i];
+		batch->listenerBegin[i + 1] = batch->listenerBegin[i] + count;
+		if (count > 0)
+			FosterSpatialListenerUpdate(&batch->listeners[i], &engine->engine.listeners[i], batch->channels);
+	}
+
+	for (ma_uint32 i = 0; i < batch->voiceCount; i++)
+	{
+		FosterSound* sound = batch->voices[i];
+		if (sound->spatialListener != FOSTER_SPATIAL_NONE)
+			FosterSpatialBatchLoad(batch, sound, offsets[sound->spatialListener]++);
+	}
+}
+
+static float FosterSpatialConeGain(float d, float inner, float outer, float outerGain)
+{
+	if (d > inner)
+		return 1;
+	if (d > outer)
+		return ma_mix_f32(outerGain, 1, (d - outer) / (inner - outer));
+	return outerGain;
+}
+
+// the math of ma_spatializer_process_pcm_frames for voices [begin, end), which all use the same listener
+static void FosterSpatialKernelScalar(FosterSpatialBatch* batch, const FosterSpatialListener* listener, ma_uint32 begin, ma_uint32 end)
+{
+	const float (*m)[3] = listener->transform;
+
+	for (ma_uint32 i = begin; i < end; i++)
+	{
+		float px = batch->posX[i], py = batch->posY[i], pz = batch->posZ[i];
+		float dx = batch->dirX[i], dy = batch->dirY[i], dz = batch->dirZ[i];
+		float rx = px, ry = py, rz = pz;
+		float rdx = dx, rdy = dy, rdz = dz;
+
+		if (batch->relative[i] == 0)
+		{
+			rx = m[0][0] * px + m[1][0] * py + m[2][0] * pz + m[3][0];
+			ry = m[0][1] * px + m[1][1] * py + m[2][1] * pz + m[3][1];
+			rz = m[0][2] * px + m[1][2] * py + m[2][2] * pz + m[3][2];
+			rdx = m[0][0] * dx + m[1][0] * dy + m[2][0] * dz;
+			rdy = m[0][1] * dx + m[1][1] * dy + m[2][1] * dz;
+			rdz = m[0][2] * dx + m[1][2] * dy + m[2][2] * dz;
+		}
+
+		float distance = sqrtf(rx * rx + ry * ry + rz * rz);
+		float minDistance = batch->minDistance[i];
+		float maxDistance = batch->maxDistance[i];
+		float rolloff = batch->rolloff[i];
+		float gain = 1;
+
+		if (minDistance < maxDistance)
+		{
+			float clamped = ma_clamp(distance, minDistance, maxDistance);
+			switch ((int)batch->model[i])
+			{
+				case ma_attenuation_model_inverse: gain = minDistance / (minDistance + rolloff * (clamped - minDistance)); break;
+				case ma_attenuation_model_linear: gain = 1 - rolloff * (clamped - minDistance) / (maxDistance - minDistance); break;
+				case ma_attenuation_model_exponential: gain = (float)ma_powd(clamped / minDistance, -rolloff); break;
+				default: break;
+			}
+		}
+
+		float ux = 0, uy = 0, uz = 0;
+		ma_bool32 hasDistance = distance > 0.001f;
+		if (hasDistance)
+		{
+			float distanceInv = 1 / distance;
+			ux = rx * distanceInv;
+			uy = ry * distanceInv;
+			uz = rz * distanceInv;
+			gain *= FosterSpatialConeGain(rdx * -ux + rdy * -uy + rdz * -uz, batch->coneInner[i], batch->coneOuter[i], batch->coneGain[i]);
+			gain *= FosterSpatialConeGain(listener->forward * uz, listener->coneInner, listener->coneOuter, listener->coneGain);
+		}
+
+		gain = ma_clamp(gain, batch->minGain[i], batch->maxGain[i]);
+
+		for (ma_uint32 c = 0; c < batch->channels; c++)
+		{
+			float d = 1;
+			if (hasDistance)
+			{
+				if (listener->channelSpatial[c] != 0)
+					d = ma_mix_f32_fast(1, ux * listener->channelX[c] + uy * listener->channelY[c] + uz * listener->channelZ[c], batch->directional[i]);
+				d = (d + 1) * 0.5f;
+				d = ma_max(d, batch->minChannelGain[i]);
+			}
+			batch->channelGains[c * batch->stride + i] = gain * d;
+		}
+
+		// doppler works on world positions even for relative sounds, like the spatializer
+		float factor = batch->dopplerFactor[i];
+		float pitch = 1;
+		if (factor > 0)
+		{
+			float qx = listener->position.x - px, qy = listener->position.y - py, qz = listener->position.z - pz;
+			float length = sqrtf(qx * qx + qy * qy + qz * qz);
+			if (length != 0)
+			{
+				float speed = listener->speedOfSound;
+				float vls = (qx * listener->velocity.x + qy * listener->velocity.y + qz * listener->velocity.z) / length;
+				float vss = (qx * batch->velX[i] + qy * batch->velY[i] + qz * batch->velZ[i]) / length;
+				vls = ma_min(vls, speed / factor);
+				vss = ma_min(vss, speed / factor);
+				pitch = (speed - factor * vls) / (speed - factor * vss);
+			}
+		}
+		batch->pitch[i] = pitch;
+	}
+}
+
+#if defined(MA_SUPPORT_SSE2)
+
+static __m128 FosterSpatialSelect(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static __m128 FosterSpatialConeGainSse2(__m128 d, __m128 inner, __m128 outer, __m128 outerGain)
+{
+	__m128 one = _mm_set1_ps(1);
+	__m128 t = _mm_div_ps(_mm_sub_ps(d, outer), _mm_sub_ps(inner, outer));
+	__m128 mixed = _mm_add_ps(_mm_mul_ps(outerGain, _mm_sub_ps(one, t)), t);
+	return FosterSpatialSelect(_mm_cmpgt_ps(d, inner), one, FosterSpatialSelect(_mm_cmpgt_ps(d, outer), mixed, outerGain));
+}
+
+// four voices at a time with the same results as the scalar kernel, returns the first voice left for it
+static ma_uint32 FosterSpatialKernelSse2(FosterSpatialBatch* batch, const FosterSpatialListener* listener, ma_uint32 begin, ma_uint32 end)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	const __m128 threshold = _mm_set1_ps(0.001f);
+	const __m128 inverse = _mm_set1_ps((float)ma_attenuation_model_inverse);
+	const __m128 linear = _mm_set1_ps((float)ma_attenuation_model_linear);
+	const __m128 exponential = _mm_set1_ps((float)ma_attenuation_model_exponential);
+	const __m128 forward = _mm_set1_ps(listener->forward);
+	const __m128 listenerInner = _mm_set1_ps(listener->coneInner);
+	const __m128 listenerOuter = _mm_set1_ps(listener->coneOuter);
+	const __m128 listenerGain = _mm_set1_ps(listener->coneGain);
+	const __m128 lpx = _mm_set1_ps(listener->position.x), lpy = _mm_set1_ps(listener->position.y), lpz = _mm_set1_ps(listener->position.z);
+	const __m128 lvx = _mm_set1_ps(listener->velocity.x), lvy = _mm_set1_ps(listener->velocity.y), lvz = _mm_set1_ps(listener->velocity.z);
+	const __m128 speed = _mm_set1_ps(listener->speedOfSound);
+
+	__m128 m[4][3];
+	for (int j = 0; j < 4; j++)
+		for (int k = 0; k < 3; k++)
+			m[j][k] = _mm_set1_ps(listener->transform[j][k]);
+
+	ma_uint32 i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 model = _mm_loadu_ps(batch->model + i);
+
+		// there's no vector pow, the rare exponential voices go through the scalar kernel
+		if (_mm_movemask_ps(_mm_cmpeq_ps(model, exponential)) != 0)
+		{
+			FosterSpatialKernelScalar(batch, listener, i, i + 4);
+			continue;
+		}
+
+		__m128 px = _mm_loadu_ps(batch->posX + i), py = _mm_loadu_ps(batch->posY + i), pz = _mm_loadu_ps(batch->posZ + i);
+		__m128 dx = _mm_loadu_ps(batch->dirX + i), dy = _mm_loadu_ps(batch->dirY + i), dz = _mm_loadu_ps(batch->dirZ + i);
+		__m128 relative = _mm_cmpneq_ps(_mm_loadu_ps(batch->relative + i), zero);
+
+		__m128 rx = FosterSpatialSelect(relative, px, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][0], px), _mm_mul_ps(m[1][0], py)), _mm_mul_ps(m[2][0], pz)), m[3][0]));
+		__m128 ry = FosterSpatialSelect(relative, py, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][1], px), _mm_mul_ps(m[1][1], py)), _mm_mul_ps(m[2][1], pz)), m[3][1]));
+		__m128 rz = FosterSpatialSelect(relative, pz, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][2], px), _mm_mul_ps(m[1][2], py)), _mm_mul_ps(m[2][2], pz)), m[3][2]));
+		__m128 rdx = FosterSpatialSelect(relative, dx, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][0], dx), _mm_mul_ps(m[1][0], dy)), _mm_mul_ps(m[2][0], dz)));
+		__m128 rdy = FosterSpatialSelect(relative, dy, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][1], dx), _mm_mul_ps(m[1][1], dy)), _mm_mul_ps(m[2][1], dz)));
+		__m128 rdz = FosterSpatialSelect(relative, dz, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][2], dx), _mm_mul_ps(m[1][2], dy)), _mm_mul_ps(m[2][2], dz)));
+
+		__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_mul_ps(rz, rz)));
+		__m128 minDistance = _mm_loadu_ps(batch->minDistance + i);
+		__m128 maxDistance = _mm_loadu_ps(batch->maxDistance + i);
+		__m128 rolloff = _mm_loadu_ps(batch->rolloff + i);
+		__m128 falloff = _mm_mul_ps(rolloff, _mm_sub_ps(_mm_max_ps(minDistance, _mm_min_ps(distance, maxDistance)), minDistance));
+		__m128 gainInverse = _mm_div_ps(minDistance, _mm_add_ps(minDistance, falloff));
+		__m128 gainLinear = _mm_sub_ps(one, _mm_div_ps(falloff, _mm_sub_ps(maxDistance, minDistance)));
+		__m128 gain = FosterSpatialSelect(_mm_cmpeq_ps(model, inverse), gainInverse, FosterSpatialSelect(_mm_cmpeq_ps(model, linear), gainLinear, one));
+		gain = FosterSpatialSelect(_mm_cmplt_ps(minDistance, maxDistance), gain, one);
+
+		__m128 hasDistance = _mm_cmpgt_ps(distance, threshold);
+		__m128 distanceInv = _mm_div_ps(one, distance);
+		__m128 ux = _mm_and_ps(hasDistance, _mm_mul_ps(rx, distanceInv));
+		__m128 uy = _mm_and_ps(hasDistance, _mm_mul_ps(ry, distanceInv));
+		__m128 uz = _mm_and_ps(hasDistance, _mm_mul_ps(rz, distanceInv));
+
+		__m128 coneDot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rdx, _mm_xor_ps(ux, sign)), _mm_mul_ps(rdy, _mm_xor_ps(uy, sign))), _mm_mul_ps(rdz, _mm_xor_ps(uz, sign)));
+		__m128 coned = _mm_mul_ps(gain, FosterSpatialConeGainSse2(coneDot, _mm_loadu_ps(batch->coneInner + i), _mm_loadu_ps(batch->coneOuter + i), _mm_loadu_ps(batch->coneGain + i)));
+		coned = _mm_mul_ps(coned, FosterSpatialConeGainSse2(_mm_mul_ps(forward, uz), listenerInner, listenerOuter, listenerGain));
+		gain = FosterSpatialSelect(hasDistance, coned, gain);
+		gain = _mm_max_ps(_mm_loadu_ps(batch->minGain + i), _mm_min_ps(gain, _mm_loadu_ps(batch->maxGain + i)));
+
+		__m128 directional = _mm_loadu_ps(batch->directional + i);
+		__m128 minChannelGain = _mm_loadu_ps(batch->minChannelGain + i);
+		for (ma_uint32 c = 0; c < batch->channels; c++)
+		{
+			__m128 d = one;
+			if (listener->channelSpatial[c] != 0)
+			{
+				__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ux, _mm_set1_ps(listener->channelX[c])), _mm_mul_ps(uy, _mm_set1_ps(listener->channelY[c]))), _mm_mul_ps(uz, _mm_set1_ps(listener->channelZ[c])));
+				d = _mm_add_ps(one, _mm_mul_ps(_mm_sub_ps(dot, one), directional));
+			}
+			d = _mm_max_ps(_mm_mul_ps(_mm_add_ps(d, one), half), minChannelGain);
+			d = FosterSpatialSelect(hasDistance, d, one);
+			_mm_storeu_ps(batch->channelGains + c * batch->stride + i, _mm_mul_ps(gain, d));
+		}
+
+		__m128 factor = _mm_loadu_ps(batch->dopplerFactor + i);
+		__m128 qx = _mm_sub_ps(lpx, px), qy = _mm_sub_ps(lpy, py), qz = _mm_sub_ps(lpz, pz);
+		__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)), _mm_mul_ps(qz, qz)));
+		__m128 limit = _mm_div_ps(speed, factor);
+		__m128 vls = _mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, lvx), _mm_mul_ps(qy, lvy)), _mm_mul_ps(qz, lvz)), length);
+		__m128 vss = _mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, _mm_loadu_ps(batch->velX + i)), _mm_mul_ps(qy, _mm_loadu_ps(batch->velY + i))), _mm_mul_ps(qz, _mm_loadu_ps(batch->velZ + i))), length);
+		vls = _mm_min_ps(vls, limit);
+		vss = _mm_min_ps(vss, limit);
+		__m128 pitch = _mm_div_ps(_mm_sub_ps(speed, _mm_mul_ps(factor, vls)), _mm_sub_ps(speed, _mm_mul_ps(factor, vss)));
+		pitch = FosterSpatialSelect(_mm_and_ps(_mm_cmpgt_ps(factor, zero), _mm_cmpneq_ps(length, zero)), pitch, one);
+		_mm_storeu_ps(batch->pitch + i, pitch);
+	}
+
+	return i;
+}
+
+#endif
+
+// runs on the audio thread before mixing, the spatializers of the gathered voices then only apply the results
+static void FosterSpatialBatchUpdate(FosterAudioEngine* engine)
+{
+	FosterSpatialBatch* batch = &engine->spatial;
+	if (!batch->enabled)
+		return;
+
+	ma_spinlock_lock(&batch->lock);
+	FosterSpatialBatchGather(engine);
+
+	for (ma_uint32 l = 0; l < MA_ENGINE_MAX_LISTENERS; l++)
+	{
+		ma_uint32 i = batch->listenerBegin[l];
+		ma_uint32 end = batch->listenerBegin[l + 1];
+#if defined(MA_SUPPORT_SSE2)
+		i = FosterSpatialKernelSse2(batch, &batch->listeners[l], i, end);
+#endif
+		FosterSpatialKernelScalar(batch, &batch->listeners[l], i, end);
+	}
+
+	ma_uint32 count = batch->listenerBegin[MA_ENGINE_MAX_LISTENERS];
+	for (ma_uint32 i = 0; i < count; i++)
+	{
+		ma_spatializer* spatializer = &batch->active[i]->sound.engineNode.spatializer;
+		float loudest = 0;
+		for (ma_uint32 c = 0; c < batch->channels; c++)
+		{
+			spatializer->pNewChannelGainsOut[c] = batch->channelGains[c * batch->stride + i];
+			loudest = ma_max(loudest, spatializer->pNewChannelGainsOut[c]);
+		}
+		batch->active[i]->spatialGain = loudest;
+		spatializer->precomputedDopplerPitch = batch->pitch[i];
+		spatializer->hasPrecomputedGains = MA_TRUE;
+	}
+
+	ma_spinlock_unlock(&batch->lock);
+}
+
+// end Spatial
+
+// begin Idle
+
+#define FOSTER_IDLE_NONE 0xFFFFFFFF
+#define FOSTER_IDLE_UNKNOWN 0xFFFFFFFFFFFFFFFF
+
+// expects groupLock to be held, waits for the callback to be done with the voices it queued
+static void FosterIdleSync(FosterIdle* idle)
+{
+	while (ma_atomic_load_32(&idle->working))
+		ma_yield();
+}
+
+// appends to an idle list, growing it outside of the lock so the audio thread only ever waits for the copy
+static ma_uint32 FosterIdleListAdd(FosterAudioEngine* engine, FosterIdleList* list, void* item)
+{
+	for (;;)
+	{
+		ma_spinlock_lock(&engine->groupLock);
+		if (list->count < list->capacity)
+			break;
+		ma_uint32 capacity = list->capacity;
+		ma_spinlock_unlock(&engine->groupLock);
+
+		ma_uint32 newCapacity = capacity > 0 ? capacity * 2 : 64;
+		void** items = FosterMalloc(&engine->memory, newCapacity * 2 * sizeof(void*), FOSTER_MEMORY_CATEGORY_VOICES);
+		if (items == NULL)
+		{
+			FosterLogWarn("Unable to track the silence of a node (Out of Memory)");
+			return FOSTER_IDLE_NONE;
+		}
+
+		ma_spinlock_lock(&engine->groupLock);
+		if (list->capacity == capacity)
+		{
+			void** old = list->items;
+			if (list->count > 0)
+				MA_COPY_MEMORY(items, list->items, list->count * sizeof(void*));
+			FosterIdleSync(&engine->idle);
+			list->items = items;
+			list->work = items + newCapacity;
+			list->capacity = newCapacity;
+			items = old;
+		}
+		ma_spinlock_unlock(&engine->groupLock);
+		FosterFree(items);
+	}
+
+	ma_uint32 index = list->count++;
+	list->items[index] = item;
+	ma_spinlock_unlock(&engine->groupLock);
+	return index;
+}
+
+// expects groupLock to be held, returns the item that took over the index
+static void* FosterIdleListRemove(FosterIdleList* list, ma_uint32 index)
+{
+	list->items[index] = list->items[--list->count];
+	return list->items[index];
+}
+
+static void FosterIdleAddSound(FosterAudioEngine* engine, FosterSound* sound)
+{
+	sound->spatialGain = 1;
+	sound->idleState = FOSTER_IDLE_AWAKE;
+	sound->idleFrames = 0;
+	sound->idleRemaining = FOSTER_IDLE_UNKNOWN;
+	sound->idleIndex = FosterIdleListAdd(engine, &engine->idle.voices, sound);
+}
+
+static void FosterIdleRemoveSound(FosterAudioEngine* engine, FosterSound* sound)
+{
+	if (sound->idleIndex == FOSTER_IDLE_NONE)
+		return;
+
+	ma_spinlock_lock(&engine->groupLock);
+	FosterSound* moved = FosterIdleListRemove(&engine->idle.voices, sound->idleIndex);
+	moved->idleIndex = sound->idleIndex;
+	FosterIdleSync(&engine->idle);
+	ma_spinlock_unlock(&engine->groupLock);
+
+	sound->idleIndex = FOSTER_IDLE_NONE;
+}
+
+static void FosterIdleAddGroup(FosterAudioEngine* engine, FosterSoundGroup* soundGroup)
+{
+	soundGroup->idleAsleep = MA_FALSE;
+	soundGroup->virtualAdvance = MA_FALSE;
+	soundGroup->idleIndex = FosterIdleListAdd(engine, &engine->idle.groups, soundGroup);
+}
+
+static void FosterIdleRemoveGroup(FosterAudioEngine* engine, FosterSoundGroup* soundGroup)
+{
+	if (soundGroup->idleIndex == FOSTER_IDLE_NONE)
+		return;
+
+	ma_spinlock_lock(&engine->groupLock);
+	FosterSoundGroup* moved = FosterIdleListRemove(&engine->idle.groups, soundGroup->idleIndex);
+	moved->idleIndex = soundGroup->idleIndex;
+	ma_spinlock_unlock(&engine->groupLock);
+
+	soundGroup->idleIndex = FOSTER_IDLE_NONE;
+}
+
+// expects groupLock to be held, a node is covered when one of its ancestors sleeps and
+// only keeps time when all of the sleeping ones advance virtually
+static ma_bool32 FosterIdleCovered(FosterSoundGroup* soundGroup, ma_bool32* keepsTime, float* volume, float* pitch)
+{
+	ma_bool32 covered = MA_FALSE;
+	*keepsTime = MA_TRUE;
+	*volume = 1;
+	*pitch = 1;
+
+	for (; soundGroup != NULL; soundGroup = soundGroup->parent)
+	{
+		if (soundGroup->idleAsleep)
+		{
+			covered = MA_TRUE;
+			*keepsTime &= ma_atomic_load_32(&soundGroup->virtualAdvance);
+		}
+		*volume *= ma_sound_group_get_volume(&soundGroup->group);
+		*pitch *= ma_sound_group_get_pitch(&soundGroup->group);
+	}
+
+	return covered;
+}
+
+// where a voice ends up after playing frames more, looping voices wrap around their loop and
+// one-shots stop at their end, false when the voice has no known length
+static ma_bool32 FosterIdleCursor(FosterSound* sound, ma_uint64 frames, ma_uint64* cursor, ma_bool32* ended)
+{
+	ma_uint64 length;
+	*ended = MA_FALSE;
+	if (ma_sound_get_cursor_in_pcm_frames(&sound->sound, cursor) != MA_SUCCESS ||
+		ma_sound_get_length_in_pcm_frames(&sound->sound, &length) != MA_SUCCESS ||
+		length == 0)
+		return MA_FALSE;
+
+	*cursor += frames;
+	if (ma_sound_is_looping(&sound->sound))
+	{
+		ma_uint64 loopBegin, loopEnd;
+		ma_data_source_get_loop_point_in_pcm_frames(ma_sound_get_data_source(&sound->sound), &loopBegin, &loopEnd);
+		if (loopEnd > length)
+			loopEnd = length;
+		if (loopBegin < loopEnd && *cursor >= loopEnd)
+			*cursor = loopBegin + (*cursor - loopBegin) % (loopEnd - loopBegin);
+	}
+	else if (*cursor >= length)
+	{
+		*cursor = length;
+		*ended = MA_TRUE;
+	}
+
+	return MA_TRUE;
+}
+
+// moves a voice past the frames it spent asleep, a voice that would have finished is seeked to
+// its end and left playing so it finishes like it normally would
+static void FosterIdleAdvance(FosterSound* sound)
+{
+	ma_uint64 frames = (ma_uint64)sound->idleFrames;
+	sound->idleFrames -= (double)frames;
+
+	ma_uint64 cursor;
+	ma_bool32 ended;
+	if (frames == 0 || !FosterIdleCursor(sound, frames, &cursor, &ended))
+		return;
+
+	if (ended)
+		sound->idleState = FOSTER_IDLE_ENDING;
+	ma_sound_seek_to_pcm_frame(&sound->sound, cursor);
+}
+
+// remembers how far a sleeping voice is from its end, its cursor stays put until it wakes or is seeked
+static void FosterIdleMeasure(FosterSound* sound)
+{
+	ma_uint64 cursor, length;
+	sound->idleRemaining = FOSTER_IDLE_UNKNOWN;
+	if (ma_sound_get_cursor_in_pcm_frames(&sound->sound, &cursor) == MA_SUCCESS &&
+		ma_sound_get_length_in_pcm_frames(&sound->sound, &length) == MA_SUCCESS &&
+		length > 0)
+		sound->idleRemaining = cursor < length ? length - cursor : 0;
+}
+
+// a sleeping one-shot wakes once the frames it skipped take it past its end
+static ma_bool32 FosterIdleReachedEnd(FosterSound* sound)
+{
+	return
+		!ma_sound_is_looping(&sound->sound) &&
+		sound->idleRemaining != FOSTER_IDLE_UNKNOWN &&
+		(ma_uint64)sound->idleFrames >= sound->idleRemaining;
+}
+
+// expects groupLock to be held, frames skipped while asleep are relative to the old cursor
+static void FosterIdleSeekLocked(FosterSound* sound, ma_uint64 cursor)
+{
+	FosterIdleSync(&sound->engine->idle);
+	sound->idleFrames = 0;
+	ma_sound_seek_to_pcm_frame(&sound->sound, cursor);
+	if (sound->idleState == FOSTER_IDLE_ASLEEP)
+		FosterIdleMeasure(sound);
+}
+
+// expects groupLock to be held
+static void FosterIdleQueue(FosterIdle* idle, ma_uint32* count, FosterSound* sound, FosterIdleWork kind)
+{
+	sound->idleWork = kind;
+	idle->voices.work[(*count)++] = sound;
+}
+
+// runs without groupLock, nobody else destroys or seeks the voices until working is cleared
+static void FosterIdleRunWork(FosterSound** work, ma_uint32 count)
+{
+	for (ma_uint32 i = 0; i < count; i++)
+	{
+		FosterSound* sound = work[i];
+		switch (sound->idleWork)
+		{
+		case FOSTER_IDLE_WORK_MEASURE:
+			FosterIdleMeasure(sound);
+			break;
+		case FOSTER_IDLE_WORK_ADVANCE:
+			FosterIdleAdvance(sound);
+			break;
+		case FOSTER_IDLE_WORK_WAKE:
+			FosterIdleAdvance(sound);
+			ma_node_set_state(sound, ma_node_state_started);
+			break;
+		}
+	}
+}
+
+static void FosterIdleUpdate(FosterAudioEngine* engine, ma_uint64 frameCount)
+{
+	FosterIdle* idle = &engine->idle;
+	if (!idle->enabled)
+		return;
+
+	ma_uint32 sleepingGroups = 0;
+	ma_uint32 sleepingSounds = 0;
+	ma_uint32 skippedNodes = 0;
+	ma_uint32 workCount = 0;
+
+	// the game thread holds the lock for whole group trees and snapshots, rather than wait the callback skips its pass
+	// and the frames count towards the next one, where sleeping nodes catch up on them
+	if (ma_atomic_compare_and_swap_32(&engine->groupLock, 0, 1) != 0)
+	{
+		idle->deferredFrames += frameCount;
+		return;
+	}
+
+	double deferredFrames = (double)idle->deferredFrames / ma_engine_get_sample_rate(&engine->engine);
+	double engineFrames = (double)frameCount / ma_engine_get_sample_rate(&engine->engine) + deferredFrames;
+	idle->deferredFrames = 0;
+
+	// a group sleeps on its own volume, a stopped node isn't pulled so its whole subtree is skipped
+	for (ma_uint32 i = 0; i < idle->groups.count; i++)
+	{
+		FosterSoundGroup* soundGroup = idle->groups.items[i];
+		ma_bool32 silent = ma_sound_group_get_volume(&soundGroup->group) <= idle->threshold;
+		if (silent != soundGroup->idleAsleep)
+		{
+			ma_node_set_state(&soundGroup->group, silent ? ma_node_state_stopped : ma_node_state_started);
+			soundGroup->idleAsleep = silent;
+		}
+	}
+
+	for (ma_uint32 i = 0; i < idle->groups.count; i++)
+	{
+		FosterSoundGroup* soundGroup = idle->groups.items[i];
+		ma_bool32 keepsTime;
+		float volume, pitch;
+		if (soundGroup->idleAsleep)
+			sleepingGroups++;
+		if (soundGroup->idleAsleep || FosterIdleCovered(soundGroup->parent, &keepsTime, &volume, &pitch))
+			skippedNodes++;
+	}
+
+	for (ma_uint32 i = 0; i < idle->voices.count; i++)
+	{
+		FosterSound* sound = idle->voices.items[i];
+		ma_engine_node* node = &sound->sound.engineNode;
+		ma_bool32 playing = ma_node_get_state(sound) == ma_node_state_started;
+		ma_bool32 asleep = sound->idleState == FOSTER_IDLE_ASLEEP;
+		ma_bool32 seekable = sound->stream == NULL && sound->sequence == NULL;
+		ma_bool32 keepsTime;
+		float volume, pitch;
+		ma_bool32 covered = FosterIdleCovered(sound->group, &keepsTime, &volume, &pitch);
+
+		// frames of the source that the skipped frames would have consumed
+		double skippedFrames = engineFrames * node->sampleRate * ma_sound_get_pitch(&sound->sound) * pitch;
+
+		if (covered)
+		{
+			if (playing || asleep)
+			{
+				skippedNodes++;
+				if (keepsTime && seekable)
+					sound->idleFrames += skippedFrames;
+			}
+			continue;
+		}
+
+		if (sound->idleState == FOSTER_IDLE_ENDING)
+		{
+			if (!playing)
+				sound->idleState = FOSTER_IDLE_AWAKE;
+			continue;
+		}
+
+		// the spatial gains are only known here when they were computed by the batch
+		float gain = ma_sound_get_volume(&sound->sound) * ma_sound_get_current_fade_volume(&sound->sound) * volume;
+		if (node->spatializer.hasPrecomputedGains)
+			gain *= sound->spatialGain;
+		ma_bool32 silent = gain <= idle->threshold;
+
+		if (asleep && silent && !FosterIdleReachedEnd(sound))
+		{
+			sleepingSounds++;
+			skippedNodes++;
+			sound->idleFrames += skippedFrames;
+		}
+		else if (asleep)
+		{
+			sound->idleState = FOSTER_IDLE_AWAKE;
+			FosterIdleQueue(idle, &workCount, sound, FOSTER_IDLE_WORK_WAKE);
+		}
+		else if (playing && silent && seekable)
+		{
+			// it was playing through the deferred frames
+			sound->idleState = FOSTER_IDLE_ASLEEP;
+			sound->idleRemaining = FOSTER_IDLE_UNKNOWN;
+			ma_node_set_state(sound, ma_node_state_stopped);
+			sleepingSounds++;
+			skippedNodes++;
+			sound->idleFrames += skippedFrames * (engineFrames - deferredFrames) / engineFrames;
+			FosterIdleQueue(idle, &workCount, sound, FOSTER_IDLE_WORK_MEASURE);
+		}
+		else if (sound->idleFrames >= 1)
+		{
+			FosterIdleQueue(idle, &workCount, sound, FOSTER_IDLE_WORK_ADVANCE);
+		}
+	}
+
+	// seeks happen after unlocking, the game thread only waits for them when it touches a voice
+	FosterSound** work = (FosterSound**)idle->voices.work;
+	if (workCount > 0)
+		ma_atomic_exchange_32(&idle->working, 1);
+	ma_spinlock_unlock(&engine->groupLock);
+
+	if (workCount > 0)
+	{
+		FosterIdleRunWork(work, workCount);
+		ma_atomic_exchange_32(&idle->working, 0);
+	}
+
+	ma_atomic_store_32(&idle->sleepingGroups, sleepingGroups);
+	ma_atomic_store_32(&idle->sleepingSounds, sleepingSounds);
+	ma_atomic_store_32(&idle->skippedNodes, skippedNodes);
+	ma_atomic_fetch_add_64(&idle->totalSkippedNodes, skippedNodes);
+	ma_atomic_fetch_add_64(&idle->callbacks, 1);
+}
+
+// end Idle
+
+// begin PcmStream
+
+static ma_result FosterPcmStreamRead(ma_data_source* dataSource, void* framesOut, ma_uint64 frameCount, ma_uint64* framesRead)
+{
+	FosterPcmStream* stream = (FosterPcmStream*)dataSource;
+	ma_uint32 bytesPerFrame = ma_get_bytes_per_frame(stream->format, stream->channels);
+	ma_uint64 totalFramesRead = 0;
+
+	// at most two passes, the readable region can wrap around the end of the buffer
+	while (totalFramesRead < frameCount)
+	{
+		ma_uint64 remaining = frameCount - totalFramesRead;
+		ma_uint32 count = remaining > 0xFFFFFFFF ? 0xFFFFFFFF : (ma_uint32)remaining;
+		void* buffer;
+
+		if (MA_SUCCESS != ma_pcm_rb_acquire_read(&stream->buffer, &count, &buffer) || count == 0)
+			break;
+
+		MA_COPY_MEMORY(ma_offset_ptr(framesOut, totalFramesRead * bytesPerFrame), buffer, (size_t)count * bytesPerFrame);
+		ma_pcm_rb_commit_read(&stream->buffer, count);
+		totalFramesRead += count;
+	}
+
+	// running dry plays silence instead of ending the sound
+	if (totalFramesRead < frameCount)
+	{
+		ma_silence_pcm_frames(ma_offset_ptr(framesOut, totalFramesRead * bytesPerFrame), frameCount - totalFramesRead, stream->format, stream->channels);
+		ma_atomic_fetch_add_64(&stream->underrunFrames, frameCount - totalFramesRead);
+		if (!stream->starved)
+			ma_atomic_fetch_add_64(&stream->underrunCount, 1);
+		stream->starved = true;
+	}
+	else
+	{
+		stream->starved = false;
+	}
+
+	ma_atomic_fetch_add_64(&stream->cursor, frameCount);
+	*framesRead = frameCount;
+	return MA_SUCCESS;
+}
+
+static ma_result FosterPcmStreamSeek(ma_data_source* dataSource, ma_uint64 frameIndex)
+{
+	(void)dataSource;
+	(void)frameIndex;
+	return MA_NOT_IMPLEMENTED;
+}
+
+static ma_result FosterPcmStreamGetDataFormat(ma_data_source* dataSource, ma_format* format, ma_uint32* channels, ma_uint32* sampleRate, ma_channel* channelMap, size_t channelMapCap)
+{
+	FosterPcmStream* stream = (FosterPcmStream*)dataSource;
+	*format = stream->format;
+	*channels = stream->channels;
+	*sampleRate = stream->sampleRate;
+	ma_channel_map_init_standard(ma_standard_channel_map_default, channelMap, channelMapCap, stream->channels);
+	return MA_SUCCESS;
+}
+
+static ma_result FosterPcmStreamGetCursor(ma_data_source* dataSource, ma_uint64* cursor)
+{
+	*cursor = ma_atomic_load_64(&((FosterPcmStream*)dataSource)->cursor);
+	return MA_SUCCESS;
+}
+
+static ma_result FosterPcmStreamGetLength(ma_data_source* dataSource, ma_uint64* length)
+{
+	(void)dataSource;
+	*length = 0;
+	return MA_NOT_IMPLEMENTED;
+}
+
+static ma_data_source_vtable FosterPcmStreamVTable =
+{
+	FosterPcmStreamRead,
+	FosterPcmStreamSeek,
+	FosterPcmStreamGetDataFormat,
+	FosterPcmStreamGetCursor,
+	FosterPcmStreamGetLength,
+	NULL, /* onSetLooping() */
+	0
+};
+
+static FosterPcmStream* FosterPcmStreamCreate(FosterMemory* memory, ma_format format, ma_uint32 channels, ma_uint32 sampleRate, ma_uint32 capacityFrames)
+{
+	ma_allocation_callbacks callbacks = FosterAllocationCallbacks(memory, FOSTER_MEMORY_CATEGORY_STREAMING);
+	FosterPcmStream* stream = FosterMalloc(memory, sizeof(FosterPcmStream), FOSTER_MEMORY_CATEGORY_STREAMING);
+	if (stream == NULL)
+		return NULL;
+
+	MA_ZERO_OBJECT(stream);
+	stream->format = format;
+	stream->channels = channels;
+	stream->sampleRate = sampleRate;
+
+	ma_data_source_config config = ma_data_source_config_init();
+	config.vtable = &FosterPcmStreamVTable;
+
+	if (MA_SUCCESS != ma_data_source_init(&config, &stream->ds))
+	{
+		FosterFree(stream);
+		return NULL;
+	}
+
+	if (MA_SUCCESS != ma_pcm_rb_init(format, channels, capacityFrames, NULL, &callbacks, &stream->buffer))
+	{
+		ma_data_source_uninit(&stream->ds);
+		FosterFree(stream);
+		return NULL;
+	}
+
+	return stream;
+}
+
+static void FosterPcmStreamDestroy(FosterPcmStream* stream)
+{
+	ma_pcm_rb_uninit(&stream->buffer);
+	ma_data_source_uninit(&stream->ds);
+	FosterFree(stream);
+}
+
+static ma_uint64 FosterPcmStreamPush(FosterPcmStream* stream, const void* frames, ma_uint64 frameCount)
+{
+	ma_uint32 bytesPerFrame = ma_get_bytes_per_frame(stream->format, stream->channels);
+	ma_uint64 totalFramesWritten = 0;
+
+	while (totalFramesWritten < frameCount)
+	{
+		ma_uint64 remaining = frameCount - totalFramesWritten;
+		ma_uint32 count = remaining > 0xFFFFFFFF ? 0xFFFFFFFF : (ma_uint32)remaining;
+		void* buffer;
+
+		if (MA_SUCCESS != ma_pcm_rb_acquire_write(&stream->buffer, &count, &buffer) || count == 0)
+			break;
+
+		MA_COPY_MEMORY(buffer, ma_offset_ptr(frames, totalFramesWritten * bytesPerFrame), (size_t)count * bytesPerFrame);
+		ma_pcm_rb_commit_write(&stream->buffer, count);
+		totalFramesWritten += count;
+	}
+
+	return totalFramesWritten;
+}
+
+// end PcmStream
+
+// begin Sequence
+
+static FosterMemoryCategory FosterSequenceSlotCategory(FosterSequenceSlot* slot)
+{
+	return
+		FOSTER_CHECK(slot->flags, FOSTER_SOUND_FLAG_STREAM) ? FOSTER_MEMORY_CATEGORY_STREAMING :
+		FOSTER_CHECK(slot->flags, FOSTER_SOUND_FLAG_DECODE) ? FOSTER_MEMORY_CATEGORY_DECODED :
+		FOSTER_MEMORY_CATEGORY_ENCODED;
+}
+
+// the last thing a load job does, once every posted job has checked in the slots can go away
+static void FosterSequenceLoadDone(FosterSequence* sequence, FosterSequenceSlot* slot, ma_result result)
+{
+	ma_atomic_exchange_32(&slot->state, result == MA_SUCCESS ? FOSTER_SEQUENCE_SLOT_READY : FOSTER_SEQUENCE_SLOT_FAILED);
+	ma_semaphore_release(&sequence->loadsDone);
+}
+
+static void FosterSequenceLoadFinish(FosterSequence* sequence, FosterSequenceSlot* slot)
+{
+	ma_result result = ma_atomic_load_32(&sequence->cancelled) ? MA_CANCELLED : ma_resource_manager_data_source_result(&slot->source);
+
+	ma_format format;
+	ma_uint32 channels, sampleRate;
+	if (result == MA_SUCCESS)
+		result = ma_resource_manager_data_source_get_data_format(&slot->source, &format, &channels, &sampleRate, NULL, 0);
+
+	if (result == MA_SUCCESS)
+	{
+		ma_allocation_callbacks callbacks = FosterAllocationCallbacks(&sequence->engine->memory, FOSTER_MEMORY_CATEGORY_DSP);
+		ma_data_converter_config config = ma_data_converter_config_init(format, ma_format_f32, channels, sequence->channels, sampleRate, sequence->sampleRate);
+		result = ma_data_converter_init(&config, &callbacks, &slot->converter);
+		slot->converterInitialized = result == MA_SUCCESS;
+	}
+
+	if (result == MA_SUCCESS)
+	{
+		// unknown lengths (some streams) just can't crossfade
+		if (ma_resource_manager_data_source_get_length_in_pcm_frames(&slot->source, &slot->length) != MA_SUCCESS)
+			slot->length = 0;
+		ma_data_source_set_looping(&slot->source, slot->loopCount != 0);
+	}
+
+	FosterSequenceLoadDone(sequence, slot, result);
+}
+
+// the resource manager's signal and the load job returning can happen in either order, the second one finishes the slot
+static void FosterSequenceLoadArrive(FosterSequence* sequence, FosterSequenceSlot* slot)
+{
+	if (ma_atomic_fetch_add_32(&slot->arrivals, 1) == 1)
+		FosterSequenceLoadFinish(sequence, slot);
+}
+
+static void FosterSequenceLoaded(ma_async_notification* notification)
+{
+	FosterSequenceNotification* loaded = (FosterSequenceNotification*)notification;
+	FosterSequenceLoadArrive(loaded->sequence, &loaded->sequence->slots[loaded->index]);
+}
+
+// runs on the job thread and starts loading the segment, the resource manager signals the slot once it's playable
+// loading is asynchronous because waiting for a resource manager job from within a job would never return
+static ma_result FosterSequenceLoadJob(ma_job* job)
+{
+	FosterSequence* sequence = (FosterSequence*)job->data.custom.data0;
+	FosterSequenceSlot* slot = &sequence->slots[job->data.custom.data1];
+	FosterAudioEngine* engine = sequence->engine;
+
+	if (ma_atomic_load_32(&sequence->cancelled))
+	{
+		FosterSequenceLoadDone(sequence, slot, MA_CANCELLED);
+		return MA_SUCCESS;
+	}
+
+	slot->loaded.cb.onSignal = FosterSequenceLoaded;
+	slot->loaded.sequence = sequence;
+	slot->loaded.index = (ma_uint32)job->data.custom.data1;
+
+	// streams are playable once their first pages are decoded, buffers once they're fully decoded
+	ma_resource_manager_pipeline_notifications notifications = ma_resource_manager_pipeline_notifications_init();
+	if (FOSTER_CHECK(slot->flags, FOSTER_SOUND_FLAG_STREAM))
+		notifications.init.pNotification = &slot->loaded;
+	else
+		notifications.done.pNotification = &slot->loaded;
+
+	ma_resource_manager_data_source_config config = ma_resource_manager_data_source_config_init();
+	config.pFilePath = slot->path;
+	config.flags = slot->flags | MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_ASYNC;
+	config.pNotifications = &notifications;
+
+	fosterThreadCategory = FosterSequenceSlotCategory(slot);
+	ma_result result = ma_resource_manager_data_source_init_ex(&engine->resourceManager, &config, &slot->source);
+	fosterThreadCategory = FOSTER_MEMORY_CATEGORY_OTHER;
+
+	// a failed init may or may not have signalled, either way it never reaches the second arrival
+	if (result != MA_SUCCESS)
+	{
+		FosterLogError("Unable to load Sequence segment '%s'", slot->path);
+		FosterSequenceLoadDone(sequence, slot, result);
+		return MA_SUCCESS;
+	}
+
+	slot->sourceInitialized = true;
+	FosterSequenceLoadArrive(sequence, slot);
+	return MA_SUCCESS;
+}
+
+// safe to call from the audio thread, posting a job doesn't lock or allocate
+static void FosterSequencePrefetch(FosterSequence* sequence, ma_uint32 index)
+{
+	if (index >= sequence->slotCount)
+		return;
+
+	FosterSequenceSlot* slot = &sequence->slots[index];
+	if (ma_atomic_compare_and_swap_32(&slot->state, FOSTER_SEQUENCE_SLOT_IDLE, FOSTER_SEQUENCE_SLOT_LOADING) != FOSTER_SEQUENCE_SLOT_IDLE)
+		return;
+
+	ma_job job = ma_job_init(MA_JOB_TYPE_CUSTOM);
+	job.data.custom.proc = FosterSequenceLoadJob;
+	job.data.custom.data0 = (ma_uintptr)sequence;
+	job.data.custom.data1 = index;
+
+	if (ma_resource_manager_post_job(&sequence->engine->resourceManager, &job) != MA_SUCCESS)
+		ma_atomic_exchange_32(&slot->state, FOSTER_SEQUENCE_SLOT_FAILED);
+	else
+		ma_atomic_fetch_add_32(&sequence->loadJobs, 1);
+}
+
+// moves on to the next segment, the finished one is released later by the game thread
+static void FosterSequenceNext(FosterSequence* sequence)
+{
+	FosterSequenceSlot* slot = &sequence->slots[sequence->current];
+	if (ma_atomic_load_32(&slot->state) == FOSTER_SEQUENCE_SLOT_READY)
+		ma_atomic_exchange_32(&slot->state, FOSTER_SEQUENCE_SLOT_RETIRED);
+
+	ma_uint32 current = sequence->current + 1;
+	if (current < sequence->slotCount)
+		sequence->loopsRemaining = sequence->slots[current].loopCount;
+	ma_atomic_exchange_32(&sequence->advance, 0);
+	ma_atomic_exchange_32(&sequence->current, current);
+	FosterSequencePrefetch(sequence, current + 1);
+}
+
+// reads converted frames from a segment, counting loop iterations as the source wraps around
+// only the current segment can be advanced, the next one is read ahead during crossfades
+static ma_uint64 FosterSequenceSlotRead(FosterSequence* sequence, FosterSequenceSlot* slot, ma_int32* loopsRemaining, ma_bool32 current, float* frames, ma_uint64 frameCount, ma_bool32* atEnd)
+{
+	ma_uint8 temp[MA_DATA_CONVERTER_STACK_BUFFER_SIZE];
+	ma_format format = slot->converter.formatIn;
+	ma_uint64 tempFrames = sizeof(temp) / ma_get_bytes_per_frame(format, slot->converter.channelsIn);
+	ma_uint64 totalFramesRead = 0;
+
+	*atEnd = false;
+	while (totalFramesRead < frameCount)
+	{
+		// the loop is left at the end of the iteration that's playing when the count runs out or an advance is requested
+		ma_bool32 looping = *loopsRemaining != 0 && !(current && ma_atomic_load_32(&sequence->advance));
+		if (ma_data_source_is_looping(&slot->source) != looping)
+			ma_data_source_set_looping(&slot->source, looping);
+
+		ma_uint64 framesOut = frameCount - totalFramesRead;
+		ma_uint64 framesIn = 0;
+		ma_data_converter_get_required_input_frame_count(&slot->converter, framesOut, &framesIn);
+		if (framesIn > tempFrames)
+			framesIn = tempFrames;
+		if (framesIn == 0)
+			framesIn = 1;
+
+		ma_uint64 cursorBefore = 0, cursorAfter = 0, read = 0;
+		ma_data_source_get_cursor_in_pcm_frames(&slot->source, &cursorBefore);
+		ma_result result = ma_data_source_read_pcm_frames(&slot->source, temp, framesIn, &read);
+		ma_data_source_get_cursor_in_pcm_frames(&slot->source, &cursorAfter);
+
+		if (looping && cursorAfter < cursorBefore && *loopsRemaining > 0)
+			(*loopsRemaining)--;
+
+		ma_uint64 consumed = read;
+		ma_data_converter_process_pcm_frames(&slot->converter, temp, &consumed, frames + totalFramesRead * sequence->channels, &framesOut);
+		totalFramesRead += framesOut;
+
+		if (result == MA_AT_END)
+		{
+			*atEnd = true;
+			break;
+		}
+
+		// a stream that hasn't decoded far enough yet
+		if (read == 0)
+			break;
+	}
+
+	return totalFramesRead;
+}
+
+// output frames left in the final iteration of the segment, or ~0 if it's still looping or the length is unknown
+static ma_uint64 FosterSequenceSlotRemaining(FosterSequence* sequence, FosterSequenceSlot* slot)
+{
+	if (slot->length == 0 || (sequence->loopsRemaining != 0 && !ma_atomic_load_32(&sequence->advance)))
+		return ~(ma_uint64)0;
+
+	ma_uint64 cursor = 0, remaining = 0;
+	ma_data_source_get_cursor_in_pcm_frames(&slot->source, &cursor);
+	ma_data_converter_get_expected_output_frame_count(&slot->converter, cursor < slot->length ? slot->length - cursor : 0, &remaining);
+	return remaining;
+}
+
+static ma_result FosterSequenceRead(ma_data_source* dataSource, void* framesOut, ma_uint64 frameCount, ma_uint64* framesRead)
+{
+	FosterSequence* sequence = (FosterSequence*)dataSource;
+	ma_uint32 channels = sequence->channels;
+	float* frames = (float*)framesOut;
+	ma_uint64 totalFramesRead = 0;
+
+	while (totalFramesRead < frameCount && sequence->current < sequence->slotCount)
+	{
+		FosterSequenceSlot* slot = &sequence->slots[sequence->current];
+		ma_uint32 state = ma_atomic_load_32(&slot->state);
+
+		if (state == FOSTER_SEQUENCE_SLOT_FAILED)
+		{
+			FosterSequenceNext(sequence);
+			continue;
+		}
+
+		// not loaded in time, play silence rather than stall the mix
+		if (state != FOSTER_SEQUENCE_SLOT_READY)
+			break;
+
+		FosterSequenceSlot* next = sequence->current + 1 < sequence->slotCount ? &sequence->slots[sequence->current + 1] : NULL;
+		ma_uint64 fade = next != NULL ? slot->crossfadeFrames : 0;
+		ma_uint64 remaining = fade > 0 ? FosterSequenceSlotRemaining(sequence, slot) : ~(ma_uint64)0;
+		ma_uint64 count = frameCount - totalFramesRead;
+		float* out = frames + totalFramesRead * channels;
+		ma_bool32 atEnd;
+
+		if (remaining <= fade && ma_atomic_load_32(&next->state) == FOSTER_SEQUENCE_SLOT_READY)
+		{
+			// both segments play during the last fade frames of the current one
+			float temp[MA_DATA_CONVERTER_STACK_BUFFER_SIZE / sizeof(float)];
+			ma_uint64 tempFrames = (sizeof(temp) / sizeof(float)) / channels;
+			if (count > remaining)
+				count = remaining > 0 ? remaining : 1;
+			if (count > tempFrames)
+				count = tempFrames;
+
+			ma_int32 nextLoopsRemaining = next->loopCount;
+			ma_bool32 nextAtEnd;
+			ma_uint64 read = FosterSequenceSlotRead(sequence, slot, &sequence->loopsRemaining, true, out, count, &atEnd);
+			ma_uint64 nextRead = FosterSequenceSlotRead(sequence, next, &nextLoopsRemaining, false, temp, count, &nextAtEnd);
+			if (read < count)
+				ma_silence_pcm_frames(out + read * channels, count - read, ma_format_f32, channels);
+			if (nextRead < count)
+				ma_silence_pcm_frames(temp + nextRead * channels, count - nextRead, ma_format_f32, channels);
+
+			for (ma_uint64 i = 0; i < count; i++)
+			{
+				float t = (float)(fade - remaining + i) / (float)fade;
+				if (t > 1.0f)
+					t = 1.0f;
+				for (ma_uint32 c = 0; c < channels; c++)
+					out[i * channels + c] = out[i * channels + c] * (1.0f - t) + temp[i * channels + c] * t;
+			}
+
+			totalFramesRead += count;
+			if (atEnd || read < count)
+				FosterSequenceNext(sequence);
+			continue;
+		}
+
+		// stop short of the crossfade so it starts on the exact frame
+		if (fade > 0 && remaining != ~(ma_uint64)0 && remaining > fade && count > remaining - fade)
+			count = remaining - fade;
+
+		ma_uint64 read = FosterSequenceSlotRead(sequence, slot, &sequence->loopsRemaining, true, out, count, &atEnd);
+		totalFramesRead += read;
+
+		if (atEnd)
+			FosterSequenceNext(sequence);
+		else if (read == 0)
+			break;
+	}
+
+	ma_bool32 finished = sequence->current >= sequence->slotCount;
+	if (totalFramesRead < frameCount && !finished)
+	{
+		ma_silence_pcm_frames(frames + totalFramesRead * channels, frameCount - totalFramesRead, ma_format_f32, channels);
+		ma_atomic_fetch_add_64(&sequence->lateFrames, frameCount - totalFramesRead);
+		totalFramesRead = frameCount;
+	}
+
+	ma_atomic_fetch_add_64(&sequence->cursor, totalFramesRead);
+	*framesRead = totalFramesRead;
+	return finished ? MA_AT_END : MA_SUCCESS;
+}
+
+static ma_result FosterSequenceSeek(ma_data_source* dataSource, ma_uint64 frameIndex)
+{
+	(void)dataSource;
+	(void)frameIndex;
+	return MA_NOT_IMPLEMENTED;
+}
+
+static ma_result FosterSequenceGetDataFormat(ma_data_source* dataSource, ma_format* format, ma_uint32* channels, ma_uint32* sampleRate, ma_channel* channelMap, size_t channelMapCap)
+{
+	FosterSequence* sequence = (FosterSequence*)dataSource;
+	*format = ma_format_f32;
+	*channels = sequence->channels;
+	*sampleRate = sequence->sampleRate;
+	ma_channel_map_init_standard(ma_standard_channel_map_default, channelMap, channelMapCap, sequence->channels);
+	return MA_SUCCESS;
+}
+
+static ma_result FosterSequenceGetCursor(ma_data_source* dataSource, ma_uint64* cursor)
+{
+	*cursor = ma_atomic_load_64(&((FosterSequence*)dataSource)->cursor);
+	return MA_SUCCESS;
+}
+
+static ma_result FosterSequenceGetLength(ma_data_source* dataSource, ma_uint64* length)
+{
+	(void)dataSource;
+	*length = 0;
+	return MA_NOT_IMPLEMENTED;
+}
+
+static ma_data_source_vtable FosterSequenceVTable =
+{
+	FosterSequenceRead,
+	FosterSequenceSeek,
+	FosterSequenceGetDataFormat,
+	FosterSequenceGetCursor,
+	FosterSequenceGetLength,
+	NULL, /* onSetLooping() */
+	0
+};
+
+static void FosterSequenceSlotRelease(FosterSequence* sequence, FosterSequenceSlot* slot)
+{
+	ma_allocation_callbacks callbacks = FosterAllocationCallbacks(&sequence->engine->memory, FOSTER_MEMORY_CATEGORY_DSP);
+	if (slot->converterInitialized)
+		ma_data_converter_uninit(&slot->converter, &callbacks);
+	if (slot->sourceInitialized)
+		ma_resource_manager_data_source_uninit(&slot->source);
+
+	slot->converterInitialized = false;
+	slot->sourceInitialized = false;
+	ma_atomic_exchange_32(&slot->state, FOSTER_SEQUENCE_SLOT_RELEASED);
+}
+
+static void FosterSequenceDestroy(FosterSequence* sequence)
+{
+	// loads that haven't started are skipped once cancelled, every posted one has to check in before its slot goes away
+	ma_atomic_exchange_32(&sequence->cancelled, 1);
+	for (ma_uint32 i = 0; i < sequence->loadJobs; i++)
+		ma_semaphore_wait(&sequence->loadsDone);
+	ma_semaphore_uninit(&sequence->loadsDone);
+
+	for (ma_uint32 i = 0; i < sequence->slotCount; i++)
+	{
+		FosterSequenceSlotRelease(sequence, &sequence->slots[i]);
+		FosterFree(sequence->slots[i].path);
+	}
+
+	ma_data_source_uninit(&sequence->ds);
+	FosterFree(sequence->slots);
+	FosterFree(sequence);
+}
+
+static FosterSequence* FosterSequenceCreate(FosterAudioEngine* engine, const FosterSequenceSegment* segments, int segmentCount)
+{
+	FosterSequence* sequence = FosterMalloc(&engine->memory, sizeof(FosterSequence), FOSTER_MEMORY_CATEGORY_VOICES);
+	FosterSequenceSlot* slots = FosterMalloc(&engine->memory, sizeof(FosterSequenceSlot) * segmentCount, FOSTER_MEMORY_CATEGORY_VOICES);
+	if (sequence == NULL || slots == NULL)
+	{
+		FosterFree(sequence);
+		FosterFree(slots);
+		return NULL;
+	}
+
+	MA_ZERO_OBJECT(sequence);
+	MA_ZERO_MEMORY(slots, sizeof(FosterSequenceSlot) * segmentCount);
+	if (MA_SUCCESS != ma_semaphore_init(0, &sequence->loadsDone))
+	{
+		FosterFree(sequence);
+		FosterFree(slots);
+		return NULL;
+	}
+
+	sequence->engine = engine;
+	sequence->slots = slots;
+	sequence->slotCount = (ma_uint32)segmentCount;
+	sequence->channels = ma_engine_get_channels(&engine->engine);
+	sequence->sampleRate = ma_engine_get_sample_rate(&engine->engine);
+	sequence->loopsRemaining = segments[0].loopCount;
+
+	for (int i = 0; i < segmentCount; i++)
+	{
+		size_t length = strlen(segments[i].path);
+		slots[i].path = FosterMalloc(&engine->memory, length + 1, FOSTER_MEMORY_CATEGORY_VOICES);
+		slots[i].flags = segments[i].flags & (FOSTER_SOUND_FLAG_STREAM | FOSTER_SOUND_FLAG_DECODE);
+		slots[i].loopCount = segments[i].loopCount;
+		slots[i].crossfadeFrames = segments[i].crossfadeFrames;
+		slots[i].state = FOSTER_SEQUENCE_SLOT_IDLE;
+		if (slots[i].path == NULL)
+		{
+			FosterSequenceDestroy(sequence);
+			return NULL;
+		}
+		MA_COPY_MEMORY(slots[i].path, segments[i].path, length + 1);
+	}
+
+	ma_data_source_config config = ma_data_source_config_init();
+	config.vtable = &FosterSequenceVTable;
+
+	if (MA_SUCCESS != ma_data_source_init(&config, &sequence->ds))
+	{
+		FosterSequenceDestroy(sequence);
+		return NULL;
+	}
+
+	// the first segment and the one after it start loading right away
+	FosterSequencePrefetch(sequence, 0);
+	FosterSequencePrefetch(sequence, 1);
+	return sequence;
+}
+
+// end Sequence
+
+// begin Capture
+
+#define FOSTER_CAPTURE_UNSYNCED (~(ma_uint64)0)
+
+// streams QOA frames to a file, the header is patched with the total length once closed
+struct FosterQoaWriter
+{
+	FILE* file;
+	qoa_desc desc;
+	short* samples;
+	unsigned char* bytes;
+	ma_uint32 frameLength;
+	ma_uint64 totalFrames;
+};
+
+static FosterQoaWriter* FosterQoaWriterOpen(FosterMemory* memory, const char* path, ma_uint32 channels, ma_uint32 sampleRate)
+{
+	if (channels > QOA_MAX_CHANNELS)
+		return NULL;
+
+	FosterQoaWriter* writer = FosterMalloc(memory, sizeof(FosterQoaWriter), FOSTER_MEMORY_CATEGORY_OTHER);
+	if (writer == NULL)
+		return NULL;
+
+	MA_ZERO_OBJECT(writer);
+	writer->desc.channels = channels;
+	writer->desc.samplerate = sampleRate;
+
+	// same initial LMS state as qoa_encode
+	for (ma_uint32 c = 0; c < channels; c++)
+	{
+		writer->desc.lms[c].weights[2] = -(1 << 13);
+		writer->desc.lms[c].weights[3] = (1 << 14);
+	}
+
+	unsigned char header[8];
+	writer->samples = FosterMalloc(memory, QOA_FRAME_LEN * channels * sizeof(short), FOSTER_MEMORY_CATEGORY_OTHER);
+	writer->bytes = FosterMalloc(memory, qoa_max_frame_size(&writer->desc), FOSTER_MEMORY_CATEGORY_OTHER);
+	if (writer->samples == NULL || writer->bytes == NULL ||
+		ma_fopen(&writer->file, path, "wb") != MA_SUCCESS ||
+		fwrite(header, 1, qoa_encode_header(&writer->desc, header), writer->file) != sizeof(header))
+	{
+		if (writer->file != NULL)
+			fclose(writer->file);
+		FosterFree(writer->samples);
+		FosterFree(writer->bytes);
+		FosterFree(writer);
+		return NULL;
+	}
+
+	return writer;
+}
+
+// returns false if the frame couldn't be written, its frames aren't counted
+static FosterBool FosterQoaWriterFlush(FosterQoaWriter* writer)
+{
+	if (writer->frameLength == 0)
+		return true;
+
+	unsigned int size = qoa_encode_frame(writer->samples, &writer->desc, writer->frameLength, writer->bytes);
+	FosterBool success = fwrite(writer->bytes, 1, size, writer->file) == size;
+	if (success)
+		writer->totalFrames += writer->frameLength;
+	writer->frameLength = 0;
+	return success;
+}
+
+// returns false at the first frame that couldn't be written
+static FosterBool FosterQoaWriterWrite(FosterQoaWriter* writer, const float* frames, ma_uint32 frameCount)
+{
+	ma_uint32 channels = writer->desc.channels;
+
+	while (frameCount > 0)
+	{
+		ma_uint32 count = QOA_FRAME_LEN - writer->frameLength;
+		if (count > frameCount)
+			count = frameCount;
+
+		ma_pcm_f32_to_s16(writer->samples + writer->frameLength * channels, frames, count * channels, ma_dither_mode_none);
+		writer->frameLength += count;
+		frames += count * channels;
+		frameCount -= count;
+
+		if (writer->frameLength == QOA_FRAME_LEN && !FosterQoaWriterFlush(writer))
+			return false;
+	}
+
+	return true;
+}
+
+// returns false if any write failed
+static FosterBool FosterQoaWriterClose(FosterQoaWriter* writer)
+{
+	FosterBool success = FosterQoaWriterFlush(writer);
+
+	unsigned char header[8];
+	writer->desc.samples = (unsigned int)writer->totalFrames;
+	fseek(writer->file, 0, SEEK_SET);
+	fwrite(header, 1, qoa_encode_header(&writer->desc, header), writer->file);
+	if (ferror(writer->file))
+		success = false;
+	if (fclose(writer->file) != 0)
+		success = false;
+
+	FosterFree(writer->samples);
+	FosterFree(writer->bytes);
+	FosterFree(writer);
+	return success;
+}
+
+// logged once, nothing is written after the first failure
+static void FosterCaptureFail(FosterCapture* capture)
+{
+	if (ma_atomic_exchange_32(&capture->failed, 1) == 0)
+		FosterLogError("Unable to write Capture to '%s'", capture->path);
+}
+
+// the wav encoder keeps writing after a short write, so failures are caught here
+static ma_result FosterCaptureEncoderWrite(ma_encoder* encoder, const void* data, size_t bytesToWrite, size_t* bytesWritten)
+{
+	FosterCapture* capture = (FosterCapture*)encoder->pUserData;
+	*bytesWritten = fwrite(data, 1, bytesToWrite, capture->file);
+	if (*bytesWritten == bytesToWrite)
+		return MA_SUCCESS;
+
+	FosterCaptureFail(capture);
+	return MA_IO_ERROR;
+}
+
+static ma_result FosterCaptureEncoderSeek(ma_encoder* encoder, ma_int64 offset, ma_seek_origin origin)
+{
+	FosterCapture* capture = (FosterCapture*)encoder->pUserData;
+	int whence = origin == ma_seek_origin_start ? SEEK_SET : origin == ma_seek_origin_end ? SEEK_END : SEEK_CUR;
+	return fseek(capture->file, (long)offset, whence) == 0 ? MA_SUCCESS : MA_IO_ERROR;
+}
+
+static FosterBool FosterCaptureOpen(FosterCapture* capture)
+{
+	FosterMemory* memory = &capture->engine->memory;
+
+	switch (capture->format)
+	{
+		case FOSTER_CAPTURE_FORMAT_WAV:
+		{
+			ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, capture->channels, capture->sampleRate);
+			config.allocationCallbacks = FosterAllocationCallbacks(memory, FOSTER_MEMORY_CATEGORY_OTHER);
+			if (capture->path == NULL || ma_fopen(&capture->file, capture->path, "wb") != MA_SUCCESS)
+				return false;
+			if (ma_encoder_init(FosterCaptureEncoderWrite, FosterCaptureEncoderSeek, capture, &config, &capture->encoder) != MA_SUCCESS)
+			{
+				fclose(capture->file);
+				capture->file = NULL;
+				return false;
+			}
+			return true;
+		}
+		case FOSTER_CAPTURE_FORMAT_QOA:
+			capture->qoa = capture->path != NULL ? FosterQoaWriterOpen(memory, capture->path, capture->channels, capture->sampleRate) : NULL;
+			return capture->qoa != NULL;
+		case FOSTER_CAPTURE_FORMAT_CALLBACK:
+			return capture->callback != NULL;
+	}
+
+	return false;
+}
+
+static void FosterCaptureClose(FosterCapture* capture)
+{
+	switch (capture->format)
+	{
+		case FOSTER_CAPTURE_FORMAT_WAV:
+			ma_encoder_uninit(&capture->encoder);
+			if (fclose(capture->file) != 0)
+				FosterCaptureFail(capture);
+			capture->file = NULL;
+			break;
+		case FOSTER_CAPTURE_FORMAT_QOA:
+			if (!FosterQoaWriterClose(capture->qoa))
+				FosterCaptureFail(capture);
+			capture->qoa = NULL;
+			break;
+		case FOSTER_CAPTURE_FORMAT_CALLBACK:
+			break;
+	}
+}
+
+static void FosterCaptureSink(FosterCapture* capture, const float* frames, ma_uint32 frameCount)
+{
+	if (ma_atomic_load_32(&capture->failed))
+		return;
+
+	ma_uint64 written = frameCount;
+	switch (capture->format)
+	{
+		case FOSTER_CAPTURE_FORMAT_WAV:
+			if (ma_encoder_write_pcm_frames(&capture->encoder, frames, frameCount, &written) != MA_SUCCESS || written < frameCount)
+				FosterCaptureFail(capture);
+			break;
+		case FOSTER_CAPTURE_FORMAT_QOA:
+		{
+			// frames of a qoa frame that failed to write are lost, so only the ones flushed or still pending count
+			ma_uint64 before = capture->qoa->totalFrames + capture->qoa->frameLength;
+			if (!FosterQoaWriterWrite(capture->qoa, frames, frameCount))
+				FosterCaptureFail(capture);
+			written = capture->qoa->totalFrames + capture->qoa->frameLength - before;
+			break;
+		}
+		case FOSTER_CAPTURE_FORMAT_CALLBACK:
+			capture->callback(capture->context, (void*)frames, (int)(frameCount * capture->channels * sizeof(float)));
+			break;
+	}
+
+	ma_atomic_fetch_add_64(&capture->writtenFrames, written);
+}
+
+// drains the ring whenever the audio thread has written to it, and once more after being told to quit
+static ma_thread_result MA_THREADCALL FosterCaptureThread(void* userData)
+{
+	FosterCapture* capture = (FosterCapture*)userData;
+
+	for (;;)
+	{
+		ma_semaphore_wait(&capture->wake);
+		ma_uint32 quit = ma_atomic_load_32(&capture->quit);
+
+		for (;;)
+		{
+			ma_uint32 count = ma_pcm_rb_available_read(&capture->buffer);
+			void* buffer;
+
+			if (count == 0 || MA_SUCCESS != ma_pcm_rb_acquire_read(&capture->buffer, &count, &buffer) || count == 0)
+				break;
+
+			FosterCaptureSink(capture, (const float*)buffer, count);
+			ma_pcm_rb_commit_read(&capture->buffer, count);
+		}
+
+		if (quit)
+			break;
+	}
+
+	FosterCaptureClose(capture);
+	return (ma_thread_result)0;
+}
+
+// copies the part of a block inside [startTime, stopTime) into the ring, never blocking
+// blocks are written whole or not at all so dropped audio is counted in blocks
+static void FosterCaptureWrite(FosterCapture* capture, const float* frames, ma_uint32 frameCount, ma_uint64 time)
+{
+	ma_uint64 stopTime = ma_atomic_load_64(&capture->stopTime);
+	ma_uint64 begin = time > capture->startTime ? time : capture->startTime;
+	ma_uint64 end = time + frameCount < stopTime ? time + frameCount : stopTime;
+	if (begin >= end)
+		return;
+
+	ma_uint32 count = (ma_uint32)(end - begin);
+	frames += (begin - time) * capture->channels;
+
+	if (ma_pcm_rb_available_write(&capture->buffer) < count)
+	{
+		ma_atomic_fetch_add_64(&capture->droppedBlocks, 1);
+		ma_atomic_fetch_add_64(&capture->droppedFrames, count);
+		return;
+	}
+
+	// at most two passes, the writable region can wrap around the end of the buffer
+	ma_uint32 written = 0;
+	while (written < count)
+	{
+		ma_uint32 available = count - written;
+		void* buffer;
+
+		if (MA_SUCCESS != ma_pcm_rb_acquire_write(&capture->buffer, &available, &buffer) || available == 0)
+			break;
+
+		MA_COPY_MEMORY(buffer, frames + written * capture->channels, available * capture->channels * sizeof(float));
+		ma_pcm_rb_commit_write(&capture->buffer, available);
+		written += available;
+	}
+
+	ma_atomic_fetch_add_64(&capture->capturedFrames, written);
+	ma_semaphore_release(&capture->wake);
+}
+
+// passthrough, the frames are already in the output so they only need to be copied out
+static void FosterCaptureProcess(ma_node* node, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut)
+{
+	(void)pFrameCountIn;
+	(void)ppFramesOut;
+	FosterCapture* capture = (FosterCapture*)node;
+	ma_uint32 frameCount = *pFrameCountOut;
+
+	// the cursor is synced to the engine clock at the start of every render, until then the time is unknown
+	if (capture->cursor == FOSTER_CAPTURE_UNSYNCED)
+		return;
+
+	FosterCaptureWrite(capture, ppFramesIn[0], frameCount, capture->cursor);
+	capture->cursor += frameCount;
+}
+
+static ma_node_vtable FosterCaptureVTable =
+{
+	FosterCaptureProcess,
+	NULL, /* onGetRequiredInputFrameCount() */
+	1,    /* input buses */
+	1,    /* output buses */
+	MA_NODE_FLAG_PASSTHROUGH
+};
+
+// inserts the capture between the group and whatever it was feeding
+static void FosterCaptureAttach(FosterCapture* capture, FosterSoundGroup* soundGroup)
+{
+	FosterAudioEngine* engine = soundGroup->engine;
+
+	if (soundGroup->branch != NULL)
+	{
+		// parallel groups are read by their branch directly, so the branch reads the capture instead
+		ma_node_attach_output_bus(&soundGroup->group, 0, &capture->node, 0);
+		ma_atomic_exchange_ptr(&soundGroup->branch->source, &capture->node);
+	}
+	else
+	{
+		ma_node* destination = soundGroup->parent != NULL ? (ma_node*)&soundGroup->parent->group : ma_engine_get_endpoint(&engine->engine);
+		ma_node_attach_output_bus(&capture->node, 0, destination, 0);
+		ma_node_attach_output_bus(&soundGroup->group, 0, &capture->node, 0);
+	}
+
+	soundGroup->capture = capture;
+	capture->group = soundGroup;
+}
+
+static void FosterCaptureDetach(FosterCapture* capture)
+{
+	FosterSoundGroup* soundGroup = capture->group;
+	FosterAudioEngine* engine = capture->engine;
+	if (soundGroup == NULL)
+		return;
+
+	if (soundGroup->branch != NULL)
+	{
+		// the branch may still be reading the capture until the current round is over
+		ma_atomic_exchange_ptr(&soundGroup->branch->source, &soundGroup->group);
+		ma_node_detach_output_bus(&soundGroup->group, 0);
+		FosterMixerSync(&engine->mixer);
+	}
+	else
+	{
+		ma_node* destination = soundGroup->parent != NULL ? (ma_node*)&soundGroup->parent->group : ma_engine_get_endpoint(&engine->engine);
+		ma_node_attach_output_bus(&soundGroup->group, 0, destination, 0);
+	}
+
+	ma_allocation_callbacks callbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_OTHER);
+	ma_node_uninit(&capture->node, &callbacks);
+
+	soundGroup->capture = NULL;
+	capture->group = NULL;
+}
+
+// called by the audio thread before rendering, group captures count frames from here
+static void FosterCaptureSync(FosterAudioEngine* engine, ma_uint64 time)
+{
+	ma_spinlock_lock(&engine->captureLock);
+	for (FosterCapture* capture = engine->captures; capture != NULL; capture = capture->next)
+	{
+		if (capture->group != NULL)
+			capture->cursor = time;
+	}
+	ma_spinlock_unlock(&engine->captureLock);
+}
+
+// called by the audio thread after rendering with the final output
+static void FosterCaptureMaster(FosterAudioEngine* engine, const float* frames, ma_uint64 frameCount, ma_uint64 time)
+{
+	ma_spinlock_lock(&engine->captureLock);
+	for (FosterCapture* capture = engine->captures; capture != NULL; capture = capture->next)
+	{
+		if (capture->master)
+			FosterCaptureWrite(capture, frames, (ma_uint32)frameCount, time);
+	}
+	ma_spinlock_unlock(&engine->captureLock);
+}
+
+FosterCapture* FosterAudioEngineStartCapture(FosterAudioEngine* engine, FosterSoundGroup* soundGroup, FosterCaptureDesc desc)
+{
+	if (soundGroup != NULL && soundGroup->capture != NULL)
+	{
+		FosterLogError("Unable to create Capture, the SoundGroup is already being captured");
+		return NULL;
+	}
+
+	FosterCapture* capture = FosterMalloc(&engine->memory, sizeof(FosterCapture), FOSTER_MEMORY_CATEGORY_OTHER);
+	if (capture == NULL)
+	{
+		FosterLogError("Unable to create Capture (Out of Memory)");
+		return NULL;
+	}
+
+	MA_ZERO_OBJECT(capture);
+	capture->engine = engine;
+	capture->master = soundGroup == NULL;
+	capture->format = desc.format;
+	capture->callback = desc.callback;
+	capture->context = desc.context;
+	capture->channels = ma_engine_get_channels(&engine->engine);
+	capture->sampleRate = ma_engine_get_sample_rate(&engine->engine);
+	capture->startTime = desc.startTime;
+	capture->stopTime = desc.stopTime > 0 ? desc.stopTime : ~(ma_uint64)0;
+	capture->cursor = FOSTER_CAPTURE_UNSYNCED;
+
+	if (desc.path != NULL)
+	{
+		size_t length = strlen(desc.path);
+		capture->path = FosterMalloc(&engine->memory, length + 1, FOSTER_MEMORY_CATEGORY_OTHER);
+		if (capture->path != NULL)
+			MA_COPY_MEMORY(capture->path, desc.path, length + 1);
+	}
+
+	ma_allocation_callbacks callbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_OTHER);
+	ma_uint32 bufferFrames = desc.bufferFrames > 0 ? (ma_uint32)desc.bufferFrames : capture->sampleRate;
+
+	if (MA_SUCCESS != ma_pcm_rb_init(ma_format_f32, capture->channels, bufferFrames, NULL, &callbacks, &capture->buffer))
+	{
+		FosterLogError("Unable to create Capture (Out of Memory)");
+		FosterFree(capture->path);
+		FosterFree(capture);
+		return NULL;
+	}
+
+	if (!FosterCaptureOpen(capture))
+	{
+		FosterLogError("Unable to create Capture, failed to open '%s'", capture->path != NULL ? capture->path : "callback");
+		ma_pcm_rb_uninit(&capture->buffer);
+		FosterFree(capture->path);
+		FosterFree(capture);
+		return NULL;
+	}
+
+	if (MA_SUCCESS != ma_semaphore_init(0, &capture->wake) ||
+		MA_SUCCESS != ma_thread_create(&capture->thread, ma_thread_priority_normal, 0, FosterCaptureThread, capture, &callbacks))
+	{
+		FosterLogError("Unable to create Capture (Thread)");
+		ma_semaphore_uninit(&capture->wake);
+		FosterCaptureClose(capture);
+		ma_pcm_rb_uninit(&capture->buffer);
+		FosterFree(capture->path);
+		FosterFree(capture);
+		return NULL;
+	}
+
+	if (soundGroup != NULL)
+	{
+		ma_node_config config = ma_node_config_init();
+		config.vtable = &FosterCaptureVTable;
+		config.pInputChannels = &capture->channels;
+		config.pOutputChannels = &capture->channels;
+
+		if (MA_SUCCESS != ma_node_init(ma_engine_get_node_graph(&engine->engine), &config, &callbacks, &capture->node))
+		{
+			FosterLogError("Unable to create Capture (Node)");
+			FosterCaptureDestroy(capture);
+			return NULL;
+		}
+
+		FosterCaptureAttach(capture, soundGroup);
+	}
+
+	ma_spinlock_lock(&engine->captureLock);
+	capture->next = engine->captures;
+	engine->captures = capture;
+	ma_spinlock_unlock(&engine->captureLock);
+
+	return capture;
+}
+
+void FosterCaptureStop(FosterCapture* capture, uint64_t time)
+{
+	ma_uint64 now = ma_engine_get_time_in_pcm_frames(&capture->engine->engine);
+	ma_atomic_exchange_64(&capture->stopTime, time > now ? time : now);
+}
+
+void FosterCaptureGetStats(FosterCapture* capture, FosterCaptureStats* stats)
+{
+	stats->capturedFrames = ma_atomic_load_64(&capture->capturedFrames);
+	stats->writtenFrames = ma_atomic_load_64(&capture->writtenFrames);
+	stats->droppedBlocks = ma_atomic_load_64(&capture->droppedBlocks);
+	stats->droppedFrames = ma_atomic_load_64(&capture->droppedFrames);
+	stats->failed = ma_atomic_load_32(&capture->failed) != 0;
+}
+
+FosterBool FosterCaptureDestroy(FosterCapture* capture)
+{
+	FosterAudioEngine* engine = capture->engine;
+
+	// once unlinked and detached the audio thread can't reach the capture anymore
+	ma_spinlock_lock(&engine->captureLock);
+	FosterCapture** link = &engine->captures;
+	while (*link != NULL && *link != capture)
+		link = &(*link)->next;
+	if (*link != NULL)
+		*link = capture->next;
+	ma_spinlock_unlock(&engine->captureLock);
+
+	FosterCaptureDetach(capture);
+
+	ma_atomic_exchange_32(&capture->quit, 1);
+	ma_semaphore_release(&capture->wake);
+	ma_thread_wait(&capture->thread);
+	ma_semaphore_uninit(&capture->wake);
+
+	// closing the output can still fail
+	FosterBool written = !capture->failed;
+	ma_pcm_rb_uninit(&capture->buffer);
+	FosterFree(capture->path);
+	FosterFree(capture);
+	return written;
+}
+
+// end Capture
+
+// begin Decoder
+
+/*
+Add your custom backend vtables here. The order in the array defines the order of priority. The
+vtables will be passed in to the resource manager config.
+*/
+static ma_decoding_backend_vtable* pCustomBackendVTables[] =
+{
+	&g_ma_decoding_backend_vtable_qoa,
+	&g_ma_decoding_backend_vtable_libvorbis,
+};
+
+static FosterMemory *FosterDecodeMemory()
+{
+	// decoded data is owned by the caller, so it is accounted outside of any engine
+	FosterMemory *memory = &fstate.memory;
+	if (memory->contexts[0].memory == NULL)
+		FosterMemoryInit(memory, fstate.desc.allocator);
+	return memory;
+}
+
+static ma_result FosterDecoderInit(FosterMemory *memory, const void *data, int length, FosterAudioFormat format, int channels, int sampleRate, ma_decoder *decoder)
+{
+	ma_decoder_config config = ma_decoder_config_init((ma_format)format, channels, sampleRate);
+	config.pCustomBackendUserData = memory;
+	config.ppCustomBackendVTables = pCustomBackendVTables;
+	config.customBackendCount = sizeof(pCustomBackendVTables) / sizeof(pCustomBackendVTables[0]);
+	config.allocationCallbacks = FosterAllocationCallbacks(memory, FOSTER_MEMORY_CATEGORY_DECODED);
+	return ma_decoder_init_memory(data, length, &config, decoder);
+}
+
+// reports the output format and frame count of an initialized decoder
+// formats that can't report their length are scanned once without keeping any frames
+static ma_uint64 FosterDecoderGetInfo(ma_decoder *decoder, FosterAudioFormat *format, int *channels, int *sampleRate)
+{
+	ma_format outFormat;
+	ma_uint32 outChannels, outSampleRate;
+	ma_decoder_get_data_format(decoder, &outFormat, &outChannels, &outSampleRate, NULL, 0);
+	*format = (FosterAudioFormat)outFormat;
+	*channels = (int)outChannels;
+	*sampleRate = (int)outSampleRate;
+
+	ma_uint64 frameCount = 0;
+	if (ma_decoder_get_length_in_pcm_frames(decoder, &frameCount) != MA_SUCCESS || frameCount == 0)
+	{
+		ma_uint8 scratch[MA_DATA_CONVERTER_STACK_BUFFER_SIZE];
+		ma_uint64 scratchFrames = sizeof(scratch) / ma_get_bytes_per_frame(outFormat, outChannels);
+		ma_uint64 read = 0;
+		frameCount = 0;
+		while (ma_decoder_read_pcm_frames(decoder, scratch, scratchFrames, &read) == MA_SUCCESS && read > 0)
+			frameCount += read;
+		ma_decoder_seek_to_pcm_frame(decoder, 0);
+	}
+	return frameCount;
+}
+
+// end Decoder
+
+// begin DecoderPool
+
+// expects decoderPoolLock to be held
+static FosterDecoderPool* FosterDecoderPoolFind(FosterAudioEngine* engine, const char* name)
+{
+	for (FosterDecoderPool* pool = engine->decoderPools; pool != NULL; pool = pool->next)
+	{
+		if (strcmp(pool->name, name) == 0)
+			return pool;
+	}
+	return NULL;
+}
+
+// expects decoderPoolLock to be held
+static FosterDecoderPool* FosterDecoderPoolFindData(FosterAudioEngine* engine, const void* data)
+{
+	for (FosterDecoderPool* pool = engine->decoderPools; pool != NULL; pool = pool->next)
+	{
+		if (pool->data == data)
+			return pool;
+	}
+	return NULL;
+}
+
+// same decoder the resource manager would build for the encoded data, but accounted as ENCODED
+static ma_decoder* FosterDecoderPoolCreateDecoder(FosterDecoderPool* pool)
+{
+	FosterAudioEngine* engine = pool->engine;
+	ma_decoder* decoder = FosterMalloc(&engine->memory, sizeof(ma_decoder), FOSTER_MEMORY_CATEGORY_ENCODED);
+	if (decoder == NULL)
+		return NULL;
+
+	ma_decoder_config config = ma_resource_manager__init_decoder_config(&engine->resourceManager);
+	config.allocationCallbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_ENCODED);
+	if (ma_decoder_init_memory(pool->data, pool->size, &config, decoder) != MA_SUCCESS)
+	{
+		FosterFree(decoder);
+		return NULL;
+	}
+
+	return decoder;
+}
+
+static void FosterDecoderPoolDestroyDecoder(ma_decoder* decoder)
+{
+	ma_decoder_uninit(decoder);
+	FosterFree(decoder);
+}
+
+// expects decoderPoolLock to be held, the pool is freed once neither the registration nor a sound uses it
+static void FosterDecoderPoolDereference(FosterDecoderPool* pool)
+{
+	if (--pool->references > 0)
+		return;
+
+	for (ma_uint32 i = 0; i < pool->idleCount; i++)
+		FosterDecoderPoolDestroyDecoder(pool->idle[i]);
+	FosterFree(pool->idle);
+	FosterFree(pool);
+}
+
+// initializes or releases idle decoders until warmCount of them are ready
+static void FosterDecoderPoolFill(FosterDecoderPool* pool)
+{
+	FosterAudioEngine* engine = pool->engine;
+
+	for (;;)
+	{
+		ma_spinlock_lock(&engine->decoderPoolLock);
+		ma_decoder* release = pool->idleCount > pool->warmCount ? pool->idle[--pool->idleCount] : NULL;
+		ma_bool32 fill = pool->idleCount < pool->warmCount;
+		ma_spinlock_unlock(&engine->decoderPoolLock);
+
+		if (release != NULL)
+		{
+			FosterDecoderPoolDestroyDecoder(release);
+			continue;
+		}
+		if (!fill)
+			break;
+
+		ma_decoder* decoder = FosterDecoderPoolCreateDecoder(pool);
+		if (decoder == NULL)
+		{
+			FosterLogWarn("Unable to warm up a decoder for %s", pool->name);
+			break;
+		}
+
+		ma_spinlock_lock(&engine->decoderPoolLock);
+		pool->idle[pool->idleCount++] = decoder;
+		ma_spinlock_unlock(&engine->decoderPoolLock);
+	}
+}
+
+// takes a rewound decoder from the pool of name, or of the registered data when name is NULL,
+// or initializes a new one when they ran out
+static ma_decoder* FosterDecoderPoolBorrow(FosterAudioEngine* engine, const char* name, const void* data, FosterDecoderPool** borrowedFrom)
+{
+	*borrowedFrom = NULL;
+	if (ma_atomic_load_32(&engine->decoderPoolCount) == 0)
+		return NULL;
+
+	ma_spinlock_lock(&engine->decoderPoolLock);
+	FosterDecoderPool* pool = name != NULL ? FosterDecoderPoolFind(engine, name) : FosterDecoderPoolFindData(engine, data);
+	ma_decoder* decoder = NULL;
+	if (pool != NULL)
+	{
+		pool->references++;
+		if (pool->idleCount > 0)
+			decoder = pool->idle[--pool->idleCount];
+	}
+	ma_spinlock_unlock(&engine->decoderPoolLock);
+
+	if (pool == NULL)
+		return NULL;
+
+	if (decoder == NULL)
+	{
+		decoder = FosterDecoderPoolCreateDecoder(pool);
+		if (decoder == NULL)
+		{
+			ma_spinlock_lock(&engine->decoderPoolLock);
+			FosterDecoderPoolDereference(pool);
+			ma_spinlock_unlock(&engine->decoderPoolLock);
+			return NULL;
+		}
+	}
+
+	*borrowedFrom = pool;
+	return decoder;
+}
+
+// rewinds a decoder once its sound is gone and keeps it if the pool still wants it
+static void FosterDecoderPoolReturn(FosterAudioEngine* engine, FosterDecoderPool* pool, ma_decoder* decoder)
+{
+	ma_data_source_set_looping(decoder, MA_FALSE);
+	ma_data_source_set_range_in_pcm_frames(decoder, 0, ~(ma_uint64)0);
+	ma_data_source_set_loop_point_in_pcm_frames(decoder, 0, ~(ma_uint64)0);
+	ma_bool32 rewound = ma_decoder_seek_to_pcm_frame(decoder, 0) == MA_SUCCESS;
+
+	ma_spinlock_lock(&engine->decoderPoolLock);
+	if (rewound && pool->idleCount < pool->warmCount)
+	{
+		pool->idle[pool->idleCount++] = decoder;
+		decoder = NULL;
+	}
+	FosterDecoderPoolDereference(pool);
+	ma_spinlock_unlock(&engine->decoderPoolLock);
+
+	if (decoder != NULL)
+		FosterDecoderPoolDestroyDecoder(decoder);
+}
+
+static void FosterDecoderPoolRemove(FosterAudioEngine* engine, const char* name)
+{
+	ma_spinlock_lock(&engine->decoderPoolLock);
+	FosterDecoderPool* pool = NULL;
+	for (FosterDecoderPool** link = &engine->decoderPools; *link != NULL; link = &(*link)->next)
+	{
+		if (strcmp((*link)->name, name) == 0)
+		{
+			pool = *link;
+			*link = pool->next;
+			ma_atomic_fetch_sub_32(&engine->decoderPoolCount, 1);
+			break;
+		}
+	}
+
+	// decoders still borrowed are released when their sounds are destroyed
+	if (pool != NULL)
+	{
+		pool->warmCount = 0;
+		FosterDecoderPoolDereference(pool);
+	}
+	ma_spinlock_unlock(&engine->decoderPoolLock);
+}
+
+static void FosterDecoderPoolClear(FosterAudioEngine* engine)
+{
+	while (engine->decoderPools != NULL)
+		FosterDecoderPoolRemove(engine, engine->decoderPools->name);
+}
+
+// end DecoderPool
+
+// begin TranscodeCache
+
+// part of every cache key along with the miniaudio version, bump when a transcode would come out different
+#define FOSTER_TRANSCODE_REVISION 1
+#define FOSTER_TRANSCODE_QUEUE_CAPACITY 1024
+#define FOSTER_TRANSCODE_BLOCK_SAMPLES 4096
+#define FOSTER_TRANSCODE_HASH_SEED 14695981039346656037ULL
+
+// what the key of a source that doesn't need transcoding maps to
+#define FOSTER_TRANSCODE_NONE "none"
+
+// owns a copy of the source, path is the cache file and temp is where it's written until complete
+// jobs with a source file read it first and write its key file at path, path then becomes the cache file
+struct FosterTranscodeJob
+{
+	FosterTranscodeJob* next;
+	FosterAudioEngine* engine;
+	void* data;
+	size_t length;
+	char* source;
+	char* temp;
+	size_t tempCapacity;
+	char path[];
+};
+
+// QOA and WAV already decode about as fast as their transcode would
+static FosterBool FosterTranscodeNeeded(const void* data, size_t length)
+{
+	return length >= 4 && memcmp(data, "qoaf", 4) != 0 && memcmp(data, "RIFF", 4) != 0;
+}
+
+// FNV-1a continuing from hash, the length is part of the key as well
+static ma_uint64 FosterTranscodeHash(ma_uint64 hash, const void* data, size_t length)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < length; i++)
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	return hash;
+}
+
+// returns the length of the cache file path for hash, which is only written when it fits in capacity
+static size_t FosterTranscodePath(FosterAudioEngine* engine, ma_uint64 hash, ma_uint64 length, const char* suffix, char* path, size_t capacity)
+{
+	FosterTranscodeCache* cache = &engine->transcode;
+	int count = snprintf(path, capacity, "%s/%016llx-%llx-ma%s-r%d-%u.%s%s",
+		cache->path,
+		(unsigned long long)hash,
+		(unsigned long long)length,
+		MA_VERSION_STRING,
+		FOSTER_TRANSCODE_REVISION,
+		ma_engine_get_sample_rate(&engine->engine),
+		cache->format == FOSTER_TRANSCODE_FORMAT_QOA ? "qoa" : "wav",
+		suffix);
+	return count > 0 ? (size_t)count : 0;
+}
+
+static char* FosterTranscodeAllocPath(FosterAudioEngine* engine, ma_uint64 hash, ma_uint64 length, const char* suffix)
+{
+	size_t capacity = FosterTranscodePath(engine, hash, length, suffix, NULL, 0) + 1;
+	char* path = FosterMalloc(&engine->memory, capacity, FOSTER_MEMORY_CATEGORY_OTHER);
+	if (path != NULL)
+		FosterTranscodePath(engine, hash, length, suffix, path, capacity);
+	return path;
+}
+
+// returns the cache file path of data, which the caller frees
+static char* FosterTranscodeCachePath(FosterAudioEngine* engine, const void* data, size_t length)
+{
+	return FosterTranscodeAllocPath(engine, FosterTranscodeHash(FOSTER_TRANSCODE_HASH_SEED, data, length), length, "");
+}
+
+// returns the key file path of a source file as it is on disk, which the caller frees
+// the key file holds the name of the cache file, so finding it never reads the source
+// size and last write time of a UTF-8 path, the time as finely as the platform keeps it
+static FosterBool FosterTranscodeStat(FosterMemory* memory, const char* path, ma_uint64* size, ma_uint64* modified)
+{
+#ifdef _WIN32
+	int length = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
+	wchar_t* wide = length > 0 ? FosterMalloc(memory, length * sizeof(wchar_t), FOSTER_MEMORY_CATEGORY_OTHER) : NULL;
+	if (wide == NULL)
+		return false;
+
+	WIN32_FILE_ATTRIBUTE_DATA info;
+	BOOL found =
+		MultiByteToWideChar(CP_UTF8, 0, path, -1, wide, length) != 0 &&
+		GetFileAttributesExW(wide, GetFileExInfoStandard, &info);
+	FosterFree(wide);
+	if (!found)
+		return false;
+
+	*size = ((ma_uint64)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+	*modified = ((ma_uint64)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+#else
+	(void)memory;
+	struct stat info;
+	if (stat(path, &info) != 0)
+		return false;
+
+	*size = (ma_uint64)info.st_size;
+#if defined(__APPLE__)
+	*modified = (ma_uint64)info.st_mtimespec.tv_sec * 1000000000 + (ma_uint64)info.st_mtimespec.tv_nsec;
+#else
+	*modified = (ma_uint64)info.st_mtim.tv_sec * 1000000000 + (ma_uint64)info.st_mtim.tv_nsec;
+#endif
+#endif
+	return true;
+}
+
+static char* FosterTranscodeKeyPath(FosterAudioEngine* engine, const char* source, ma_uint64 size, ma_uint64 modified)
+{
+	ma_uint64 hash = FosterTranscodeHash(FOSTER_TRANSCODE_HASH_SEED, source, strlen(source));
+	hash = FosterTranscodeHash(hash, &modified, sizeof(modified));
+	return FosterTranscodeAllocPath(engine, hash, size, ".key");
+}
+
+static FosterBool FosterTranscodeExists(const char* path)
+{
+	FILE* file;
+	if (ma_fopen(&file, path, "rb") != MA_SUCCESS)
+		return false;
+	fclose(file);
+	return true;
+}
+
+static void* FosterTranscodeReadFile(FosterMemory* memory, const char* path, size_t* length, FosterMemoryCategory category)
+{
+	FILE* file;
+	if (ma_fopen(&file, path, "rb") != MA_SUCCESS)
+		return NULL;
+
+	void* data = NULL;
+	long size = -1;
+	if (fseek(file, 0, SEEK_END) == 0)
+		size = ftell(file);
+	if (size > 0 && fseek(file, 0, SEEK_SET) == 0)
+		data = FosterMalloc(memory, (size_t)size, category);
+	if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size)
+	{
+		FosterFree(data);
+		data = NULL;
+	}
+	fclose(file);
+
+	*length = data != NULL ? (size_t)size : 0;
+	return data;
+}
+
+// decodes the source at the engine rate into the temp file
+static FosterBool FosterTranscodeWrite(FosterTranscodeJob* job)
+{
+	FosterAudioEngine* engine = job->engine;
+	FosterTranscodeCache* cache = &engine->transcode;
+	ma_uint32 sampleRate = ma_engine_get_sample_rate(&engine->engine);
+
+	ma_decoder decoder;
+	if (FosterDecoderInit(&engine->memory, job->data, (int)job->length, FOSTER_AUDIO_FORMAT_F32, 0, (int)sampleRate, &decoder) != MA_SUCCESS)
+		return false;
+
+	ma_uint32 channels;
+	ma_decoder_get_data_format(&decoder, NULL, &channels, NULL, NULL, 0);
+
+	FosterQoaWriter* qoa = NULL;
+	ma_encoder wav;
+	FosterBool success;
+	if (cache->format == FOSTER_TRANSCODE_FORMAT_QOA)
+	{
+		qoa = FosterQoaWriterOpen(&engine->memory, job->temp, channels, sampleRate);
+		success = qoa != NULL;
+	}
+	else
+	{
+		ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, channels, sampleRate);
+		config.allocationCallbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_OTHER);
+		success = ma_encoder_init_file(job->temp, &config, &wav) == MA_SUCCESS;
+	}
+
+	float frames[FOSTER_TRANSCODE_BLOCK_SAMPLES];
+	ma_uint64 capacity = FOSTER_TRANSCODE_BLOCK_SAMPLES / (channels > 0 ? channels : 1);
+	FosterBool opened = success;
+	while (success)
+	{
+		// engines being destroyed don't wait for their transcodes
+		if (ma_atomic_load_32(&cache->cancelled))
+		{
+			success = false;
+			break;
+		}
+
+		ma_uint64 read = 0;
+		ma_result result = ma_decoder_read_pcm_frames(&decoder, frames, capacity, &read);
+		if (read > 0)
+		{
+			if (qoa != NULL)
+				success = FosterQoaWriterWrite(qoa, frames, (ma_uint32)read);
+			else if (ma_encoder_write_pcm_frames(&wav, frames, read, NULL) != MA_SUCCESS)
+				success = false;
+		}
+
+		if (result == MA_AT_END || (result == MA_SUCCESS && read == 0))
+			break;
+		if (result != MA_SUCCESS)
+			success = false;
+	}
+
+	if (qoa != NULL && !FosterQoaWriterClose(qoa))
+		success = false;
+	else if (qoa == NULL && opened)
+		ma_encoder_uninit(&wav);
+
+	ma_decoder_uninit(&decoder);
+	return success;
+}
+
+// expects the cache lock to be held
+static FosterTranscodeJob* FosterTranscodeFind(FosterTranscodeCache* cache, const char* path)
+{
+	FosterTranscodeJob* queued = cache->jobs;
+	while (queued != NULL && strcmp(queued->path, path) != 0)
+		queued = queued->next;
+	return queued;
+}
+
+static FosterBool FosterTranscodeQueued(FosterTranscodeCache* cache, const char* path)
+{
+	ma_spinlock_lock(&cache->lock);
+	FosterBool queued = FosterTranscodeFind(cache, path) != NULL;
+	ma_spinlock_unlock(&cache->lock);
+	return queued;
+}
+
+// writes the cache file name the key maps to, through the temp file so it only ever appears complete
+static void FosterTranscodeWriteKey(FosterTranscodeJob* transcode, const char* name)
+{
+	FILE* file;
+	if (ma_fopen(&file, transcode->temp, "wb") != MA_SUCCESS)
+		return;
+
+	FosterBool written = fputs(name, file) >= 0;
+	if (fclose(file) != 0 || !written || rename(transcode->temp, transcode->path) != 0)
+		remove(transcode->temp);
+}
+
+// reads and hashes the source of a job, records it under its key and turns the job into its transcode
+// returns false when there's nothing left to transcode, because it isn't needed, cached or queued by another job
+static FosterBool FosterTranscodeIndex(FosterTranscodeJob* transcode)
+{
+	FosterAudioEngine* engine = transcode->engine;
+	FosterTranscodeCache* cache = &engine->transcode;
+
+	transcode->data = FosterTranscodeReadFile(&engine->memory, transcode->source, &transcode->length, FOSTER_MEMORY_CATEGORY_OTHER);
+	if (transcode->data == NULL)
+		return false;
+
+	if (!FosterTranscodeNeeded(transcode->data, transcode->length))
+	{
+		FosterTranscodeWriteKey(transcode, FOSTER_TRANSCODE_NONE);
+		return false;
+	}
+
+	char* path = FosterTranscodeCachePath(engine, transcode->data, transcode->length);
+	if (path == NULL)
+		return false;
+
+	FosterTranscodeWriteKey(transcode, path + strlen(cache->path) + 1);
+
+	// the cache path is as long as the key path without its suffix, so it fits where the key path was
+	FosterBool claimed = false;
+	if (!FosterTranscodeExists(path))
+	{
+		ma_spinlock_lock(&cache->lock);
+		claimed = FosterTranscodeFind(cache, path) == NULL;
+		if (claimed)
+		{
+			MA_COPY_MEMORY(transcode->path, path, strlen(path) + 1);
+			snprintf(transcode->temp, transcode->tempCapacity, "%s.%p.tmp", path, (void*)transcode);
+		}
+		ma_spinlock_unlock(&cache->lock);
+	}
+
+	FosterFree(path);
+	return claimed;
+}
+
+static void FosterTranscodeFinish(FosterTranscodeJob* transcode)
+{
+	FosterTranscodeCache* cache = &transcode->engine->transcode;
+
+	ma_spinlock_lock(&cache->lock);
+	for (FosterTranscodeJob** link = &cache->jobs; *link != NULL; link = &(*link)->next)
+	{
+		if (*link == transcode)
+		{
+			*link = transcode->next;
+			break;
+		}
+	}
+	ma_spinlock_unlock(&cache->lock);
+
+	FosterFree(transcode->data);
+	FosterFree(transcode);
+	ma_atomic_fetch_sub_32(&cache->pending, 1);
+}
+
+static ma_result FosterTranscodeProcess(ma_job* job)
+{
+	FosterTranscodeJob* transcode = (FosterTranscodeJob*)job->data.custom.data0;
+	FosterTranscodeCache* cache = &transcode->engine->transcode;
+
+	if (!ma_atomic_load_32(&cache->cancelled) && (transcode->source == NULL || FosterTranscodeIndex(transcode)))
+	{
+		// the cache file only ever appears complete, another engine may have written the same one first
+		if (FosterTranscodeWrite(transcode) && rename(transcode->temp, transcode->path) == 0)
+		{
+			FosterLogInfo("Transcoded '%s'", transcode->path);
+		}
+		else
+		{
+			remove(transcode->temp);
+			if (!ma_atomic_load_32(&cache->cancelled))
+				FosterLogWarn("Unable to transcode '%s'", transcode->path);
+		}
+	}
+
+	FosterTranscodeFinish(transcode);
+	return MA_SUCCESS;
+}
+
+static ma_thread_result MA_THREADCALL FosterTranscodeThread(void* userData)
+{
+	ma_job_queue* queue = (ma_job_queue*)userData;
+
+	for (;;)
+	{
+		ma_job job;
+		if (MA_SUCCESS != ma_job_queue_next(queue, &job) || job.toc.breakup.code == MA_JOB_TYPE_QUIT)
+			break;
+
+		ma_job_process(&job);
+	}
+
+	return (ma_thread_result)0;
+}
+
+// queues the transcode of data into the cache file at path, takes ownership of data
+// with a source file instead of data, path is its key file and the source is read on the transcode thread
+static void FosterTranscodeQueue(FosterAudioEngine* engine, void* data, size_t length, const char* source, const char* path)
+{
+	FosterTranscodeCache* cache = &engine->transcode;
+	size_t pathLength = strlen(path);
+	size_t tempCapacity = pathLength + 32;
+	size_t sourceLength = source != NULL ? strlen(source) + 1 : 0;
+	FosterTranscodeJob* transcode = FosterMalloc(&engine->memory, sizeof(FosterTranscodeJob) + pathLength + 1 + tempCapacity + sourceLength, FOSTER_MEMORY_CATEGORY_OTHER);
+	if (transcode == NULL)
+	{
+		FosterFree(data);
+		return;
+	}
+
+	transcode->engine = engine;
+	transcode->data = data;
+	transcode->length = length;
+	MA_COPY_MEMORY(transcode->path, path, pathLength + 1);
+	transcode->temp = transcode->path + pathLength + 1;
+	transcode->tempCapacity = tempCapacity;
+	snprintf(transcode->temp, tempCapacity, "%s.%p.tmp", path, (void*)transcode);
+	transcode->source = NULL;
+	if (source != NULL)
+	{
+		transcode->source = transcode->temp + tempCapacity;
+		MA_COPY_MEMORY(transcode->source, source, sourceLength);
+	}
+
+	// an asset loaded again before its transcode finished is left to the one already queued
+	ma_spinlock_lock(&cache->lock);
+	FosterTranscodeJob* queued = FosterTranscodeFind(cache, path);
+	if (queued == NULL)
+	{
+		transcode->next = cache->jobs;
+		cache->jobs = transcode;
+		ma_atomic_fetch_add_32(&cache->pending, 1);
+	}
+	ma_spinlock_unlock(&cache->lock);
+
+	if (queued != NULL)
+	{
+		FosterFree(data);
+		FosterFree(transcode);
+		return;
+	}
+
+	// a full queue only means this asset is transcoded on a later load
+	ma_job job = ma_job_init(MA_JOB_TYPE_CUSTOM);
+	job.data.custom.proc = FosterTranscodeProcess;
+	job.data.custom.data0 = (ma_uintptr)transcode;
+	if (ma_job_queue_post(&cache->queue, &job) != MA_SUCCESS)
+		FosterTranscodeFinish(transcode);
+}
+
+// returns the cached transcode of data allocated under category, or queues one and returns NULL
+static void* FosterTranscodeLoad(FosterAudioEngine* engine, const void* data, size_t length, size_t* cachedLength, FosterMemoryCategory category)
+{
+	if (engine->transcode.path == NULL || !FosterTranscodeNeeded(data, length))
+		return NULL;
+
+	char* path = FosterTranscodeCachePath(engine, data, length);
+	if (path == NULL)
+		return NULL;
+
+	void* cached = FosterTranscodeReadFile(&engine->memory, path, cachedLength, category);
+	if (cached == NULL)
+	{
+		void* copy = FosterMalloc(&engine->memory, length, FOSTER_MEMORY_CATEGORY_OTHER);
+		if (copy != NULL)
+		{
+			MA_COPY_MEMORY(copy, data, length);
+			FosterTranscodeQueue(engine, copy, length, NULL, path);
+		}
+	}
+
+	FosterFree(path);
+	return cached;
+}
+
+static FosterBool FosterTranscodeInit(FosterAudioEngine* engine, const char* path, FosterTranscodeFormat format)
+{
+	FosterTranscodeCache* cache = &engine->transcode;
+	if (path == NULL || path[0] == '\0' || format == FOSTER_TRANSCODE_FORMAT_NONE)
+		return true;
+
+	size_t pathLength = strlen(path);
+	while (pathLength > 1 && (path[pathLength - 1] == '/' || path[pathLength - 1] == '\\'))
+		pathLength--;
+
+	cache->path = FosterMalloc(&engine->memory, pathLength + 1, FOSTER_MEMORY_CATEGORY_OTHER);
+	if (cache->path == NULL)
+		return false;
+
+	MA_COPY_MEMORY(cache->path, path, pathLength);
+	cache->path[pathLength] = '\0';
+	cache->format = format;
+
+	ma_allocation_callbacks callbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_OTHER);
+	ma_job_queue_config config = ma_job_queue_config_init(0, FOSTER_TRANSCODE_QUEUE_CAPACITY);
+	if (MA_SUCCESS != ma_job_queue_init(&config, &callbacks, &cache->queue))
+	{
+		FosterFree(cache->path);
+		cache->path = NULL;
+		return false;
+	}
+
+	if (MA_SUCCESS != ma_thread_create(&cache->thread, ma_thread_priority_low, 0, FosterTranscodeThread, &cache->queue, &callbacks))
+	{
+		ma_job_queue_uninit(&cache->queue, &callbacks);
+		FosterFree(cache->path);
+		cache->path = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+// queued transcodes are dropped, the partially written one is deleted
+static void FosterTranscodeShutdown(FosterAudioEngine* engine)
+{
+	FosterTranscodeCache* cache = &engine->transcode;
+	if (cache->path == NULL)
+		return;
+
+	ma_atomic_exchange_32(&cache->cancelled, 1);
+
+	// the queue drains quickly once cancelled, so a full one frees up for the quit
+	ma_job quit = ma_job_init(MA_JOB_TYPE_QUIT);
+	while (ma_job_queue_post(&cache->queue, &quit) != MA_SUCCESS)
+		ma_sleep(1);
+	ma_thread_wait(&cache->thread);
+
+	ma_allocation_callbacks callbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_OTHER);
+	ma_job_queue_uninit(&cache->queue, &callbacks);
+	FosterFree(cache->path);
+	cache->path = NULL;
+}
+
+// end TranscodeCache
+
+// begin AudioEngine
+
+static FosterMemoryCategory FosterJobCategory(const ma_job* job)
+{
+	switch (job->toc.breakup.code)
+	{
+		case MA_JOB_TYPE_RESOURCE_MANAGER_LOAD_DATA_BUFFER_NODE:
+			return FOSTER_CHECK(job->data.resourceManager.loadDataBufferNode.flags, MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_DECODE) ?
+				FOSTER_MEMORY_CATEGORY_DECODED : FOSTER_MEMORY_CATEGORY_ENCODED;
+		case MA_JOB_TYPE_RESOURCE_MANAGER_PAGE_DATA_BUFFER_NODE:
+			return FOSTER_MEMORY_CATEGORY_DECODED;
+		case MA_JOB_TYPE_RESOURCE_MANAGER_LOAD_DATA_BUFFER:
+			return FOSTER_MEMORY_CATEGORY_ENCODED;
+		case MA_JOB_TYPE_RESOURCE_MANAGER_LOAD_DATA_STREAM:
+		case MA_JOB_TYPE_RESOURCE_MANAGER_PAGE_DATA_STREAM:
+		case MA_JOB_TYPE_RESOURCE_MANAGER_SEEK_DATA_STREAM:
+			return FOSTER_MEMORY_CATEGORY_STREAMING;
+		default:
+			return FOSTER_MEMORY_CATEGORY_OTHER;
+	}
+}
+
+// same as miniaudio's own job thread, but tags allocations with what the job is doing
+static ma_thread_result MA_THREADCALL FosterJobThread(void* userData)
+{
+	ma_resource_manager* resourceManager = (ma_resource_manager*)userData;
+
+	for (;;)
+	{
+		ma_job job;
+		if (MA_SUCCESS != ma_resource_manager_next_job(resourceManager, &job))
+			break;
+
+		if (job.toc.breakup.code == MA_JOB_TYPE_QUIT)
+			break;
+
+		fosterThreadCategory = FosterJobCategory(&job);
+		ma_job_process(&job);
+		fosterThreadCategory = FOSTER_MEMORY_CATEGORY_OTHER;
+	}
+
+	return (ma_thread_result)0;
+}
+
+static void FosterResourceManagerShutdown(FosterAudioEngine* engine, int jobThreadCount)
+{
+	ma_resource_manager_post_job_quit(&engine->resourceManager);
+	for (int i = 0; i < jobThreadCount; i++)
+		ma_thread_wait(&engine->jobThreads[i]);
+	ma_resource_manager_uninit(&engine->resourceManager);
+}
+
+static void FosterAudioEngineFree(FosterAudioEngine* engine)
+{
+	FosterAllocator allocator = engine->desc.allocator;
+	FosterMemoryFreePools(&engine->memory);
+	FosterRawFree(&allocator, engine);
+}
+
+// renders the next frames of the engine, capture timing is resolved here on the audio thread
+static void FosterAudioEngineRead(FosterAudioEngine* engine, float* frames, ma_uint64 frameCount, ma_uint64* framesRead)
+{
+	ma_uint64 time = ma_engine_get_time_in_pcm_frames(&engine->engine);
+	ma_uint64 totalFramesRead = 0;
+
+	FosterCaptureSync(engine, time);
+	FosterSpatialBatchUpdate(engine);
+	FosterIdleUpdate(engine, frameCount);
+	FosterMixerRead(engine, frames, frameCount, &totalFramesRead);
+	FosterCaptureMaster(engine, frames, totalFramesRead, time);
+
+	if (framesRead != NULL)
+		*framesRead = totalFramesRead;
+}
+
+static void FosterAudioEngineDataCallback(ma_device* device, void* framesOut, const void* framesIn, ma_uint32 frameCount)
+{
+	(void)framesIn;
+	FosterAudioEngineRead((FosterAudioEngine*)device->pUserData, (float*)framesOut, frameCount, NULL);
+}
+
+FosterAudioEngine* FosterAudioEngineCreate(FosterDesc desc)
+{
+	// logging is process wide, the first engine providing callbacks configures it
+	if (fstate.desc.onLogInfo == NULL && fstate.desc.onLogWarn == NULL && fstate.desc.onLogError == NULL)
+		fstate.desc = desc;
+
+	if (!FosterAllocatorValid(&desc.allocator))
+	{
+		FosterLogError("Unable to create Audio Engine (Allocator needs both onMalloc and onFree)");
+		return NULL;
+	}
+
+	// the engine itself can't be tracked by its own memory until it exists
+	FosterAudioEngine* engine = FosterRawMalloc(&desc.allocator, sizeof(FosterAudioEngine));
+	if (engine == NULL)
+	{
+		FosterLogError("Unable to create Audio Engine (Out of Memory)");
+		return NULL;
+	}
+
+	MA_ZERO_OBJECT(engine);
+	engine->desc = desc;
+	engine->desc.transcodeCachePath = NULL;
+	FosterMemoryInit(&engine->memory, desc.allocator);
+	FosterMemoryTrackAllocation(&engine->memory, FOSTER_MEMORY_CATEGORY_OTHER, (ma_int64)sizeof(FosterAudioEngine));
+	FosterFinishedQueueInit(&engine->finished);
+
+	if (!FosterMemoryInitPools(&engine->memory, desc.voicePoolCapacity, desc.decoderPoolCapacity))
+	{
+		FosterLogError("Unable to create Audio Engine (Out of Memory)");
+		FosterRawFree(&desc.allocator, engine);
+		return NULL;
+	}
+
+	ma_resource_manager_config resourceManagerConfig;
+	ma_engine_config engineConfig;
+
+	/* Using custom decoding backends requires a resource manager. */
+	resourceManagerConfig = ma_resource_manager_config_init();
+	resourceManagerConfig.allocationCallbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_THREAD);
+	resourceManagerConfig.jobThreadCount = 0; /* We run our own job threads so allocations can be categorized. */
+	resourceManagerConfig.ppCustomDecodingBackendVTables = pCustomBackendVTables;
+	resourceManagerConfig.customDecodingBackendCount = sizeof(pCustomBackendVTables) / sizeof(pCustomBackendVTables[0]);
+	resourceManagerConfig.pCustomDecodingBackendUserData = &engine->memory;  /* <-- This will be passed in to the pUserData parameter of each function in the decoding backend vtables. */
+
+	if (MA_SUCCESS != ma_resource_manager_init(&resourceManagerConfig, &engine->resourceManager)) {
+		FosterLogError("Unable to create Audio Engine (Resource Manager)");
+		FosterAudioEngineFree(engine);
+		return NULL;
+	}
+
+	for (int i = 0; i < FOSTER_JOB_THREAD_COUNT; i++)
+	{
+		if (MA_SUCCESS != ma_thread_create(&engine->jobThreads[i], ma_thread_priority_normal, 0, FosterJobThread, &engine->resourceManager, &resourceManagerConfig.allocationCallbacks))
+		{
+			FosterLogError("Unable to create Audio Engine (Job Thread)");
+			FosterResourceManagerShutdown(engine, i);
+			FosterAudioEngineFree(engine);
+			return NULL;
+		}
+	}
+
+	/* Once we have a resource manager we can create the engine. */
+	engineConfig = ma_engine_config_init();
+	engineConfig.pResourceManager = &engine->resourceManager;
+	engineConfig.allocationCallbacks = FosterAllocationCallbacks(&engine->memory, FOSTER_MEMORY_CATEGORY_DSP);
+	engineConfig.channels = desc.channels > 0 ? (ma_uint32)desc.channels : 0;
+	engineConfig.sampleRate = desc.sampleRate > 0 ? (ma_uint32)desc.sampleRate : 0;
+
+	/* Route the device through our own read so groups can be mixed in parallel and captured. */
+	engineConfig.dataCallback = FosterAudioEngineDataCallback;
+
+	/* Device-less engines are mixed on demand with FosterAudioEngineRender and need an explicit format. */
+	if (desc.noDevice)
+	{
+		engineConfig.noDevice = MA_TRUE;
+		if (engineConfig.channels == 0)
+			engineConfig.channels = 2;
+		if (engineConfig.sampleRate == 0)
+			engineConfig.sampleRate = 48000;
+	}
+
+	if (MA_SUCCESS != ma_engine_init(&engineConfig, &engine->engine))
+	{
+		FosterLogError("Unable to create Audio Engine");
+		FosterResourceManagerShutdown(engine, FOSTER_JOB_THREAD_COUNT);
+		FosterAudioEngineFree(engine);
+		return NULL;
+	}
+
+	if (!FosterMixerInit(engine, desc.mixerThreadCount))
+	{
+		ma_engine_uninit(&engine->engine);
+		FosterResourceManagerShutdown(engine, FOSTER_JOB_THREAD_COUNT);
+		FosterAudioEngineFree(engine);
+		return NULL;
+	}
+
+	if (!FosterTranscodeInit(engine, desc.transcodeCachePath, desc.transcodeFormat))
+		FosterLogWarn("Unable to start the transcode cache");
+
+	engine->spatial.enabled = desc.batchSpatialization;
+	engine->spatial.channels = ma_engine_get_channels(&engine->engine);
+	engine->idle.enabled = desc.skipSilentNodes;
+	engine->idle.threshold = desc.silenceThreshold;
+
+	return engine;
+}
+
+void FosterAudioEngineDestroy(FosterAudioEngine* engine)
+{
+	if (engine == NULL)
+		return;
+
+	while (engine->captures != NULL)
+		FosterCaptureDestroy(engine->captures);
+
+	ma_engine_uninit(&engine->engine);
+	FosterMixerShutdown(engine);
+	FosterFree(engine->spatial.block);
+	FosterFree(engine->idle.groups.items);
+	FosterFree(engine->idle.voices.items);
+	FosterFree(engine->snapshots.live);
+	FosterDecoderPoolClear(engine);
+	FosterTranscodeShutdown(engine);
+	FosterResourceManagerShutdown(engine, FOSTER_JOB_THREAD_COUNT);
+	FosterRegistryClear(&engine->memory);
+	FosterAudioEngineFree(engine);
+}
+
+uint64_t FosterAudioEngineRender(FosterAudioEngine* engine, float* frames, uint64_t frameCount)
+{
+	ma_uint64 framesRead = 0;
+	FosterAudioEngineRead(engine, frames, frameCount, &framesRead);
+	return framesRead;
+}
+
+float FosterAudioEngineGetVolume(FosterAudioEngine* engine)
+{
+	return ma_engine_get_volume(&engine->engine);
+}
+
+void FosterAudioEngineSetVolume(FosterAudioEngine* engine, float value)
+{
+	ma_engine_set_volume(&engine->engine, value);
+}
+
+int FosterAudioEngineGetChannels(FosterAudioEngine* engine)
+{
+	return ma_engine_get_channels(&engine->engine);
+}
+
+int FosterAudioEngineGetSampleRate(FosterAudioEngine* engine)
+{
+	return ma_engine_get_sample_rate(&engine->engine);
+}
+
+uint64_t FosterAudioEngineGetTimePcmFrames(FosterAudioEngine* engine)
+{
+	return ma_engine_get_time_in_pcm_frames(&engine->engine);
+}
+
+void FosterAudioEngineSetTimePcmFrames(FosterAudioEngine* engine, uint64_t value)
+{
+	ma_engine_set_time_in_pcm_frames(&engine->engine, value);
+}
+
+int FosterAudioEngineGetListenerCount(FosterAudioEngine* engine)
+{
+	return ma_engine_get_listener_count(&engine->engine);
+}
+
+void FosterAudioEngineGetMemoryStats(FosterAudioEngine* engine, FosterMemoryStats* stats)
+{
+	FosterMemory* memory = &engine->memory;
+	for (int i = 0; i < FOSTER_MEMORY_CATEGORY_COUNT; i++)
+		stats->categoryBytes[i] = ma_atomic_load_64(&memory->categoryBytes[i]);
+	stats->allocatedBytes = ma_atomic_load_64(&memory->allocatedBytes);
+	stats->peakAllocatedBytes = ma_atomic_load_64(&memory->peakAllocatedBytes);
+	stats->allocationCount = ma_atomic_load_64(&memory->allocationCount);
+}
+
+void FosterAudioEngineGetIdleStats(FosterAudioEngine* engine, FosterIdleStats* stats)
+{
+	FosterIdle* idle = &engine->idle;
+	stats->sleepingGroups = (int)ma_atomic_load_32(&idle->sleepingGroups);
+	stats->sleepingSounds = (int)ma_atomic_load_32(&idle->sleepingSounds);
+	stats->skippedNodes = (int)ma_atomic_load_32(&idle->skippedNodes);
+	stats->totalSkippedNodes = ma_atomic_load_64(&idle->totalSkippedNodes);
+	stats->callbacks = ma_atomic_load_64(&idle->callbacks);
+}
+
+// tracks a registration and takes a reference on its data buffer node for FosterSoundCreateFromData
+static FosterRegisteredData* FosterAudioEngineTrackData(FosterAudioEngine* engine, const char *name, const void *data, size_t size, FosterMemoryCategory category, void *owned)
+{
+	ma_resource_manager_data_buffer_node* node;
+	if (ma_resource_manager_data_buffer_node_acquire(&engine->resourceManager, NULL, NULL, ma_hash_string_32(name), 0, NULL, NULL, NULL, &node) != MA_SUCCESS)
+		return NULL;
+
+	FosterRegisteredData* registered = FosterRegistryAdd(&engine->memory, name, data, size, category, owned);
+	if (registered == NULL)
+	{
+		ma_resource_manager_data_buffer_node_unacquire(&engine->resourceManager, node, NULL, NULL);
+		return NULL;
+	}
+
+	// numbered like voices and groups, so snapshots never mistake a later registration at the same address for it
+	registered->engine = engine;
+	registered->node = node;
+	registered->serial = ma_atomic_fetch_add_64(&engine->snapshots.nextSerial, 1) + 1;
+	return registered;
+}
+
+FosterRegisteredData* FosterAudioEngineRegisterEncodedData(FosterAudioEngine* engine, const char *name, void *data, int length)
+{
+	FosterRegisteredData* registered = NULL;
+
+	// a WAV transcode would multiply the size of data meant to stay compressed
+	if (engine->transcode.format == FOSTER_TRANSCODE_FORMAT_QOA)
+	{
+		size_t cachedLength = 0;
+		void* cached = FosterTranscodeLoad(engine, data, (size_t)length, &cachedLength, FOSTER_MEMORY_CATEGORY_ENCODED);
+		if (cached != NULL)
+		{
+			fosterThreadCategory = FOSTER_MEMORY_CATEGORY_ENCODED;
+			if (MA_SUCCESS != ma_resource_manager_register_encoded_data(&engine->resourceManager, name, cached, cachedLength))
+				FosterFree(cached);
+			else if ((registered = FosterAudioEngineTrackData(engine, name, cached, cachedLength, FOSTER_MEMORY_CATEGORY_ENCODED, cached)) == NULL)
+			{
+				ma_resource_manager_unregister_data(&engine->resourceManager, name);
+				FosterFree(cached);
+			}
+			fosterThreadCategory = FOSTER_MEMORY_CATEGORY_OTHER;
+			return registered;
+		}
+	}
+
+	fosterThreadCategory = FOSTER_MEMORY_CATEGORY_ENCODED;
+	if (MA_SUCCESS == ma_resource_manager_register_encoded_data(&engine->resourceManager, name, data, length) &&
+		(registered = FosterAudioEngineTrackData(engine, name, data, (size_t)length, FOSTER_MEMORY_CATEGORY_ENCODED, NULL)) == NULL)
+		ma_resource_manager_unregister_data(&engine->resourceManager, name);
+	fosterThreadCategory = FOSTER_MEMORY_CATEGORY_OTHER;
+	return registered;
+}
+
+FosterRegisteredData* FosterAudioEngineRegisterDecodedData(FosterAudioEngine* engine, const char *name, const void *data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate)
+{
+	FosterRegisteredData* registered = NULL;
+	fosterThreadCategory = FOSTER_MEMORY_CATEGORY_DECODED;
+	if (MA_SUCCESS == ma_resource_manager_register_decoded_data(&engine->resourceManager, name, data, frameCount, (ma_format)format, channels, sampleRate) &&
+		(registered = FosterAudioEngineTrackData(engine, name, data, (size_t)(frameCount * ma_get_bytes_per_frame((ma_format)format, channels)), FOSTER_MEMORY_CATEGORY_DECODED, NULL)) == NULL)
+		ma_resource_manager_unregister_data(&engine->resourceManager, name);
+	fosterThreadCategory = FOSTER_MEMORY_CATEGORY_OTHER;
+	return registered;
+}
+
+FosterRegisteredData* FosterAudioEngineDecodeAndRegisterData(FosterAudioEngine* engine, const char *name, void *data, int length, FosterAudioFormat *format, int *channels, int *sampleRate, uint64_t *frameCount)
+{
+	// a cached transcode is already at the engine rate and much cheaper to decode than the source
+	size_t cachedLength = 0;
+	void* cached = FosterTranscodeLoad(engine, data, (size_t)length, &cachedLength, FOSTER_MEMORY_CATEGORY_OTHER);
+	if (cached != NULL)
+	{
+		data = cached;
+		length = (int)cachedLength;
+	}
+
+	// the frames are decoded once into a buffer sized up front and owned by the registration
+	ma_decoder decoder;
+	ma_result result = FosterDecoderInit(&engine->memory, data, length, *format, *channels, *sampleRate, &decoder);
+	if (result != MA_SUCCESS)
+	{
+		FosterFree(cached);
+		return NULL;
+	}
+
+	ma_uint64 capacity = FosterDecoderGetInfo(&decoder, format, channels, sampleRate);
+	size_t bytesPerFrame = ma_get_bytes_per_frame((ma_format)*format, *channels);
+	void *frames = capacity > 0 ? FosterMalloc(&engine->memory, (size_t)(capacity * bytesPerFrame), FOSTER_MEMORY_CATEGORY_DECODED) : NULL;
+	ma_uint64 read = 0;
+	if (frames != NULL)
+		ma_decoder_read_pcm_frames(&decoder, frames, capacity, &read);
+	ma_decoder_uninit(&decoder);
+	FosterFree(cached);
+
+	if (read == 0 ||
+		ma_resource_manager_register_decoded_data(&engine->resourceManager, name, frames, read, (ma_format)*format, *channels, *sampleRate) != MA_SUCCESS)
+	{
+		FosterFree(frames);
+		return NULL;
+	}
+
+	FosterRegisteredData* registered = FosterAudioEngineTrackData(engine, name, frames, (size_t)(read * bytesPerFrame), FOSTER_MEMORY_CATEGORY_DECODED, frames);
+	if (registered == NULL)
+	{
+		ma_resource_manager_unregister_data(&engine->resourceManager, name);
+		FosterFree(frames);
+		return NULL;
+	}
+
+	*frameCount = read;
+	return registered;
+}
+
+void FosterAudioEngineSetDecoderPoolSize(FosterAudioEngine* engine, const char *name, int warmCount)
+{
+	if (warmCount <= 0)
+	{
+		FosterDecoderPoolRemove(engine, name);
+		return;
+	}
+
+	// only encoded registrations decode per sound
+	const void* data = NULL;
+	size_t size = 0;
+	ma_spinlock_lock(&engine->memory.registryLock);
+	for (FosterRegisteredData* entry = engine->memory.registry; entry != NULL; entry = entry->next)
+	{
+		if (entry->category == FOSTER_MEMORY_CATEGORY_ENCODED && strcmp(entry->name, name) == 0)
+		{
+			data = entry->data;
+			size = entry->size;
+			break;
+		}
+	}
+	ma_spinlock_unlock(&engine->memory.registryLock);
+
+	if (data == NULL)
+	{
+		FosterLogWarn("Unable to pool decoders for %s (Not Registered Encoded Data)", name);
+		return;
+	}
+
+	size_t nameLength = strlen(name);
+	FosterDecoderPool* created = FosterMalloc(&engine->memory, sizeof(FosterDecoderPool) + nameLength + 1, FOSTER_MEMORY_CATEGORY_ENCODED);
+	ma_decoder** idle = FosterMalloc(&engine->memory, (size_t)warmCount * sizeof(ma_decoder*), FOSTER_MEMORY_CATEGORY_ENCODED);
+	if (created == NULL || idle == NULL)
+	{
+		FosterLogWarn("Unable to pool decoders for %s (Out of Memory)", name);
+		FosterFree(created);
+		FosterFree(idle);
+		return;
+	}
+
+	ma_spinlock_lock(&engine->decoderPoolLock);
+	FosterDecoderPool* pool = FosterDecoderPoolFind(engine, name);
+	if (pool == NULL)
+	{
+		pool = created;
+		created = NULL;
+		MA_ZERO_MEMORY(pool, sizeof(FosterDecoderPool));
+		MA_COPY_MEMORY(pool->name, name, nameLength + 1);
+		pool->engine = engine;
+		pool->data = data;
+		pool->size = size;
+		pool->references = 1;
+		pool->next = engine->decoderPools;
+		engine->decoderPools = pool;
+		ma_atomic_fetch_add_32(&engine->decoderPoolCount, 1);
+	}
+
+	// the idle list only ever grows, so returning a decoder never allocates
+	if (pool->idleCapacity < (ma_uint32)warmCount)
+	{
+		if (pool->idleCount > 0)
+			MA_COPY_MEMORY(idle, pool->idle, pool->idleCount * sizeof(ma_decoder*));
+		ma_decoder** old = pool->idle;
+		pool->idle = idle;
+		pool->idleCapacity = (ma_uint32)warmCount;
+		idle = old;
+	}
+	pool->warmCount = (ma_uint32)warmCount;
+	pool->references++;
+	ma_spinlock_unlock(&engine->decoderPoolLock);
+
+	FosterFree(created);
+	FosterFree(idle);
+	FosterDecoderPoolFill(pool);
+
+	ma_spinlock_lock(&engine->decoderPoolLock);
+	FosterDecoderPoolDereference(pool);
+	ma_spinlock_unlock(&engine->decoderPoolLock);
+}
+
+void FosterAudioEngineUnregisterData(FosterAudioEngine* engine, const char *name)
+{
+	// sounds finalized after their engine was destroyed have nothing left to unregister
+	if (engine == NULL)
+		return;
+
+	FosterDecoderPoolRemove(engine, name);
+	FosterRegisteredData* registered = FosterRegistryTake(&engine->memory, name);
+	if (registered != NULL && registered->node != NULL)
+		ma_resource_manager_data_buffer_node_unacquire(&engine->resourceManager, registered->node, NULL, NULL);
+	ma_resource_manager_unregister_data(&engine->resourceManager, name);
+	if (registered != NULL)
+		FosterRegistryRelease(&engine->memory, registered);
+}
+
+int FosterAudioEngineGetTranscodedPath(FosterAudioEngine* engine, const char *path, char *cachedPath, int capacity)
+{
+	FosterTranscodeCache* cache = &engine->transcode;
+	if (cache->path == NULL)
+		return 0;
+
+	// keyed by where the file is, its size and when it changed, its contents are only read on the transcode thread
+	ma_uint64 size, modified;
+	if (!FosterTranscodeStat(&engine->memory, path, &size, &modified))
+		return 0;
+
+	char* key = FosterTranscodeKeyPath(engine, path, size, modified);
+	if (key == NULL)
+		return 0;
+
+	size_t nameLength = 0;
+	char* name = FosterTranscodeReadFile(&engine->memory, key, &nameLength, FOSTER_MEMORY_CATEGORY_OTHER);
+	char* transcoded = NULL;
+	FosterBool cached = false;
+	FosterBool index = name == NULL;
+
+	if (name != NULL && !(nameLength == strlen(FOSTER_TRANSCODE_NONE) && memcmp(name, FOSTER_TRANSCODE_NONE, nameLength) == 0))
+	{
+		size_t length = strlen(cache->path) + 1 + nameLength;
+		transcoded = FosterMalloc(&engine->memory, length + 1, FOSTER_MEMORY_CATEGORY_OTHER);
+		if (transcoded != NULL)
+		{
+			snprintf(transcoded, length + 1, "%s/%.*s", cache->path, (int)nameLength, name);
+			cached = FosterTranscodeExists(transcoded);
+
+			// the transcode is still running, or was interrupted or deleted and indexing again redoes it
+			index = !cached && !FosterTranscodeQueued(cache, transcoded);
+		}
+	}
+
+	int result = 0;
+	if (cached)
+	{
+		result = (int)strlen(transcoded) + 1;
+		if (cachedPath != NULL && result <= capacity)
+			MA_COPY_MEMORY(cachedPath, transcoded, result);
+	}
+	if (index)
+		FosterTranscodeQueue(engine, NULL, 0, path, key);
+
+	FosterFree(transcoded);
+	FosterFree(name);
+	FosterFree(key);
+	return result;
+}
+
+int FosterAudioEngineGetPendingTranscodes(FosterAudioEngine* engine)
+{
+	return (int)ma_atomic_load_32(&engine->transcode.pending);
+}
+
+int FosterAudioEnginePollFinished(FosterAudioEngine* engine, FosterSound** sounds, int capacity, FosterBool* overflowed)
+{
+	int count = 0;
+
+	while (count < capacity && FosterFinishedQueuePop(&engine->finished, &sounds[count]))
+		count++;
+
+	*overflowed = ma_atomic_exchange_32(&engine->finished.overflowed, 0) != 0;
+	return count;
+}
+
+// end AudioEngine
+
+// begin AudioEngineListener
+
+FosterBool FosterAudioEngineListenerGetEnabled(FosterAudioEngine* engine, int index)
+{
+	return ma_engine_listener_is_enabled(&engine->engine, index);
+}
+
+void FosterAudioEngineListenerSetEnabled(FosterAudioEngine* engine, int index, FosterBool value)
+{
+	ma_engine_listener_set_enabled(&engine->engine, index, value);
+}
+
+Vector3 FosterAudioEngineListenerGetPosition(FosterAudioEngine* engine, int index)
+{
+	return vec3f_to_Vector3(ma_engine_listener_get_position(&engine->engine, index));
+}
+
+void FosterAudioEngineListenerSetPosition(FosterAudioEngine* engine, int index, Vector3 value)
+{
+	ma_engine_listener_set_position(&engine->engine, index, value.x, value.y, value.z);
+}
+
+Vector3 FosterAudioEngineListenerGetVelocity(FosterAudioEngine* engine, int index)
+{
+	return vec3f_to_Vector3(ma_engine_listener_get_velocity(&engine->engine, index));
+}
+
+void FosterAudioEngineListenerSetVelocity(FosterAudioEngine* engine, int index, Vector3 value)
+{
+	ma_engine_listener_set_velocity(&engine->engine, index, value.x, value.y, value.z);
+}
+
+Vector3 FosterAudioEngineListenerGetDirection(FosterAudioEngine* engine, int index)
+{
+	return vec3f_to_Vector3(ma_engine_listener_get_direction(&engine->engine, index));
+}
+
+void FosterAudioEngineListenerSetDirection(FosterAudioEngine* engine, int index, Vector3 value)
+{
+	ma_engine_listener_set_direction(&engine->engine, index, value.x, value.y, value.z);
+}
+
+FosterSoundCone FosterAudioEngineListenerGetCone(FosterAudioEngine* engine, int index)
+{
+	FosterSoundCone value;
+	ma_engine_listener_get_cone(&engine->engine, index, &value.innerAngleInRadians, &value.outerAngleInRadians, &value.outerGain);
+	return value;
+}
+
+void FosterAudioEngineListenerSetCone(FosterAudioEngine* engine, int index, FosterSoundCone value)
+{
+	ma_engine_listener_set_cone(&engine->engine, index, value.innerAngleInRadians, value.outerAngleInRadians, value.outerGain);
+}
+
+Vector3 FosterAudioEngineListenerGetWorldUp(FosterAudioEngine* engine, int index)
+{
+	return vec3f_to_Vector3(ma_engine_listener_get_world_up(&engine->engine, index));
+}
+
+void FosterAudioEngineListenerSetWorldUp(FosterAudioEngine* engine, int index, Vector3 value)
+{
+	ma_engine_listener_set_world_up(&engine->engine, index, value.x, value.y, value.z);
+}
+
+// end AudioEngineListener
+
+// begin Audio
+
+void FosterAudioStartup(FosterDesc desc)
+{
+	fstate.desc = desc;
+	fstate.audioEngine = FosterAudioEngineCreate(desc);
+	fstate.running = fstate.audioEngine != NULL;
+}
+
+void FosterAudioShutdown()
+{
+	if (!fstate.running)
+		return;
+
+	FosterAudioEngineDestroy(fstate.audioEngine);
+	fstate.audioEngine = NULL;
+	fstate.running = false;
+}
+
+FosterAudioEngine* FosterAudioGetEngine()
+{
+	return fstate.audioEngine;
+}
+
+float FosterAudioGetVolume()
+{
+	return FosterAudioEngineGetVolume(fstate.audioEngine);
+}
+
+void FosterAudioSetVolume(int index, float value)
+{
+	FosterAudioEngineSetVolume(fstate.audioEngine, value);
+}
+
+int FosterAudioGetChannels()
+{
+	return FosterAudioEngineGetChannels(fstate.audioEngine);
+}
+
+int FosterAudioGetSampleRate()
+{
+	return FosterAudioEngineGetSampleRate(fstate.audioEngine);
+}
+
+uint64_t FosterAudioGetTimePcmFrames()
+{
+	return FosterAudioEngineGetTimePcmFrames(fstate.audioEngine);
+}
+
+void FosterAudioSetTimePcmFrames(int index, uint64_t value)
+{
+	FosterAudioEngineSetTimePcmFrames(fstate.audioEngine, value);
+}
+
+int FosterAudioGetListenerCount()
+{
+	return FosterAudioEngineGetListenerCount(fstate.audioEngine);
+}
+
+void FosterAudioGetMemoryStats(FosterMemoryStats* stats)
+{
+	FosterAudioEngineGetMemoryStats(fstate.audioEngine, stats);
+}
+
+void FosterAudioGetIdleStats(FosterIdleStats* stats)
+{
+	FosterAudioEngineGetIdleStats(fstate.audioEngine, stats);
+}
+
+FosterBool FosterAudioDecodeProbe(void *data, int length, FosterAudioFormat *format, int *channels, int *sampleRate, uint64_t *frameCount)
+{
+	ma_decoder decoder;
+	if (FosterDecoderInit(FosterDecodeMemory(), data, length, *format, *channels, *sampleRate, &decoder) != MA_SUCCESS)
+		return false;
+
+	*frameCount = FosterDecoderGetInfo(&decoder, format, channels, sampleRate);
+	ma_decoder_uninit(&decoder);
+	return true;
+}
+
+uint64_t FosterAudioDecodeInto(void *data, int length, FosterAudioFormat format, int channels, int sampleRate, void *frames, uint64_t frameCapacity)
+{
+	ma_decoder decoder;
+	if (FosterDecoderInit(FosterDecodeMemory(), data, length, format, channels, sampleRate, &decoder) != MA_SUCCESS)
+		return 0;
+
+	ma_uint64 read = 0;
+	ma_decoder_read_pcm_frames(&decoder, frames, frameCapacity, &read);
+	ma_decoder_uninit(&decoder);
+	return read;
+}
+
+void *FosterAudioDecode(void *data, int length, FosterAudioFormat *format, int *channels, int *sampleRate, uint64_t *decodedFrameCount)
+{
+	FosterMemory *memory = FosterDecodeMemory();
+
+	void *frames = NULL;
+	ma_decoder_config config = ma_decoder_config_init(*format, *channels, *sampleRate);
+	config.pCustomBackendUserData = memory;
+	config.ppCustomBackendVTables = pCustomBackendVTables;
+	config.customBackendCount = sizeof(pCustomBackendVTables) / sizeof(pCustomBackendVTables[0]);
+	config.allocationCallbacks = FosterAllocationCallbacks(memory, FOSTER_MEMORY_CATEGORY_DECODED);
+
+	ma_decode_memory(data, length, &config, decodedFrameCount, &frames);
+	*format = config.format;
+	*channels = config.channels;
+	*sampleRate = config.sampleRate;
+	return frames;
+}
+
+void *FosterAudioEncodeWAV(void* data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate)
+{
+	return NULL; // TODO
+}
+
+void* FosterAudioEncodeQOA(void* data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate)
+{
+	return NULL; // TODO
+}
+
+void FosterAudioFree(void *data)
+{
+	FosterFree(data);
+}
+
+FosterRegisteredData* FosterAudioRegisterEncodedData(const char *name, void *data, int length)
+{
+	return FosterAudioEngineRegisterEncodedData(fstate.audioEngine, name, data, length);
+}
+
+FosterRegisteredData* FosterAudioRegisterDecodedData(const char *name, const void *data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate)
+{
+	return FosterAudioEngineRegisterDecodedData(fstate.audioEngine, name, data, frameCount, format, channels, sampleRate);
+}
+
+FosterRegisteredData* FosterAudioDecodeAndRegisterData(const char *name, void *data, int length, FosterAudioFormat *format, int *channels, int *sampleRate, uint64_t *frameCount)
+{
+	return FosterAudioEngineDecodeAndRegisterData(fstate.audioEngine, name, data, length, format, channels, sampleRate, frameCount);
+}
+
+FosterCapture* FosterAudioStartCapture(FosterSoundGroup* soundGroup, FosterCaptureDesc desc)
+{
+	return FosterAudioEngineStartCapture(fstate.audioEngine, soundGroup, desc);
+}
+
+void FosterAudioSetDecoderPoolSize(const char *name, int warmCount)
+{
+	FosterAudioEngineSetDecoderPoolSize(fstate.audioEngine, name, warmCount);
+}
+
+void FosterAudioUnregisterData(const char *name)
+{
+	FosterAudioEngineUnregisterData(fstate.audioEngine, name);
+}
+
+int FosterAudioGetTranscodedPath(const char *path, char *cachedPath, int capacity)
+{
+	return FosterAudioEngineGetTranscodedPath(fstate.audioEngine, path, cachedPath, capacity);
+}
+
+int FosterAudioGetPendingTranscodes()
+{
+	return FosterAudioEngineGetPendingTranscodes(fstate.audioEngine);
+}
+
+int FosterAudioSnapshot(void* buffer, int capacity, int* voiceCount)
+{
+	return FosterAudioEngineSnapshot(fstate.audioEngine, buffer, capacity, voiceCount);
+}
+
+FosterBool FosterAudioRestore(const void* snapshot, int length, uint64_t cursorTolerance, FosterRestoredSound* created, int createdCapacity, int* createdCount, FosterSound** stale, int staleCapacity, int* staleCount)
+{
+	return FosterAudioEngineRestore(fstate.audioEngine, snapshot, length, cursorTolerance, created, createdCapacity, createdCount, stale, staleCapacity, staleCount);
+}
+
+int FosterAudioPollFinished(FosterSound** sounds, int capacity, FosterBool* overflowed)
+{
+	return FosterAudioEnginePollFinished(fstate.audioEngine, sounds, capacity, overflowed);
+}
+
+// end Audio
+
+// begin AudioListener
+
+FosterBool FosterAudioListenerGetEnabled(int index)
+{
+	return FosterAudioEngineListenerGetEnabled(fstate.audioEngine, index);
+}
+
+void FosterAudioListenerSetEnabled(int index, FosterBool value)
+{
+	FosterAudioEngineListenerSetEnabled(fstate.audioEngine, index, value);
+}
+
+Vector3 FosterAudioListenerGetPosition(int index)
+{
+	return FosterAudioEngineListenerGetPosition(fstate.audioEngine, index);
+}
+
+void FosterAudioListenerSetPosition(int index, Vector3 value)
+{
+	FosterAudioEngineListenerSetPosition(fstate.audioEngine, index, value);
+}
+
+Vector3 FosterAudioListenerGetVelocity(int index)
+{
+	return FosterAudioEngineListenerGetVelocity(fstate.audioEngine, index);
+}
+
+void FosterAudioListenerSetVelocity(int index, Vector3 value)
+{
+	FosterAudioEngineListenerSetVelocity(fstate.audioEngine, index, value);
+}
+
+Vector3 FosterAudioListenerGetDirection(int index)
+{
+	return FosterAudioEngineListenerGetDirection(fstate.audioEngine, index);
+}
+
+void FosterAudioListenerSetDirection(int index, Vector3 value)
+{
+	FosterAudioEngineListenerSetDirection(fstate.audioEngine, index, value);
+}
+
+FosterSoundCone FosterAudioListenerGetCone(int index)
+{
+	return FosterAudioEngineListenerGetCone(fstate.audioEngine, index);
+}
+
+void FosterAudioListenerSetCone(int index, FosterSoundCone value)
+{
+	FosterAudioEngineListenerSetCone(fstate.audioEngine, index, value);
+}
+
+Vector3 FosterAudioListenerGetWorldUp(int index)
+{
+	return FosterAudioEngineListenerGetWorldUp(fstate.audioEngine, index);
+}
+
+void FosterAudioListenerSetWorldUp(int index, Vector3 value)
+{
+	FosterAudioEngineListenerSetWorldUp(fstate.audioEngine, index, value);
+}
+
+// end AudioListener
+
+// begin Sound
+
+static void FosterSoundOnEnd(void *userData, ma_sound *sound)
+{
+	(void)sound;
+	FosterSound *foster = (FosterSound *)userData;
+	FosterFinishedQueuePush(&foster->engine->finished, foster);
+}
+
+static void FosterSoundLinkGroup(FosterSound *sound, FosterSoundGroup *soundGroup)
+{
+	sound->group = soundGroup;
+	sound->prev = NULL;
+	sound->next = NULL;
+
+	if (soundGroup == NULL)
+		return;
 
-void* FosterAudioEncodeQOA(void* data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate)
-{
-	return NULL; // TODO
+	ma_spinlock_lock(&sound->engine->groupLock);
+	sound->next = soundGroup->firstSound;
+	if (sound->next != NULL)
+		sound->next->prev = sound;
+	soundGroup->firstSound = sound;
+	ma_spinlock_unlock(&sound->engine->groupLock);
 }
 
-void FosterAudioFree(void *data)
+static void FosterSoundUnlinkGroup(FosterSound *sound)
 {
-	ma_free(data, NULL);
+	if (sound->group == NULL)
+		return;
+
+	ma_spinlock_lock(&sound->engine->groupLock);
+	if (sound->prev != NULL)
+		sound->prev->next = sound->next;
+	else
+		sound->group->firstSound = sound->next;
+	if (sound->next != NULL)
+		sound->next->prev = sound->prev;
+	ma_spinlock_unlock(&sound->engine->groupLock);
+
+	sound->group = NULL;
+	sound->prev = NULL;
+	sound->next = NULL;
 }
 
-void FosterAudioRegisterEncodedData(const char *name, void *data, int length)
+// allocates and initializes a voice from a partially filled config, NULL if it fails
+static FosterSound *FosterSoundInit(FosterAudioEngine *engine, ma_sound_config *config, FosterSoundGroup *soundGroup)
 {
-	ma_resource_manager *manager = ma_engine_get_resource_manager(fstate.audioEngine);
-	ma_resource_manager_register_encoded_data(manager, name, data, length);
+	FosterSound *sound = FosterPoolAlloc(&engine->memory.voicePool, sizeof(FosterSound));
+	if (sound == NULL)
+	{
+		FosterLogError("Unable to create Sound (Out of Memory)");
+		return NULL;
+	}
+
+	config->pInitialAttachment = (ma_node *)soundGroup;
+	config->endCallback = FosterSoundOnEnd;
+	config->pEndCallbackUserData = sound;
+
+	sound->engine = engine;
+	sound->stream = NULL;
+	sound->sequence = NULL;
+	sound->decoder = NULL;
+	sound->decoderPool = NULL;
+	sound->dataSerial = 0;
+	sound->flags = config->flags;
+	sound->serial = ma_atomic_fetch_add_64(&engine->snapshots.nextSerial, 1) + 1;
+	if (MA_SUCCESS != ma_sound_init_ex(&engine->engine, config, &sound->sound))
+	{
+		FosterPoolFree(&engine->memory.voicePool, sound);
+		return NULL;
+	}
+
+	FosterSoundLinkGroup(sound, soundGroup);
+	FosterSpatialBatchAdd(engine, sound);
+	FosterIdleAddSound(engine, sound);
+	return sound;
 }
 
-void FosterAudioRegisterDecodedData(const char *name, const void *data, uint64_t frameCount, FosterAudioFormat format, int channels, int sampleRate)
+FosterSound *FosterAudioEngineCreateSound(FosterAudioEngine *engine, const char *path, FosterSoundFlags flags, FosterSoundGroup *soundGroup)
 {
-	ma_resource_manager *manager = ma_engine_get_resource_manager(fstate.audioEngine);
-	ma_resource_manager_register_decoded_data(manager, name, data, frameCount, format, channels, sampleRate);
+	ma_sound_config config = ma_sound_config_init_2(&engine->engine);
+	config.pFilePath = path;
+	config.flags = flags;
+
+	// preloaded encoded data with a decoder pool skips building a decoder through the resource manager
+	FosterDecoderPool *pool = NULL;
+	ma_decoder *decoder = NULL;
+	if (!FOSTER_CHECK(flags, FOSTER_SOUND_FLAG_STREAM) && !FOSTER_CHECK(flags, FOSTER_SOUND_FLAG_DECODE))
+		decoder = FosterDecoderPoolBorrow(engine, path, NULL, &pool);
+	if (decoder != NULL)
+	{
+		config.pFilePath = NULL;
+		config.pDataSource = decoder;
+	}
+
+	// tag whatever the resource manager loads synchronously for this sound
+	fosterThreadCategory =
+		FOSTER_CHECK(flags, FOSTER_SOUND_FLAG_STREAM) ? FOSTER_MEMORY_CATEGORY_STREAMING :
+		FOSTER_CHECK(flags, FOSTER_SOUND_FLAG_DECODE) ? FOSTER_MEMORY_CATEGORY_DECODED :
+		FOSTER_MEMORY_CATEGORY_ENCODED;
+	FosterSound *sound = FosterSoundInit(engine, &config, soundGroup);
+	fosterThreadCategory = FOSTER_MEMORY_CATEGORY_OTHER;
+
+	if (sound == NULL)
+	{
+		if (decoder != NULL)
+			FosterDecoderPoolReturn(engine, pool, decoder);
+		FosterLogError("Unable to create Sound from file");
+		return NULL;
+	}
+
+	sound->decoder = decoder;
+	sound->decoderPool = pool;
+	return sound;
 }
 
-void FosterAudioUnregisterData(const char *name)
+// the same data buffer ma_sound_init_ex builds for a registered name, initialized straight from the node
+// registered data is always fully loaded, so the connector is set up right away like a synchronous load
+static ma_result FosterDataSourceInit(FosterRegisteredData *data, ma_uint32 flags, ma_resource_manager_data_source *source)
 {
-	ma_resource_manager *manager = ma_engine_get_resource_manager(fstate.audioEngine);
-	ma_resource_manager_unregister_data(manager, name);
-}
+	ma_resource_manager *resourceManager = &data->engine->resourceManager;
+	ma_resource_manager_data_buffer *buffer = &source->backend.buffer;
 
-// end Audio
+	MA_ZERO_OBJECT(source);
+	source->flags = flags;
+	ma_resource_manager_data_buffer_node_increment_ref(resourceManager, data->node, NULL);
 
-// begin AudioListener
+	ma_data_source_config dataSourceConfig = ma_data_source_config_init();
+	dataSourceConfig.vtable = &g_ma_resource_manager_data_buffer_vtable;
+	ma_result result = ma_data_source_init(&dataSourceConfig, &buffer->ds);
+	if (result == MA_SUCCESS)
+	{
+		buffer->pResourceManager = resourceManager;
+		buffer->pNode = data->node;
+		buffer->flags = flags;
+
+		ma_resource_manager_data_source_config config = ma_resource_manager_data_source_config_init();
+		config.flags = flags;
+		result = ma_resource_manager_data_buffer_init_connector(buffer, &config, NULL, NULL);
+		ma_atomic_exchange_i32(&buffer->result, result);
+	}
 
-FosterBool FosterAudioListenerGetEnabled(int index)
-{
-	return ma_engine_listener_is_enabled(fstate.audioEngine, index);
+	if (result != MA_SUCCESS)
+		ma_resource_manager_data_buffer_node_unacquire(resourceManager, data->node, NULL, NULL);
+	return result;
 }
 
-void FosterAudioListenerSetEnabled(int index, FosterBool value)
+uint64_t FosterRegisteredDataGetSerial(FosterRegisteredData *data)
 {
-	ma_engine_listener_set_enabled(fstate.audioEngine, index, value);
+	return data->serial;
 }
 
-Vector3 FosterAudioListenerGetPosition(int index)
+FosterSound *FosterSoundCreateFromData(FosterRegisteredData *data, FosterSoundFlags flags, FosterSoundGroup *soundGroup)
 {
-	return vec3f_to_Vector3(ma_engine_listener_get_position(fstate.audioEngine, index));
+	FosterAudioEngine *engine = data->engine;
+	flags &= ~FOSTER_SOUND_FLAG_STREAM;
+
+	ma_sound_config config = ma_sound_config_init_2(&engine->engine);
+	config.flags = flags;
+
+	FosterDecoderPool *pool = NULL;
+	ma_decoder *decoder = NULL;
+	ma_resource_manager_data_source *source = NULL;
+	if (data->category == FOSTER_MEMORY_CATEGORY_ENCODED && !FOSTER_CHECK(flags, FOSTER_SOUND_FLAG_DECODE))
+		decoder = FosterDecoderPoolBorrow(engine, NULL, data->data, &pool);
+
+	// tag the connector's decoder like the resource manager would for this data
+	fosterThreadCategory = data->category;
+	if (decoder != NULL)
+	{
+		config.pDataSource = decoder;
+	}
+	else
+	{
+		source = ma_malloc(sizeof(*source), &engine->engine.allocationCallbacks);
+		if (source == NULL || FosterDataSourceInit(data, flags, source) != MA_SUCCESS)
+		{
+			fosterThreadCategory = FOSTER_MEMORY_CATEGORY_OTHER;
+			ma_free(source, &engine->engine.allocationCallbacks);
+			FosterLogError("Unable to create Sound from data");
+			return NULL;
+		}
+		config.pDataSource = source;
+	}
+
+	FosterSound *sound = FosterSoundInit(engine, &config, soundGroup);
+	fosterThreadCategory = FOSTER_MEMORY_CATEGORY_OTHER;
+
+	if (sound == NULL)
+	{
+		if (decoder != NULL)
+			FosterDecoderPoolReturn(engine, pool, decoder);
+		if (source != NULL)
+		{
+			ma_resource_manager_data_source_uninit(source);
+			ma_free(source, &engine->engine.allocationCallbacks);
+		}
+		FosterLogError("Unable to create Sound from data");
+		return NULL;
+	}
+
+	// ma_sound_uninit releases the data source as if the sound had loaded it by name
+	if (source != NULL)
+	{
+		sound->sound.pResourceManagerDataSource = source;
+		sound->sound.ownsDataSource = MA_TRUE;
+	}
+
+	sound->decoder = decoder;
+	sound->decoderPool = pool;
+	sound->dataSerial = data->serial;
+	return sound;
 }
 
-void FosterAudioListenerSetPosition(int index, Vector3 value)
+FosterSound *FosterAudioEngineCreateStreamingBuffer(FosterAudioEngine *engine, FosterAudioFormat format, int channels, int sampleRate, uint64_t capacityFrames, FosterSoundGroup *soundGroup)
 {
-	ma_engine_listener_set_position(fstate.audioEngine, index, value.x, value.y, value.z);
+	if (format == FOSTER_AUDIO_FORMAT_UNKNOWN || channels <= 0 || sampleRate <= 0 || capacityFrames == 0 || capacityFrames > 0x7FFFFFFF)
+	{
+		FosterLogError("Unable to create streaming buffer Sound (Invalid Format)");
+		return NULL;
+	}
+
+	FosterPcmStream *stream = FosterPcmStreamCreate(&engine->memory, (ma_format)format, (ma_uint32)channels, (ma_uint32)sampleRate, (ma_uint32)capacityFrames);
+	if (stream == NULL)
+	{
+		FosterLogError("Unable to create streaming buffer Sound (Out of Memory)");
+		return NULL;
+	}
+
+	ma_sound_config config = ma_sound_config_init_2(&engine->engine);
+	config.pDataSource = &stream->ds;
+	config.flags = FOSTER_SOUND_FLAG_NO_SPATIALIZATION;
+
+	FosterSound *sound = FosterSoundInit(engine, &config, soundGroup);
+	if (sound == NULL)
+	{
+		FosterLogError("Unable to create streaming buffer Sound");
+		FosterPcmStreamDestroy(stream);
+		return NULL;
+	}
+
+	sound->stream = stream;
+	return sound;
 }
 
-Vector3 FosterAudioListenerGetVelocity(int index)
+FosterSound *FosterAudioEngineCreateSequence(FosterAudioEngine *engine, const FosterSequenceSegment *segments, int segmentCount, FosterSoundGroup *soundGroup)
 {
-	return vec3f_to_Vector3(ma_engine_listener_get_velocity(fstate.audioEngine, index));
+	if (segments == NULL || segmentCount <= 0)
+	{
+		FosterLogError("Unable to create Sequence Sound (No Segments)");
+		return NULL;
+	}
+
+	FosterSequence *sequence = FosterSequenceCreate(engine, segments, segmentCount);
+	if (sequence == NULL)
+	{
+		FosterLogError("Unable to create Sequence Sound (Out of Memory)");
+		return NULL;
+	}
+
+	ma_sound_config config = ma_sound_config_init_2(&engine->engine);
+	config.pDataSource = &sequence->ds;
+	config.flags = FOSTER_SOUND_FLAG_NO_SPATIALIZATION;
+
+	FosterSound *sound = FosterSoundInit(engine, &config, soundGroup);
+	if (sound == NULL)
+	{
+		FosterLogError("Unable to create Sequence Sound");
+		FosterSequenceDestroy(sequence);
+		return NULL;
+	}
+
+	sound->sequence = sequence;
+	return sound;
 }
 
-void FosterAudioListenerSetVelocity(int index, Vector3 value)
+FosterSound *FosterSoundCreate(const char *path, FosterSoundFlags flags, FosterSoundGroup *soundGroup)
 {
-	ma_engine_listener_set_velocity(fstate.audioEngine, index, value.x, value.y, value.z);
+	return FosterAudioEngineCreateSound(FosterGetState()->audioEngine, path, flags, soundGroup);
 }
 
-Vector3 FosterAudioListenerGetDirection(int index)
+FosterSound *FosterSoundCreateStreamingBuffer(FosterAudioFormat format, int channels, int sampleRate, uint64_t capacityFrames, FosterSoundGroup *soundGroup)
 {
-	return vec3f_to_Vector3(ma_engine_listener_get_direction(fstate.audioEngine, index));
+	return FosterAudioEngineCreateStreamingBuffer(FosterGetState()->audioEngine, format, channels, sampleRate, capacityFrames, soundGroup);
 }
 
-void FosterAudioListenerSetDirection(int index, Vector3 value)
+FosterSound *FosterSoundCreateSequence(const FosterSequenceSegment *segments, int segmentCount, FosterSoundGroup *soundGroup)
 {
-	ma_engine_listener_set_direction(fstate.audioEngine, index, value.x, value.y, value.z);
+	return FosterAudioEngineCreateSequence(FosterGetState()->audioEngine, segments, segmentCount, soundGroup);
 }
 
-FosterSoundCone FosterAudioListenerGetCone(int index)
+void FosterSoundSequenceAdvance(FosterSound *sound)
 {
-	FosterSoundCone value;
-	ma_engine_listener_get_cone(fstate.audioEngine, index, &value.innerAngleInRadians, &value.outerAngleInRadians, &value.outerGain);
-	return value;
+	if (sound->sequence != NULL)
+		ma_atomic_exchange_32(&sound->sequence->advance, 1);
 }
 
-void FosterAudioListenerSetCone(int index, FosterSoundCone value)
+int FosterSoundSequenceGetIndex(FosterSound *sound)
 {
-	ma_engine_listener_set_cone(fstate.audioEngine, index, value.innerAngleInRadians, value.outerAngleInRadians, value.outerGain);
+	return sound->sequence != NULL ? (int)ma_atomic_load_32(&sound->sequence->current) : 0;
 }
 
-Vector3 FosterAudioListenerGetWorldUp(int index)
+uint64_t FosterSoundSequenceGetLateFrames(FosterSound *sound)
 {
-	return vec3f_to_Vector3(ma_engine_listener_get_world_up(fstate.audioEngine, index));
+	return sound->sequence != NULL ? ma_atomic_load_64(&sound->sequence->lateFrames) : 0;
 }
 
-void FosterAudioListenerSetWorldUp(int index, Vector3 value)
+void FosterSoundSequenceUpdate(FosterSound *sound)
 {
-	ma_engine_listener_set_world_up(fstate.audioEngine, index, value.x, value.y, value.z);
+	FosterSequence *sequence = sound->sequence;
+	if (sequence == NULL)
+		return;
+
+	// only segments before the current one, the audio thread is done with those
+	ma_uint32 current = ma_atomic_load_32(&sequence->current);
+	for (ma_uint32 i = 0; i < current && i < sequence->slotCount; i++)
+	{
+		ma_uint32 state = ma_atomic_load_32(&sequence->slots[i].state);
+		if (state == FOSTER_SEQUENCE_SLOT_RETIRED || state == FOSTER_SEQUENCE_SLOT_FAILED)
+			FosterSequenceSlotRelease(sequence, &sequence->slots[i]);
+	}
 }
 
-// end AudioListener
+uint64_t FosterSoundPushPcm(FosterSound *sound, const void *frames, uint64_t frameCount)
+{
+	if (sound->stream == NULL)
+	{
+		FosterLogError("Failed 'FosterSoundPushPcm', Sound is not a streaming buffer");
+		return 0;
+	}
 
-// begin Sound
+	return FosterPcmStreamPush(sound->stream, frames, frameCount);
+}
 
-FosterSound *FosterSoundCreate(const char *path, FosterSoundFlags flags, FosterSoundGroup *soundGroup)
+void FosterSoundGetStreamingBufferStats(FosterSound *sound, FosterStreamingBufferStats *stats)
 {
-	FosterState *state = FosterGetState();
-	ma_sound *sound = ma_malloc(sizeof(ma_sound), NULL);
-
-	if (MA_SUCCESS != ma_sound_init_from_file(state->audioEngine, path, flags, (ma_sound_group *)soundGroup, NULL, sound))
+	FosterPcmStream *stream = sound->stream;
+	if (stream == NULL)
 	{
-		FosterLogError("Unable to create Sound from file");
-		ma_free(sound, NULL);
-		return NULL;
+		MA_ZERO_OBJECT(stats);
+		return;
 	}
 
-	return (FosterSound *)sound;
+	stats->queuedFrames = ma_pcm_rb_available_read(&stream->buffer);
+	stats->capacityFrames = ma_pcm_rb_get_subbuffer_size(&stream->buffer);
+	stats->underrunCount = ma_atomic_load_64(&stream->underrunCount);
+	stats->underrunFrames = ma_atomic_load_64(&stream->underrunFrames);
+}
+
+// expects groupLock to be held, a voice asleep for being silent is already playing
+static void FosterSoundStartLocked(FosterSound *sound)
+{
+	FosterIdleSync(&sound->engine->idle);
+	if (sound->idleState != FOSTER_IDLE_ASLEEP)
+		ma_sound_start((ma_sound *)sound);
+}
+
+// expects groupLock to be held
+static void FosterSoundStopLocked(FosterSound *sound)
+{
+	FosterIdleSync(&sound->engine->idle);
+	sound->idleState = FOSTER_IDLE_AWAKE;
+	sound->idleFrames = 0;
+	ma_sound_stop((ma_sound *)sound);
 }
 
 void FosterSoundPlay(FosterSound *sound)
 {
-	ma_sound_start((ma_sound *)sound);
+	ma_spinlock_lock(&sound->engine->groupLock);
+	FosterSoundStartLocked(sound);
+	ma_spinlock_unlock(&sound->engine->groupLock);
 }
 
 void FosterSoundStop(FosterSound *sound)
 {
-	ma_sound_stop((ma_sound *)sound);
+	ma_spinlock_lock(&sound->engine->groupLock);
+	FosterSoundStopLocked(sound);
+	ma_spinlock_unlock(&sound->engine->groupLock);
 }
 
 void FosterSoundDestroy(FosterSound *sound)
 {
+	FosterIdleRemoveSound(sound->engine, sound);
+	FosterSpatialBatchRemove(sound->engine, sound);
+	// unlinked first so group operations never reach a voice that's being torn down
+	FosterSoundUnlinkGroup(sound);
 	ma_sound_uninit((ma_sound *)sound);
-	ma_free((ma_sound *)sound, NULL);
+	if (sound->decoder != NULL)
+		FosterDecoderPoolReturn(sound->engine, sound->decoderPool, sound->decoder);
+	if (sound->stream != NULL)
+		FosterPcmStreamDestroy(sound->stream);
+	if (sound->sequence != NULL)
+		FosterSequenceDestroy(sound->sequence);
+	FosterPoolFree(&sound->engine->memory.voicePool, sound);
 }
 
 float FosterSoundGetVolume(FosterSound *sound)
@@ -452,7 +5008,7 @@ void FosterSoundSetPan(FosterSound *sound, float value)
 
 FosterBool FosterSoundGetPlaying(FosterSound *sound)
 {
-	return ma_sound_is_playing((ma_sound *)sound);
+	return ma_sound_is_playing((ma_sound *)sound) || ma_atomic_load_32(&sound->idleState) == FOSTER_IDLE_ASLEEP;
 }
 
 FosterBool FosterSoundGetFinished(FosterSound *sound)
@@ -481,7 +5037,9 @@ uint64_t FosterSoundGetCursorPcmFrames(FosterSound *sound)
 
 void FosterSoundSetCursorPcmFrames(FosterSound *sound, uint64_t value)
 {
-	ma_sound_seek_to_pcm_frame((ma_sound *)sound, value);
+	ma_spinlock_lock(&sound->engine->groupLock);
+	FosterIdleSeekLocked(sound, value);
+	ma_spinlock_unlock(&sound->engine->groupLock);
 }
 
 FosterBool FosterSoundGetLooping(FosterSound *sound)
@@ -678,25 +5236,90 @@ void FosterSoundSetDopplerFactor(FosterSound *sound, float value)
 
 // begin SoundGroup
 
-FosterSoundGroup *FosterSoundGroupCreate(FosterSoundGroup* parent)
+FosterSoundGroup *FosterAudioEngineCreateSoundGroup(FosterAudioEngine *engine, FosterSoundGroup* parent)
 {
-	FosterState *state = FosterGetState();
-	ma_sound_group *soundGroup = ma_malloc(sizeof(ma_sound_group), NULL);
+	FosterSoundGroup *soundGroup = FosterMalloc(&engine->memory, sizeof(FosterSoundGroup), FOSTER_MEMORY_CATEGORY_VOICES);
+	if (soundGroup == NULL)
+	{
+		FosterLogError("Unable to create SoundGroup (Out of Memory)");
+		return NULL;
+	}
 
-	if (MA_SUCCESS != ma_sound_group_init(state->audioEngine, 0, (ma_sound_group*)parent, soundGroup))
+	// top-level groups are handed to the mixer instead of being attached to the endpoint
+	FosterBool mixInParallel = parent == NULL && engine->mixer.threadCount > 0;
+	ma_uint32 flags = mixInParallel ? MA_SOUND_FLAG_NO_DEFAULT_ATTACHMENT : 0;
+
+	if (MA_SUCCESS != ma_sound_group_init(&engine->engine, flags, (ma_sound_group*)parent, &soundGroup->group))
 	{
 		FosterLogError("Unable to create SoundGroup");
-		ma_free(soundGroup, NULL);
+		FosterFree(soundGroup);
+		return NULL;
+	}
+
+	soundGroup->branch = NULL;
+	if (mixInParallel && !FosterMixerAddGroup(engine, soundGroup))
+	{
+		FosterLogError("Unable to create SoundGroup (Mixer)");
+		ma_sound_group_uninit(&soundGroup->group);
+		FosterFree(soundGroup);
 		return NULL;
 	}
 
-	return (FosterSoundGroup *)soundGroup;
+	soundGroup->engine = engine;
+	soundGroup->parent = parent;
+	soundGroup->firstChild = NULL;
+	soundGroup->nextSibling = NULL;
+	soundGroup->firstSound = NULL;
+	soundGroup->capture = NULL;
+	soundGroup->serial = ma_atomic_fetch_add_64(&engine->snapshots.nextSerial, 1) + 1;
+	FosterIdleAddGroup(engine, soundGroup);
+
+	if (parent != NULL)
+	{
+		ma_spinlock_lock(&engine->groupLock);
+		soundGroup->nextSibling = parent->firstChild;
+		parent->firstChild = soundGroup;
+		ma_spinlock_unlock(&engine->groupLock);
+	}
+
+	return soundGroup;
+}
+
+FosterSoundGroup *FosterSoundGroupCreate(FosterSoundGroup* parent)
+{
+	return FosterAudioEngineCreateSoundGroup(FosterGetState()->audioEngine, parent);
 }
 
 void FosterSoundGroupDestroy(FosterSoundGroup *soundGroup)
 {
+	// stop mixing the group before it goes away, the mixer threads read it outside of the node graph
+	if (soundGroup->capture != NULL)
+		FosterCaptureDetach(soundGroup->capture);
+	FosterMixerRemoveGroup(soundGroup->engine, soundGroup);
+	FosterIdleRemoveGroup(soundGroup->engine, soundGroup);
 	ma_sound_group_uninit((ma_sound_group *)soundGroup);
-	ma_free((ma_sound_group *)soundGroup, NULL);
+
+	ma_spinlock_lock(&soundGroup->engine->groupLock);
+
+	// detach from parent
+	if (soundGroup->parent != NULL)
+	{
+		FosterSoundGroup **link = &soundGroup->parent->firstChild;
+		while (*link != NULL && *link != soundGroup)
+			link = &(*link)->nextSibling;
+		if (*link != NULL)
+			*link = soundGroup->nextSibling;
+	}
+
+	// orphan remaining children and sounds, they are expected to be destroyed first
+	for (FosterSoundGroup *child = soundGroup->firstChild; child != NULL; child = child->nextSibling)
+		child->parent = NULL;
+	for (FosterSound *sound = soundGroup->firstSound; sound != NULL; sound = sound->next)
+		sound->group = NULL;
+
+	ma_spinlock_unlock(&soundGroup->engine->groupLock);
+
+	FosterFree(soundGroup);
 }
 
 float FosterSoundGroupGetVolume(FosterSoundGroup *soundGroup)
@@ -719,8 +5342,448 @@ void FosterSoundGroupSetPitch(FosterSoundGroup* soundGroup, float value)
 	ma_sound_group_set_pitch((ma_sound_group*)soundGroup, value);
 }
 
+// expects groupLock to be held
+// streaming buffers and sequences are driven by their owners, group operations only cover plain voices
+static void FosterSoundGroupApplyAll(FosterSoundGroup *soundGroup, FosterBool recursive, void (*action)(FosterSound *))
+{
+	for (FosterSound *sound = soundGroup->firstSound; sound != NULL; sound = sound->next)
+	{
+		if (sound->stream == NULL && sound->sequence == NULL)
+			action(sound);
+	}
+
+	if (recursive)
+	{
+		for (FosterSoundGroup *child = soundGroup->firstChild; child != NULL; child = child->nextSibling)
+			FosterSoundGroupApplyAll(child, recursive, action);
+	}
+}
+
+void FosterSoundGroupPlayAll(FosterSoundGroup *soundGroup, FosterBool recursive)
+{
+	ma_spinlock_lock(&soundGroup->engine->groupLock);
+	FosterSoundGroupApplyAll(soundGroup, recursive, FosterSoundStartLocked);
+	ma_spinlock_unlock(&soundGroup->engine->groupLock);
+}
+
+void FosterSoundGroupStopAll(FosterSoundGroup *soundGroup, FosterBool recursive)
+{
+	ma_spinlock_lock(&soundGroup->engine->groupLock);
+	FosterSoundGroupApplyAll(soundGroup, recursive, FosterSoundStopLocked);
+	ma_spinlock_unlock(&soundGroup->engine->groupLock);
+}
+
+FosterBool FosterSoundGroupGetVirtualAdvance(FosterSoundGroup *soundGroup)
+{
+	return ma_atomic_load_32(&soundGroup->virtualAdvance);
+}
+
+void FosterSoundGroupSetVirtualAdvance(FosterSoundGroup *soundGroup, FosterBool value)
+{
+	ma_atomic_store_32(&soundGroup->virtualAdvance, value ? MA_TRUE : MA_FALSE);
+}
+
+FosterBool FosterSoundGroupGetSleeping(FosterSoundGroup *soundGroup)
+{
+	return ma_atomic_load_32(&soundGroup->idleAsleep);
+}
+
 // end SoundGroup
 
+// begin Snapshot
+
+#define FOSTER_SNAPSHOT_MAGIC 0x504E5346 // "FSNP"
+#define FOSTER_SNAPSHOT_PLAYING 1
+#define FOSTER_SNAPSHOT_LOOPING 2
+#define FOSTER_SNAPSHOT_SPATIALIZED 4
+
+// a snapshot is the header, its groups and then its voices, both sorted by serial
+typedef struct
+{
+	ma_uint32 magic;
+	ma_uint32 size;
+	ma_uint32 groupCount;
+	ma_uint32 voiceCount;
+	ma_uint64 time;
+} FosterSnapshotHeader;
+
+typedef struct
+{
+	ma_uint64 serial;
+	float volume;
+	float pitch;
+} FosterSnapshotGroup;
+
+typedef struct
+{
+	ma_uint64 serial;
+	ma_uint64 groupSerial;
+	ma_uint64 dataSerial;
+	ma_uint64 cursor;
+	ma_uint64 loopBegin;
+	ma_uint64 loopEnd;
+	ma_vec3f position;
+	ma_vec3f velocity;
+	ma_vec3f direction;
+	float volume;
+	float pitch;
+	float pan;
+	float minDistance;
+	float maxDistance;
+	float rolloff;
+	ma_uint32 flags;
+	ma_uint32 state;
+} FosterSnapshotVoice;
+
+// snapshot records and live entries all start with their serial
+static int FosterSnapshotCompare(const void* a, const void* b)
+{
+	ma_uint64 x = *(const ma_uint64*)a;
+	ma_uint64 y = *(const ma_uint64*)b;
+	return x < y ? -1 : x > y;
+}
+
+// streaming buffers and sequences are fed from elsewhere, rolling those back is up to whoever feeds them
+static ma_bool32 FosterSnapshotIncludes(FosterSound* sound)
+{
+	return sound->stream == NULL && sound->sequence == NULL;
+}
+
+// expects groupLock to be held, reads what the callback changes, a sleeping voice is recorded where it would be had it been pulled
+static void FosterSnapshotWriteVoiceLocked(FosterSound* sound, FosterSnapshotVoice* voice)
+{
+	ma_bool32 ended;
+
+	voice->serial = sound->serial;
+	voice->groupSerial = sound->group != NULL ? sound->group->serial : 0;
+	voice->dataSerial = sound->dataSerial;
+	voice->cursor = 0;
+	FosterIdleCursor(sound, (ma_uint64)sound->idleFrames, &voice->cursor, &ended);
+	voice->state = FosterSoundGetPlaying(sound) ? FOSTER_SNAPSHOT_PLAYING : 0;
+}
+
+// reads the parameters only the game thread sets, after unlocking
+static void FosterSnapshotWriteVoice(FosterSound* sound, FosterSnapshotVoice* voice)
+{
+	ma_sound* s = &sound->sound;
+
+	voice->loopBegin = 0;
+	voice->loopEnd = 0;
+	ma_data_source_get_loop_point_in_pcm_frames(ma_sound_get_data_source(s), &voice->loopBegin, &voice->loopEnd);
+	voice->position = ma_sound_get_position(s);
+	voice->velocity = ma_sound_get_velocity(s);
+	voice->direction = ma_sound_get_direction(s);
+	voice->volume = ma_sound_get_volume(s);
+	voice->pitch = ma_sound_get_pitch(s);
+	voice->pan = ma_sound_get_pan(s);
+	voice->minDistance = ma_sound_get_min_distance(s);
+	voice->maxDistance = ma_sound_get_max_distance(s);
+	voice->rolloff = ma_sound_get_rolloff(s);
+	voice->flags = sound->flags;
+	voice->state |=
+		(ma_sound_is_looping(s) ? FOSTER_SNAPSHOT_LOOPING : 0) |
+		(ma_sound_is_spatialization_enabled(s) ? FOSTER_SNAPSHOT_SPATIALIZED : 0);
+}
+
+static ma_bool32 FosterSnapshotVec3Equal(ma_vec3f a, ma_vec3f b)
+{
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+// only touches what differs, a voice nothing happened to since the snapshot costs a few reads
+static void FosterSnapshotApplyVoice(FosterSound* sound, const FosterSnapshotVoice* voice, ma_uint64 cursorTolerance)
+{
+	ma_sound* s = &sound->sound;
+
+	if (ma_sound_get_volume(s) != voice->volume)
+		ma_sound_set_volume(s, voice->volume);
+	if (ma_sound_get_pitch(s) != voice->pitch)
+		ma_sound_set_pitch(s, voice->pitch);
+	if (ma_sound_get_pan(s) != voice->pan)
+		ma_sound_set_pan(s, voice->pan);
+
+	ma_bool32 spatialized = FOSTER_CHECK(voice->state, FOSTER_SNAPSHOT_SPATIALIZED);
+	if (ma_sound_is_spatialization_enabled(s) != spatialized)
+		ma_sound_set_spatialization_enabled(s, spatialized);
+	if (!FosterSnapshotVec3Equal(ma_sound_get_position(s), voice->position))
+		ma_sound_set_position(s, voice->position.x, voice->position.y, voice->position.z);
+	if (!FosterSnapshotVec3Equal(ma_sound_get_velocity(s), voice->velocity))
+		ma_sound_set_velocity(s, voice->velocity.x, voice->velocity.y, voice->velocity.z);
+	if (!FosterSnapshotVec3Equal(ma_sound_get_direction(s), voice->direction))
+		ma_sound_set_direction(s, voice->direction.x, voice->direction.y, voice->direction.z);
+	if (ma_sound_get_min_distance(s) != voice->minDistance)
+		ma_sound_set_min_distance(s, voice->minDistance);
+	if (ma_sound_get_max_distance(s) != voice->maxDistance)
+		ma_sound_set_max_distance(s, voice->maxDistance);
+	if (ma_sound_get_rolloff(s) != voice->rolloff)
+		ma_sound_set_rolloff(s, voice->rolloff);
+
+	ma_bool32 looping = FOSTER_CHECK(voice->state, FOSTER_SNAPSHOT_LOOPING);
+	if (ma_sound_is_looping(s) != looping)
+		ma_sound_set_looping(s, looping);
+
+	ma_data_source* source = ma_sound_get_data_source(s);
+	ma_uint64 loopBegin = 0, loopEnd = 0;
+	ma_data_source_get_loop_point_in_pcm_frames(source, &loopBegin, &loopEnd);
+	if (loopBegin != voice->loopBegin || loopEnd != voice->loopEnd)
+		ma_data_source_set_loop_point_in_pcm_frames(source, voice->loopBegin, voice->loopEnd);
+
+	// started before seeking, starting a voice that reached its end rewinds it
+	ma_bool32 playing = FOSTER_CHECK(voice->state, FOSTER_SNAPSHOT_PLAYING);
+	if ((FosterSoundGetPlaying(sound) ? MA_TRUE : MA_FALSE) != playing)
+	{
+		if (playing)
+			FosterSoundPlay(sound);
+		else
+			FosterSoundStop(sound);
+	}
+
+	ma_spinlock_lock(&sound->engine->groupLock);
+	FosterIdleSync(&sound->engine->idle);
+	ma_uint64 cursor = 0;
+	ma_bool32 ended;
+	FosterIdleCursor(sound, (ma_uint64)sound->idleFrames, &cursor, &ended);
+	ma_uint64 distance = cursor > voice->cursor ? cursor - voice->cursor : voice->cursor - cursor;
+	if (distance > cursorTolerance)
+		FosterIdleSeekLocked(sound, voice->cursor);
+	ma_spinlock_unlock(&sound->engine->groupLock);
+}
+
+// a voice destroyed since the snapshot comes back under its old serial, so restoring the same snapshot again finds it
+// past capacity it's only counted and left for the next restore to recreate
+static void FosterSnapshotRecreate(FosterAudioEngine* engine, const FosterSnapshotVoice* voice, const FosterSnapshotEntry* liveGroups, ma_uint32 groupCount, FosterRestoredSound* created, int capacity, int* count)
+{
+	if (voice->dataSerial == 0)
+		return;
+
+	FosterSoundGroup* soundGroup = NULL;
+	if (voice->groupSerial != 0)
+	{
+		const FosterSnapshotEntry* entry = bsearch(&voice->groupSerial, liveGroups, groupCount, sizeof(FosterSnapshotEntry), FosterSnapshotCompare);
+		if (entry == NULL)
+			return;
+		soundGroup = entry->item;
+	}
+
+	FosterRegisteredData* data = FosterRegistryFind(&engine->memory, voice->dataSerial);
+	if (data == NULL)
+		return;
+
+	if (*count >= capacity)
+	{
+		(*count)++;
+		return;
+	}
+
+	FosterSound* sound = FosterSoundCreateFromData(data, (FosterSoundFlags)voice->flags, soundGroup);
+	if (sound == NULL)
+		return;
+
+	sound->serial = voice->serial;
+	FosterSnapshotApplyVoice(sound, voice, 0);
+	created[*count].sound = sound;
+	created[*count].dataSerial = voice->dataSerial;
+	created[*count].group = soundGroup;
+	(*count)++;
+}
+
+// past capacity it's only counted, it stays alive so the next restore finds it again
+static void FosterSnapshotStale(FosterSound* sound, FosterSound** stale, int capacity, int* count)
+{
+	FosterSoundStop(sound);
+	if (*count < capacity)
+		stale[*count] = sound;
+	(*count)++;
+}
+
+// returns with groupLock held once live fits every group and voice, growing it outside of the lock
+static ma_bool32 FosterSnapshotLockLive(FosterAudioEngine* engine)
+{
+	FosterSnapshots* snapshots = &engine->snapshots;
+	FosterIdle* idle = &engine->idle;
+
+	for (;;)
+	{
+		ma_spinlock_lock(&engine->groupLock);
+		ma_uint32 needed = idle->groups.count + idle->voices.count;
+		if (needed <= snapshots->liveCapacity)
+			return MA_TRUE;
+		ma_spinlock_unlock(&engine->groupLock);
+
+		FosterSnapshotEntry* live = FosterRealloc(&engine->memory, snapshots->live, needed * 2 * sizeof(FosterSnapshotEntry), FOSTER_MEMORY_CATEGORY_VOICES);
+		if (live == NULL)
+			return MA_FALSE;
+		snapshots->live = live;
+		snapshots->liveCapacity = needed * 2;
+	}
+}
+
+// copies the serials of the live groups and voices and sorts them
+static ma_bool32 FosterSnapshotGatherLive(FosterAudioEngine* engine, ma_uint32* groupCount, ma_uint32* voiceCount)
+{
+	FosterSnapshots* snapshots = &engine->snapshots;
+	FosterIdle* idle = &engine->idle;
+
+	if (!FosterSnapshotLockLive(engine))
+		return MA_FALSE;
+
+	FosterSnapshotEntry* entry = snapshots->live;
+	for (ma_uint32 i = 0; i < idle->groups.count; i++, entry++)
+	{
+		FosterSoundGroup* soundGroup = idle->groups.items[i];
+		entry->serial = soundGroup->serial;
+		entry->item = soundGroup;
+	}
+
+	*groupCount = idle->groups.count;
+	for (ma_uint32 i = 0; i < idle->voices.count; i++)
+	{
+		FosterSound* sound = idle->voices.items[i];
+		if (!FosterSnapshotIncludes(sound))
+			continue;
+		entry->serial = sound->serial;
+		entry->item = sound;
+		entry++;
+	}
+
+	*voiceCount = (ma_uint32)(entry - snapshots->live) - *groupCount;
+	ma_spinlock_unlock(&engine->groupLock);
+
+	qsort(snapshots->live, *groupCount, sizeof(FosterSnapshotEntry), FosterSnapshotCompare);
+	qsort(snapshots->live + *groupCount, *voiceCount, sizeof(FosterSnapshotEntry), FosterSnapshotCompare);
+	return MA_TRUE;
+}
+
+int FosterAudioEngineSnapshot(FosterAudioEngine* engine, void* buffer, int capacity, int* voiceCount)
+{
+	FosterIdle* idle = &engine->idle;
+	*voiceCount = 0;
+
+	// the voices are copied to live, so only what the callback changes is read under the lock
+	if (!FosterSnapshotLockLive(engine))
+	{
+		FosterLogError("Unable to take Snapshot (Out of Memory)");
+		return 0;
+	}
+	FosterSnapshotEntry* live = engine->snapshots.live;
+	FosterIdleSync(idle);
+	size_t size = sizeof(FosterSnapshotHeader) +
+		idle->groups.count * sizeof(FosterSnapshotGroup) +
+		idle->voices.count * sizeof(FosterSnapshotVoice);
+	if (buffer == NULL || capacity < 0 || size > (size_t)capacity)
+	{
+		ma_spinlock_unlock(&engine->groupLock);
+		return (int)size;
+	}
+
+	FosterSnapshotHeader* header = buffer;
+	FosterSnapshotGroup* groups = (FosterSnapshotGroup*)(header + 1);
+	for (ma_uint32 i = 0; i < idle->groups.count; i++)
+	{
+		FosterSoundGroup* soundGroup = idle->groups.items[i];
+		groups[i].serial = soundGroup->serial;
+		groups[i].volume = ma_sound_group_get_volume(&soundGroup->group);
+		groups[i].pitch = ma_sound_group_get_pitch(&soundGroup->group);
+	}
+
+	FosterSnapshotVoice* voices = (FosterSnapshotVoice*)(groups + idle->groups.count);
+	ma_uint32 count = 0;
+	for (ma_uint32 i = 0; i < idle->voices.count; i++)
+	{
+		FosterSound* sound = idle->voices.items[i];
+		if (!FosterSnapshotIncludes(sound))
+			continue;
+		FosterSnapshotWriteVoiceLocked(sound, &voices[count]);
+		live[count++].item = sound;
+	}
+
+	header->magic = FOSTER_SNAPSHOT_MAGIC;
+	header->groupCount = idle->groups.count;
+	header->voiceCount = count;
+	header->time = ma_engine_get_time_in_pcm_frames(&engine->engine);
+	ma_spinlock_unlock(&engine->groupLock);
+
+	// voices are only destroyed by the game thread, which is busy here
+	for (ma_uint32 i = 0; i < count; i++)
+		FosterSnapshotWriteVoice(live[i].item, &voices[i]);
+
+	qsort(groups, header->groupCount, sizeof(FosterSnapshotGroup), FosterSnapshotCompare);
+	qsort(voices, header->voiceCount, sizeof(FosterSnapshotVoice), FosterSnapshotCompare);
+	header->size = (ma_uint32)((unsigned char*)(voices + count) - (unsigned char*)buffer);
+	*voiceCount = (int)count;
+	return (int)header->size;
+}
+
+FosterBool FosterAudioEngineRestore(FosterAudioEngine* engine, const void* snapshot, int length, uint64_t cursorTolerance, FosterRestoredSound* created, int createdCapacity, int* createdCount, FosterSound** stale, int staleCapacity, int* staleCount)
+{
+	*createdCount = 0;
+	*staleCount = 0;
+
+	const FosterSnapshotHeader* header = snapshot;
+	if (snapshot == NULL || length < (int)sizeof(FosterSnapshotHeader) ||
+		header->magic != FOSTER_SNAPSHOT_MAGIC || header->size > (ma_uint32)length ||
+		header->size != sizeof(FosterSnapshotHeader) +
+			(size_t)header->groupCount * sizeof(FosterSnapshotGroup) +
+			(size_t)header->voiceCount * sizeof(FosterSnapshotVoice))
+	{
+		FosterLogError("Unable to restore Snapshot (Invalid Snapshot)");
+		return false;
+	}
+
+	ma_uint32 groupCount, voiceCount;
+	if (!FosterSnapshotGatherLive(engine, &groupCount, &voiceCount))
+	{
+		FosterLogError("Unable to restore Snapshot (Out of Memory)");
+		return false;
+	}
+
+	const FosterSnapshotGroup* groups = (const FosterSnapshotGroup*)(header + 1);
+	const FosterSnapshotVoice* voices = (const FosterSnapshotVoice*)(groups + header->groupCount);
+	const FosterSnapshotEntry* liveGroups = engine->snapshots.live;
+	const FosterSnapshotEntry* liveVoices = liveGroups + groupCount;
+
+	ma_engine_set_time_in_pcm_frames(&engine->engine, header->time);
+
+	// groups created since the snapshot are left alone, none of their voices are in it
+	for (ma_uint32 i = 0, j = 0; i < header->groupCount && j < groupCount;)
+	{
+		if (groups[i].serial < liveGroups[j].serial)
+			i++;
+		else if (groups[i].serial > liveGroups[j].serial)
+			j++;
+		else
+		{
+			ma_sound_group* group = &((FosterSoundGroup*)liveGroups[j].item)->group;
+			if (ma_sound_group_get_volume(group) != groups[i].volume)
+				ma_sound_group_set_volume(group, groups[i].volume);
+			if (ma_sound_group_get_pitch(group) != groups[i].pitch)
+				ma_sound_group_set_pitch(group, groups[i].pitch);
+			i++;
+			j++;
+		}
+	}
+
+	// both are sorted by serial, so one pass tells apart the voices kept, destroyed and created since
+	ma_uint32 j = 0;
+	for (ma_uint32 i = 0; i < header->voiceCount; i++)
+	{
+		while (j < voiceCount && liveVoices[j].serial < voices[i].serial)
+			FosterSnapshotStale(liveVoices[j++].item, stale, staleCapacity, staleCount);
+
+		if (j < voiceCount && liveVoices[j].serial == voices[i].serial)
+			FosterSnapshotApplyVoice(liveVoices[j++].item, &voices[i], cursorTolerance);
+		else
+			FosterSnapshotRecreate(engine, &voices[i], liveGroups, groupCount, created, createdCapacity, createdCount);
+	}
+
+	while (j < voiceCount)
+		FosterSnapshotStale(liveVoices[j++].item, stale, staleCapacity, staleCount);
+
+	return true;
+}
+
+// end Snapshot
+
 void FosterLogInfo(const char* fmt, ...)
 {
 	if (fstate.desc.logging == FOSTER_LOGGING_NONE ||
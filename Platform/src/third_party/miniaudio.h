@@ -5211,6 +5211,8 @@ typedef struct
     float minSpatializationChannelGain;
     ma_gainer gainer;   /* For smooth gain transitions. */
     float* pNewChannelGainsOut; /* An offset of _pHeap. Used by ma_spatializer_process_pcm_frames() to store new channel gains. The number of elements in this array is equal to config.channelsOut. */
+    ma_bool32 hasPrecomputedGains;  /* Foster: pNewChannelGainsOut and precomputedDopplerPitch were already computed by a batched spatializer, ma_spatializer_process_pcm_frames() only applies them. */
+    float precomputedDopplerPitch;
 
     /* Memory management. */
     void* _pHeap;
@@ -50359,6 +50361,19 @@ MA_API ma_result ma_spatializer_process_pcm_frames(ma_spatializer* pSpatializer,
         the correct thinking so might need to review this later.
         */
         pSpatializer->dopplerPitch = 1;
+    } else if (pSpatializer->hasPrecomputedGains) {
+        /* Foster: the gains and doppler pitch were computed for many spatializers at once, only convert and apply them. */
+        if (ma_spatializer_listener_is_enabled(pListener)) {
+            ma_channel_map_apply_f32((float*)pFramesOut, pChannelMapOut, pSpatializer->channelsOut, (const float*)pFramesIn, pChannelMapIn, pSpatializer->channelsIn, frameCount, ma_channel_mix_mode_rectangular, ma_mono_expansion_mode_default);
+        } else {
+            ma_silence_pcm_frames(pFramesOut, frameCount, ma_format_f32, pSpatializer->channelsOut);
+        }
+
+        ma_gainer_set_gains(&pSpatializer->gainer, pSpatializer->pNewChannelGainsOut);
+        ma_gainer_process_pcm_frames(&pSpatializer->gainer, pFramesOut, pFramesOut, frameCount);
+
+        /* Like the regular path, the doppler pitch only takes effect from the next call. */
+        pSpatializer->dopplerPitch = pSpatializer->precomputedDopplerPitch;
     } else {
         /*
         Let's first determine which listener the sound is closest to. Need to keep in mind that we
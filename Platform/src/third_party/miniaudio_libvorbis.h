@@ -30,6 +30,8 @@ typedef struct
     ma_tell_proc onTell;
     void* pReadSeekTellUserData;
     ma_format format;           /* Will be either f32 or s16. */
+    ma_uint32 channels;         /* Cached from the first logical stream so reads don't query libvorbis. */
+    ma_uint32 sampleRate;
 #if !defined(MA_NO_LIBVORBIS)
     OggVorbis_File vf;
 #endif
@@ -146,6 +148,110 @@ static long ma_libvorbis_vf_callback__tell(void* pUserData)
 }
 #endif
 
+#if !defined(MA_NO_LIBVORBIS)
+static ma_result ma_libvorbis_init_format(ma_libvorbis* pVorbis)
+{
+    vorbis_info* pInfo = ov_info(&pVorbis->vf, 0);
+    if (pInfo == NULL || pInfo->channels < 1 || pInfo->channels > 255) {
+        ov_clear(&pVorbis->vf);
+        return MA_INVALID_FILE;
+    }
+
+    pVorbis->channels   = (ma_uint32)pInfo->channels;
+    pVorbis->sampleRate = (ma_uint32)pInfo->rate;
+
+    return MA_SUCCESS;
+}
+
+/* Same rounding and clamping as ov_read(), so s16 output doesn't change. */
+static MA_INLINE ma_int16 ma_libvorbis_f32_to_s16(float x)
+{
+    x = x * 32768.0f;
+    x = (x < -32768.0f) ? -32768.0f : ((x > 32767.0f) ? 32767.0f : x);
+#if defined(MA_SUPPORT_SSE2)
+    return (ma_int16)_mm_cvtss_si32(_mm_set_ss(x));
+#else
+    return (ma_int16)floor(x + 0.5);
+#endif
+}
+
+/* Interleaves the planar output of ov_read_float() straight into the caller's buffer. */
+static void ma_libvorbis_interleave_f32(float* pFramesOut, float** ppFramesIn, ma_uint32 channels, ma_uint64 frameCount)
+{
+    ma_uint64 iFrame = 0;
+    ma_uint32 iChannel;
+
+    if (channels == 1) {
+        MA_COPY_MEMORY(pFramesOut, ppFramesIn[0], (size_t)frameCount * sizeof(float));
+        return;
+    }
+
+    if (channels == 2) {
+        const float* pL = ppFramesIn[0];
+        const float* pR = ppFramesIn[1];
+    #if defined(MA_SUPPORT_SSE2)
+        for (; iFrame + 4 <= frameCount; iFrame += 4) {
+            __m128 l = _mm_loadu_ps(pL + iFrame);
+            __m128 r = _mm_loadu_ps(pR + iFrame);
+            _mm_storeu_ps(pFramesOut + iFrame*2 + 0, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(pFramesOut + iFrame*2 + 4, _mm_unpackhi_ps(l, r));
+        }
+    #endif
+        for (; iFrame < frameCount; iFrame += 1) {
+            pFramesOut[iFrame*2 + 0] = pL[iFrame];
+            pFramesOut[iFrame*2 + 1] = pR[iFrame];
+        }
+        return;
+    }
+
+    for (iChannel = 0; iChannel < channels; iChannel += 1) {
+        const float* pIn = ppFramesIn[iChannel];
+        float* pOut = pFramesOut + iChannel;
+        for (iFrame = 0; iFrame < frameCount; iFrame += 1) {
+            pOut[iFrame*channels] = pIn[iFrame];
+        }
+    }
+}
+
+static void ma_libvorbis_interleave_s16(ma_int16* pFramesOut, float** ppFramesIn, ma_uint32 channels, ma_uint64 frameCount)
+{
+    ma_uint64 iFrame = 0;
+    ma_uint32 iChannel;
+
+#if defined(MA_SUPPORT_SSE2)
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+
+    if (channels == 1) {
+        const float* pIn = ppFramesIn[0];
+        for (; iFrame + 8 <= frameCount; iFrame += 8) {
+            __m128i a = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pIn + iFrame + 0), scale), lo), hi));
+            __m128i b = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pIn + iFrame + 4), scale), lo), hi));
+            _mm_storeu_si128((__m128i*)(pFramesOut + iFrame), _mm_packs_epi32(a, b));
+        }
+    } else if (channels == 2) {
+        const float* pL = ppFramesIn[0];
+        const float* pR = ppFramesIn[1];
+        for (; iFrame + 4 <= frameCount; iFrame += 4) {
+            __m128i l = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pL + iFrame), scale), lo), hi));
+            __m128i r = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pR + iFrame), scale), lo), hi));
+            _mm_storeu_si128((__m128i*)(pFramesOut + iFrame*2), _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r)));
+        }
+    }
+#endif
+
+    for (iChannel = 0; iChannel < channels; iChannel += 1) {
+        const float* pIn = ppFramesIn[iChannel];
+        ma_int16* pOut = pFramesOut + iChannel;
+        ma_uint64 iTail;
+        for (iTail = iFrame; iTail < frameCount; iTail += 1) {
+            pOut[iTail*channels] = ma_libvorbis_f32_to_s16(pIn[iTail]);
+        }
+    }
+}
+#endif
+
 static ma_result ma_libvorbis_init_internal(const ma_decoding_backend_config* pConfig, ma_libvorbis* pVorbis)
 {
     ma_result result;
@@ -211,7 +317,7 @@ MA_API ma_result ma_libvorbis_init(ma_read_proc onRead, ma_seek_proc onSeek, ma_
             return MA_INVALID_FILE;
         }
 
-        return MA_SUCCESS;
+        return ma_libvorbis_init_format(pVorbis);
     }
     #else
     {
@@ -241,7 +347,7 @@ MA_API ma_result ma_libvorbis_init_file(const char* pFilePath, const ma_decoding
             return MA_INVALID_FILE;
         }
 
-        return MA_SUCCESS;
+        return ma_libvorbis_init_format(pVorbis);
     }
     #else
     {
@@ -290,58 +396,46 @@ MA_API ma_result ma_libvorbis_read_pcm_frames(ma_libvorbis* pVorbis, void* pFram
 
     #if !defined(MA_NO_LIBVORBIS)
     {
-        /* We always use floating point format. */
+        /*
+        Every call to ov_read_float() hands out the rest of the current packet, so there's no need for an
+        intermediate chunk size. The planar floats are interleaved and converted straight into the output,
+        s16 included, rather than going through ov_read().
+        */
         ma_result result = MA_SUCCESS;  /* Must be initialized to MA_SUCCESS. */
         ma_uint64 totalFramesRead;
-        ma_format format;
-        ma_uint32 channels;
-
-        ma_libvorbis_get_data_format(pVorbis, &format, &channels, NULL, NULL, 0);
+        ma_format format = pVorbis->format;
+        ma_uint32 channels = pVorbis->channels;
 
         totalFramesRead = 0;
         while (totalFramesRead < frameCount) {
             long libvorbisResult;
             int framesToRead;
             ma_uint64 framesRemaining;
+            float** ppFramesF32;
+            void* pRunningFramesOut;
 
             framesRemaining = (frameCount - totalFramesRead);
-            framesToRead = 1024;
-            if (framesToRead > framesRemaining) {
-                framesToRead = (int)framesRemaining;
+            framesToRead = (framesRemaining > 0x7FFFFFFF) ? 0x7FFFFFFF : (int)framesRemaining;
+
+            libvorbisResult = ov_read_float(&pVorbis->vf, &ppFramesF32, framesToRead, NULL);
+            if (libvorbisResult < 0) {
+                result = MA_ERROR;  /* Error while decoding. */
+                break;
+            }
+
+            if (libvorbisResult == 0) {
+                result = MA_AT_END;
+                break;
             }
 
+            pRunningFramesOut = ma_offset_pcm_frames_ptr(pFramesOut, totalFramesRead, format, channels);
             if (format == ma_format_f32) {
-                float** ppFramesF32;
-
-                libvorbisResult = ov_read_float(&pVorbis->vf, &ppFramesF32, framesToRead, NULL);
-                if (libvorbisResult < 0) {
-                    result = MA_ERROR;  /* Error while decoding. */
-                    break;
-                } else {
-                    /* Frames need to be interleaved. */
-                    ma_interleave_pcm_frames(format, channels, libvorbisResult, (const void**)ppFramesF32, ma_offset_pcm_frames_ptr(pFramesOut, totalFramesRead, format, channels));
-                    totalFramesRead += libvorbisResult;
-
-                    if (libvorbisResult == 0) {
-                        result = MA_AT_END;
-                        break;
-                    }
-                }
+                ma_libvorbis_interleave_f32((float*)pRunningFramesOut, ppFramesF32, channels, (ma_uint64)libvorbisResult);
             } else {
-                libvorbisResult = ov_read(&pVorbis->vf, ma_offset_pcm_frames_ptr(pFramesOut, totalFramesRead, format, channels), framesToRead * ma_get_bytes_per_frame(format, channels), 0, 2, 1, NULL);
-                if (libvorbisResult < 0) {
-                    result = MA_ERROR;  /* Error while decoding. */
-                    break;
-                } else {
-                    /* Conveniently, there's no need to interleaving when using ov_read(). I'm not sure why ov_read_float() is different in that regard... */
-                    totalFramesRead += libvorbisResult / ma_get_bytes_per_frame(format, channels);
-
-                    if (libvorbisResult == 0) {
-                        result = MA_AT_END;
-                        break;
-                    }
-                }
+                ma_libvorbis_interleave_s16((ma_int16*)pRunningFramesOut, ppFramesF32, channels, (ma_uint64)libvorbisResult);
             }
+
+            totalFramesRead += (ma_uint64)libvorbisResult;
         }
 
         if (pFramesRead != NULL) {
@@ -427,21 +521,16 @@ MA_API ma_result ma_libvorbis_get_data_format(ma_libvorbis* pVorbis, ma_format*
 
     #if !defined(MA_NO_LIBVORBIS)
     {
-        vorbis_info* pInfo = ov_info(&pVorbis->vf, 0);
-        if (pInfo == NULL) {
-            return MA_INVALID_OPERATION;
-        }
-
         if (pChannels != NULL) {
-            *pChannels = pInfo->channels;
+            *pChannels = pVorbis->channels;
         }
 
         if (pSampleRate != NULL) {
-            *pSampleRate = pInfo->rate;
+            *pSampleRate = pVorbis->sampleRate;
         }
 
         if (pChannelMap != NULL) {
-            ma_channel_map_init_standard(ma_standard_channel_map_vorbis, pChannelMap, channelMapCap, pInfo->channels);
+            ma_channel_map_init_standard(ma_standard_channel_map_vorbis, pChannelMap, channelMapCap, pVorbis->channels);
         }
 
         return MA_SUCCESS;
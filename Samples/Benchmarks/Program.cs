@@ -0,0 +1,18 @@
+﻿namespace Benchmarks;
+
+class Program
+{
+	public static int Main(string[] args)
+	{
+		switch (args.Length > 0 ? args[0] : "")
+		{
+			case "spatial":
+				return Spatialization.Run();
+			case "vorbis" when args.Length > 1:
+				return Vorbis.Run(args[1]);
+			default:
+				Console.WriteLine("usage: Benchmarks spatial | vorbis <file.ogg>");
+				return 1;
+		}
+	}
+}
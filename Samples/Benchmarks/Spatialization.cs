@@ -0,0 +1,148 @@
+﻿using Foster.Audio;
+using System.Diagnostics;
+using System.Numerics;
+
+namespace Benchmarks;
+
+/// <summary>
+/// Renders the same 3D scene with and without <see cref="AudioStartupOptions.BatchSpatialization"/>.
+/// The output has to match sample for sample, then the time per callback is compared at growing voice counts.
+/// </summary>
+static class Spatialization
+{
+	private const int SampleRate = 48000;
+	// the spatialization is computed once per callback while mixing scales with its frames, small blocks keep it visible
+	private const int BlockFrames = 64;
+
+	public static int Run()
+	{
+		// every attenuation model, cones, relative voices and doppler, against a listener with a cone
+		var scalar = Render(false, 300, 1500, true, out _);
+		var batched = Render(true, 300, 1500, true, out _);
+		int differ = 0;
+		for (int i = 0; i < scalar.Length; i++)
+		{
+			if (scalar[i] != batched[i])
+				differ++;
+		}
+		Console.WriteLine($"equivalence: {scalar.Length} samples, {differ} differ");
+
+		foreach (var voices in new[] { 64, 256, 1024 })
+		{
+			// warm up, then best of 9 alternating runs
+			Render(false, voices, 50, false, out _);
+			Render(true, voices, 50, false, out _);
+			double scalarTime = double.MaxValue, batchedTime = double.MaxValue;
+			for (int i = 0; i < 9; i++)
+			{
+				Render(false, voices, 1000, false, out var time);
+				scalarTime = Math.Min(scalarTime, time);
+				Render(true, voices, 1000, false, out time);
+				batchedTime = Math.Min(batchedTime, time);
+			}
+			Console.WriteLine($"{voices,5} voices: per voice {scalarTime:F1} us, batched {batchedTime:F1} us, {scalarTime - batchedTime:F1} us saved per callback");
+		}
+
+		return differ == 0 ? 0 : 1;
+	}
+
+	private static float[] Render(bool batch, int voices, int blocks, bool varied, out double microsecondsPerBlock)
+	{
+		var engine = new AudioEngine(new AudioStartupOptions
+		{
+			NoDevice = true,
+			SampleRate = SampleRate,
+			Channels = 2,
+			BatchSpatialization = batch,
+			VoicePoolCapacity = 0
+		});
+		engine.MaxActiveInstances = voices;
+
+		var sound = new Sound(Tone(SampleRate), AudioFormat.S16, 1, SampleRate, SampleRate, engine);
+		var random = new Random(1234);
+		Vector3 Scatter(float range) => new(
+			(float)(random.NextDouble() * 2 - 1) * range,
+			(float)(random.NextDouble() * 2 - 1) * range,
+			(float)(random.NextDouble() * 2 - 1) * range);
+
+		engine.Listener.Position = new Vector3(1, 2, 3);
+		engine.Listener.Direction = Vector3.Normalize(new Vector3(0.3f, 0.1f, -1));
+		engine.Listener.Velocity = new Vector3(1, 0, 2);
+		if (varied)
+		{
+			engine.Listener.Cone = new SoundCone(2.0f, 4.0f, 0.3f);
+		}
+
+		var instances = new List<SoundInstance>();
+		for (int i = 0; i < voices; i++)
+		{
+			var instance = sound.CreateInstance3d(Scatter(30));
+			instance.Looping = true;
+			instance.Volume = 0.01f;
+			instance.Velocity = Scatter(20);
+			instance.DopplerFactor = varied && i % 5 != 0 ? 1 : 0;
+			instance.AttenuationModel = varied ? (SoundAttenuationModel)(1 + i % 3) : SoundAttenuationModel.Inverse;
+			instance.MinDistance = 1 + i % 3;
+			instance.MaxDistance = i % 7 == 0 ? 0.5f : 40;
+			instance.Rolloff = 0.5f + (i % 4) * 0.5f;
+			instance.DirectionalAttenuationFactor = i % 2 == 0 ? 1 : 0.5f;
+			if (varied && i % 3 == 0)
+			{
+				instance.Direction = Vector3.Normalize(Scatter(1));
+				instance.Cone = new SoundCone(1.0f, 2.5f, 0.2f);
+			}
+			if (varied && i % 11 == 0)
+			{
+				instance.Positioning = SoundPositioning.Relative;
+			}
+			if (varied && i % 13 == 0)
+			{
+				instance.Position = engine.Listener.Position;
+			}
+			instance.Play();
+			instances.Add(instance);
+		}
+
+		var block = new float[BlockFrames * 2];
+		var output = varied ? new float[blocks * block.Length] : Array.Empty<float>();
+		var stopwatch = new Stopwatch();
+		for (int b = 0; b < blocks; b++)
+		{
+			// a share of the voices moves every block, like a game updating its emitters
+			for (int i = 0; i < instances.Count; i += 7)
+			{
+				var instance = instances[i];
+				instance.Position += new Vector3(0.1f, 0, -0.05f);
+			}
+
+			stopwatch.Start();
+			engine.Render(block);
+			stopwatch.Stop();
+
+			if (varied)
+			{
+				block.CopyTo(output, b * block.Length);
+			}
+		}
+
+		foreach (var instance in instances)
+		{
+			instance.Release();
+		}
+		sound.Dispose();
+		engine.Dispose();
+
+		microsecondsPerBlock = stopwatch.Elapsed.TotalMicroseconds / blocks;
+		return output;
+	}
+
+	private static byte[] Tone(int frames)
+	{
+		var data = new byte[frames * sizeof(short)];
+		for (int i = 0; i < frames; i++)
+		{
+			BitConverter.TryWriteBytes(data.AsSpan(i * sizeof(short)), (short)(Math.Sin(i * 0.05) * 10000));
+		}
+		return data;
+	}
+}
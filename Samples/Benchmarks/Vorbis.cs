@@ -0,0 +1,91 @@
+﻿using Foster.Audio;
+using System.Diagnostics;
+
+namespace Benchmarks;
+
+/// <summary>
+/// Measures Vorbis decode throughput, decoding a whole file with <see cref="Sound.TryDecode(ReadOnlySpan{byte}, Span{byte}, AudioFormat, int, int, out ulong)"/>
+/// and playing it from encoded data through <see cref="AudioEngine.Render"/>.
+/// </summary>
+static class Vorbis
+{
+	// a 10ms callback at 48kHz
+	private const int BlockFrames = 480;
+	private const int Runs = 5;
+
+	public static int Run(string path)
+	{
+		var data = File.ReadAllBytes(path);
+
+		foreach (var format in new[] { AudioFormat.F32, AudioFormat.S16 })
+		{
+			var decodedFormat = format;
+			int channels = 0, sampleRate = 0;
+			if (!Sound.TryGetDecodedInfo(data, ref decodedFormat, ref channels, ref sampleRate, out var frameCount))
+			{
+				Console.WriteLine($"unable to decode '{path}'");
+				return 1;
+			}
+
+			var seconds = (double)frameCount / sampleRate;
+			var destination = new byte[(int)frameCount * channels * decodedFormat.GetSampleSize()];
+			double best = double.MaxValue;
+			for (int i = 0; i < Runs + 1; i++)
+			{
+				var stopwatch = Stopwatch.StartNew();
+				Sound.TryDecode(data, destination, decodedFormat, channels, sampleRate, out _);
+				stopwatch.Stop();
+
+				// the first run warms up
+				if (i > 0)
+					best = Math.Min(best, stopwatch.Elapsed.TotalSeconds);
+			}
+			Console.WriteLine($"decode {decodedFormat}: {seconds:F1} s of {channels} channel audio in {best * 1000:F1} ms, {seconds / best:F0}x realtime");
+
+			if (format == AudioFormat.F32)
+			{
+				best = double.MaxValue;
+				for (int i = 0; i < Runs + 1; i++)
+				{
+					var time = Play(data, sampleRate, frameCount);
+					if (i > 0)
+						best = Math.Min(best, time);
+				}
+				Console.WriteLine($"playback: {BlockFrames} frame callbacks in {best * 1000:F1} ms, {seconds / best:F0}x realtime");
+			}
+		}
+
+		return 0;
+	}
+
+	private static double Play(byte[] data, int sampleRate, ulong frameCount)
+	{
+		// match the file rate so the time is spent decoding rather than resampling
+		var engine = new AudioEngine(new AudioStartupOptions
+		{
+			NoDevice = true,
+			SampleRate = sampleRate,
+			Channels = 2
+		});
+
+		var sound = new Sound(data, false, engine);
+		var instance = sound.CreateInstance();
+		instance.Protected = true;
+		instance.Play();
+
+		var block = new float[BlockFrames * 2];
+		var blocks = (frameCount + BlockFrames - 1) / BlockFrames;
+		var stopwatch = Stopwatch.StartNew();
+		for (ulong b = 0; b < blocks; b++)
+		{
+			engine.Render(block);
+		}
+		stopwatch.Stop();
+
+		instance.Release();
+		sound.Dispose();
+		engine.Dispose();
+
+		return stopwatch.Elapsed.TotalSeconds;
+	}
+}